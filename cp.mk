@@ -14,6 +14,18 @@ CP_LIBS := -l:EZagt_linux_x86_64.a -l:EZagt-cp_linux_x86_64.a -l:EZcp_linux_x86_
 
 CP_C_FLAGS := -DALVS_LITTLE_ENDIAN -Werror -Wall -Wextra
 
+ifdef CONN_INLINE_INFO
+CP_C_FLAGS += -DALVS_CONN_INLINE_INFO
+endif
+
+ifdef CONN_COMPACT
+CP_C_FLAGS += -DALVS_CONN_COMPACT
+endif
+
+ifdef SERVICE_INLINE_INFO
+CP_C_FLAGS += -DALVS_SERVICE_INLINE_INFO
+endif
+
 ifdef CP_DEBUG
 CP_C_FLAGS += -O0 -g3
 else
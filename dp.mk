@@ -12,6 +12,22 @@ DP_C_DEPS = $(patsubst %.c,build/%.d,$(DP_C_SRCS))
 
 DP_C_FLAGS := -DNPS_BIG_ENDIAN -Werror -Wall -Wextra
 
+ifdef CONN_INLINE_INFO
+DP_C_FLAGS += -DALVS_CONN_INLINE_INFO
+endif
+
+ifdef CONN_COMPACT
+DP_C_FLAGS += -DALVS_CONN_COMPACT
+endif
+
+ifdef SERVICE_INLINE_INFO
+DP_C_FLAGS += -DALVS_SERVICE_INLINE_INFO
+endif
+
+ifdef CONN_LOCKLESS_CREATE
+DP_C_FLAGS += -DALVS_CONN_LOCKLESS_CREATE
+endif
+
 ifdef DP_DEBUG
 DP_C_FLAGS += -O1 -g3 -ftree-ter  -gdwarf-2
 else
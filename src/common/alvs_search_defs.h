@@ -55,6 +55,40 @@ struct alvs_service_classification_key {
 CASSERT(sizeof(struct alvs_service_classification_key) == 8);
 
 /*result*/
+#ifdef ALVS_SERVICE_INLINE_INFO
+/* scheduling fields of service info are duplicated in the result and kept
+ * in sync by CP, so a new connection needs no service info lookup.
+ * service info entry is still kept for aging and scheduling retries.
+ */
+struct alvs_service_classification_result {
+	/*byte0*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             sched_alg     : 4;   /* enum alvs_scheduler_type */
+#else
+	unsigned             sched_alg     : 4;   /* enum alvs_scheduler_type */
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+#endif
+	/*byte1*/
+	uint8_t              service_index;
+	/*byte2*/
+	uint8_t              persist_iterations;
+	/*byte3*/
+	unsigned             /*reserved*/  : 8;
+	/*byte4-5*/
+	uint16_t             sched_entries_count;
+	/*byte6-7*/
+	unsigned             /*reserved*/  : 16;
+	/*byte8-11*/
+	ezdp_sum_addr_t      service_sched_ctr;
+	/*byte12-15*/
+	uint32_t             service_flags;
+};
+
+CASSERT(sizeof(struct alvs_service_classification_result) == 16);
+#else
 struct alvs_service_classification_result {
 	/*byte0*/
 #ifdef NPS_BIG_ENDIAN
@@ -73,6 +107,63 @@ struct alvs_service_classification_result {
 };
 
 CASSERT(sizeof(struct alvs_service_classification_result) == 4);
+#endif
+
+/*********************************
+ * Service IPv6 classification DB defs
+ *********************************/
+
+/*key*/
+struct alvs_service6_classification_key {
+	struct in6_addr service_address;
+	uint16_t        service_port;
+	uint16_t        service_protocol;
+} __packed;
+
+CASSERT(sizeof(struct alvs_service6_classification_key) == 20);
+
+/* result is struct alvs_service_classification_result */
+
+/*********************************
+ * VIP filter DB defs
+ *********************************/
+
+/*entry of a bucket exists when any IPv4 service classification
+ * entry (vip) or NAT/full NAT server (nat_server) has an address of
+ * the bucket. frames to other destinations skip connection and service
+ * classification, frames from other sources skip NAT classification.
+ */
+#define ALVS_VIP_FILTER_INDEX(ip) \
+	(((ip) ^ ((ip) >> 12) ^ ((ip) >> 24)) & (ALVS_VIP_FILTER_ENTRIES - 1))
+
+/*key*/
+struct alvs_vip_filter_key {
+	uint16_t bucket_index;
+} __packed;
+
+CASSERT(sizeof(struct alvs_vip_filter_key) == 2);
+
+/*result*/
+struct alvs_vip_filter_result {
+	/*byte0*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : 4;
+#else
+	unsigned             /*reserved*/  : 4;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+#endif
+	/*byte1*/
+	uint8_t              vip;
+	/*byte2*/
+	uint8_t              nat_server;
+	/*byte3*/
+	uint8_t              reserved;
+};
+
+CASSERT(sizeof(struct alvs_vip_filter_result) == 4);
 
 /*********************************
  * Service info DB defs
@@ -89,6 +180,7 @@ enum alvs_scheduler_type {
 	ALVS_LB_LEAST_CONNECTION_SCHEDULER_WITH_REPLICATION     = 7,
 	ALVS_SHORTEST_EXPECTED_DELAY_SCHEDULER                  = 8,
 	ALVS_NEVER_QUEUE_SCHEDULER                              = 9,
+	ALVS_TWO_CHOICES_SCHEDULER                              = 10,
 	ALVS_SCHEDULER_LAST
 };
 
@@ -114,7 +206,7 @@ struct alvs_service_info_result {
 	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
 #endif
 	/*byte1*/
-	unsigned             /*reserved*/  : 8;
+	uint8_t              persist_iterations; /* 0 - not persistent */
 	/*byte2-3*/
 	uint16_t             sched_entries_count;
 	/*byte4-7*/
@@ -126,6 +218,24 @@ struct alvs_service_info_result {
 };
 CASSERT(sizeof(struct alvs_service_info_result) == 16);
 
+/*ALVS service flags - kept in service_flags above the IPVS flags (IP_VS_SVC_F_*).
+ *policy for TCP frames without SYN which miss the connection table,
+ *when none is set a connection is created as for SYN.
+ *policy is set per service in the IPVS service flags. a service added without
+ *policy gets the daemon default (--non_syn_miss), a service modified without
+ *policy keeps its policy.
+ */
+#define ALVS_SVC_F_NON_SYN_DROP		0x00010000	/* drop the frame */
+#define ALVS_SVC_F_NON_SYN_PUNT		0x00020000	/* send the frame to host, rate limited */
+#define ALVS_SVC_F_NON_SYN_MASK		(ALVS_SVC_F_NON_SYN_DROP | ALVS_SVC_F_NON_SYN_PUNT)
+
+/*ALVS forwarding method - unused value of IP_VS_CONN_F_FWD_MASK (as in
+ *IPVS FULLNAT patches). both addresses of the frame are rewritten - client
+ *address and port to the full NAT local address and a local port allocated
+ *by DP, virtual address and port to the server.
+ */
+#define ALVS_CONN_F_FULLNAT		0x0005
+
 
 
 /*********************************
@@ -155,18 +265,98 @@ struct alvs_sched_info_result {
 	unsigned             /*reserved*/  : 24;
 	/*byte4-7*/
 	uint32_t             server_index;
-	/*byte8-11*/
-	unsigned             /*reserved*/  : 32;
+	/*byte8-9*/
+	uint16_t             weight;        /* server weight - used by least connection schedulers */
+	/*byte10-11*/
+	unsigned             /*reserved*/  : 16;
 	/*byte12-15*/
 	unsigned             /*reserved*/  : 32;
 };
 
 CASSERT(sizeof(struct alvs_sched_info_result) == 16);
 
+/*********************************
+ * LBLC info DB defs
+ *********************************/
+
+/*destination to server assignment of LBLC/LBLCR services. written by DP,
+ *entry of a destination is at hash of service index and destination
+ *address - a destination hashed to an entry of another destination takes
+ *the entry over.
+ */
+#define ALVS_LBLC_MAX_SERVERS 2 /* assigned server and replica (LBLCR) */
+
+/*key*/
+struct alvs_lblc_info_key {
+	uint32_t lblc_index;
+} __packed;
+
+CASSERT(sizeof(struct alvs_lblc_info_key) == 4);
+
+struct alvs_lblc_server {
+	uint32_t             server_index;
+	uint16_t             weight;
+	unsigned             /*reserved*/  : 16;
+};
+
+/*result*/
+struct alvs_lblc_info_result {
+	/*byte0*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             server_count  : 4;
+#else
+	unsigned             server_count  : 4;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+#endif
+	/*byte1*/
+	uint8_t              service_index;
+	/*byte2*/
+	uint8_t              age;               /* aging iterations left */
+	/*byte3*/
+	unsigned             /*reserved*/  : 8;
+	/*byte4-7*/
+	in_addr_t            dest_ip;
+	/*byte8-9*/
+	uint16_t             server_config_gen; /* servers were validated in this generation */
+	/*byte10-15*/
+	unsigned             /*reserved*/  : 16;
+	unsigned             /*reserved*/  : 32;
+	/*byte16-31*/
+	struct alvs_lblc_server servers[ALVS_LBLC_MAX_SERVERS];
+};
+
+CASSERT(sizeof(struct alvs_lblc_info_result) == 32);
+
 /*********************************
  * Connection classification DB defs
  *********************************/
 
+/*tcp connection state - values match IPVS (IP_VS_TCP_S_*)*/
+enum alvs_tcp_conn_state {
+	IP_VS_TCP_S_NONE	= 0,
+	IP_VS_TCP_S_ESTABLISHED	= 1,
+	IP_VS_TCP_S_SYN_SENT	= 2,
+	IP_VS_TCP_S_SYN_RECV	= 3,
+	IP_VS_TCP_S_FIN_WAIT	= 4,
+	IP_VS_TCP_S_TIME_WAIT	= 5,
+	IP_VS_TCP_S_CLOSE	= 6,
+	IP_VS_TCP_S_CLOSE_WAIT	= 7,
+	IP_VS_TCP_S_LAST_ACK	= 8,
+	IP_VS_TCP_S_LISTEN	= 9,
+	IP_VS_TCP_S_SYNACK	= 10,
+	IP_VS_TCP_S_LAST	= 11
+};
+
+/*udp connection state - IPVS keeps a single state for UDP.
+ *stored in the same conn_state field as tcp connection state
+ */
+enum alvs_udp_conn_state {
+	IP_VS_UDP_S_NORMAL	= 0
+};
+
 /*key*/
 struct alvs_conn_classification_key {
 	in_addr_t client_ip;
@@ -179,6 +369,62 @@ struct alvs_conn_classification_key {
 CASSERT(sizeof(struct alvs_conn_classification_key) == 14);
 
 /*result*/
+#ifdef ALVS_CONN_INLINE_INFO
+/* hot fields of connection info are duplicated in the result and kept in
+ * sync by connection info writers. connection info entry is read by the
+ * fast path only under connection lock.
+ */
+struct alvs_conn_classification_result {
+	/*byte0*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+
+	unsigned             /*reserved*/  : 3;
+	unsigned             reset_bit     : 1;
+#else
+	unsigned             reset_bit     : 1;
+	unsigned             /*reserved*/  : 3;
+
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+#endif
+	/*byte1*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : 7;
+	unsigned             bound         : 1;
+#else
+	unsigned             bound         : 1;
+	unsigned             /*reserved*/  : 7;
+#endif
+	/*byte2-3*/
+	union {
+		uint16_t             local_port;          /* bound - full NAT local port */
+		uint16_t             server_port;         /* not bound */
+	};
+	/*byte4-7*/
+	uint32_t             conn_index;
+	/*byte8-11*/
+	union {
+		uint32_t             server_index;        /* bound */
+		in_addr_t            server_addr;         /* not bound */
+	};
+	/*byte12*/
+	enum alvs_tcp_conn_state conn_state :8;
+	/*byte13*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : 5;
+	unsigned             fwd_method    : 3;   /* IP_VS_CONN_F_FWD_MASK of connection flags */
+#else
+	unsigned             fwd_method    : 3;   /* IP_VS_CONN_F_FWD_MASK of connection flags */
+	unsigned             /*reserved*/  : 5;
+#endif
+	/*byte14-15*/
+	uint16_t             bind_gen;            /* not bound */
+};
+
+CASSERT(sizeof(struct alvs_conn_classification_result) == 16);
+#else
 struct alvs_conn_classification_result {
 	/*byte0*/
 #ifdef NPS_BIG_ENDIAN
@@ -197,28 +443,85 @@ struct alvs_conn_classification_result {
 };
 
 CASSERT(sizeof(struct alvs_conn_classification_result) == 8);
-
+#endif
 
 /*********************************
- * Connection info DB defs
+ * NAT classification DB defs
  *********************************/
 
-/*tcp connection state*/
-enum alvs_tcp_conn_state {
-	IP_VS_TCP_S_NONE	= 0,
-	IP_VS_TCP_S_ESTABLISHED	= 1,
-	IP_VS_TCP_S_CLOSE_WAIT	= 7
+/* server to client direction of NAT (masquerade) and full NAT connections.
+ * entry is added and removed by the data path together with the
+ * connection classification entry. client address and port of full NAT
+ * entries are the local address and port the server replies to.
+ */
+
+/*key*/
+struct alvs_nat_classification_key {
+	in_addr_t server_ip;
+	in_addr_t client_ip;
+	uint16_t  server_port;
+	uint16_t  client_port;
+	uint16_t  protocol;
+} __packed;
+
+CASSERT(sizeof(struct alvs_nat_classification_key) == 14);
+
+/*result*/
+struct alvs_nat_classification_result {
+	/*byte0*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : 3;
+	unsigned             fullnat       : 1;   /* client address is taken from connection info */
+#else
+	unsigned             fullnat       : 1;   /* client address is taken from connection info */
+	unsigned             /*reserved*/  : 3;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+#endif
+	/*byte1*/
+	unsigned             /*reserved*/  : 8;
+	/*byte2-3*/
+	uint16_t             virtual_port;
+	/*byte4-7*/
+	uint32_t             conn_index;
+	/*byte8-11*/
+	in_addr_t            virtual_ip;
+	/*byte12-15*/
+	unsigned             /*reserved*/  : 32;
 };
 
+CASSERT(sizeof(struct alvs_nat_classification_result) == 16);
+
+
+/*********************************
+ * Connection info DB defs
+ *********************************/
+
 /*amount of aging iterations before timeout
  * for tcp connection state.
+ * derived from IPVS default timeouts (ALVS_TIMER_INTERVAL_SEC per iteration).
  * must be >0 and <256 due to use of ezdp_mod
  */
 enum alvs_conn_aging_iterations {
+	ALVS_TCP_CONN_ITER_NONE		= 1,
 	ALVS_TCP_CONN_ITER_ESTABLISHED	= 60,
-	ALVS_TCP_CONN_ITER_CLOSE_WAIT	= 1
+	ALVS_TCP_CONN_ITER_SYN_SENT	= 8,
+	ALVS_TCP_CONN_ITER_SYN_RECV	= 1,	/* half-open - expire fast */
+	ALVS_TCP_CONN_ITER_FIN_WAIT	= 8,
+	ALVS_TCP_CONN_ITER_TIME_WAIT	= 8,
+	ALVS_TCP_CONN_ITER_CLOSE	= 1,
+	ALVS_TCP_CONN_ITER_CLOSE_WAIT	= 1,
+	ALVS_TCP_CONN_ITER_LAST_ACK	= 2,
+	ALVS_TCP_CONN_ITER_LISTEN	= 8,
+	ALVS_TCP_CONN_ITER_SYNACK	= 8,
+	ALVS_UDP_CONN_ITER_NORMAL	= 19
 };
 
+/*persistence template timeout is limited to a single aging cycle*/
+#define ALVS_PERSIST_MAX_ITERATIONS	ALVS_TCP_CONN_ITER_ESTABLISHED
+
 /*key*/
 struct alvs_conn_info_key {
 	uint32_t conn_index;
@@ -248,15 +551,17 @@ struct alvs_conn_info_result {
 #endif
 	/*byte1*/
 #ifdef NPS_BIG_ENDIAN
-	unsigned             /*reserved*/  : 7;
+	unsigned             /*reserved*/  : 3;
+	enum alvs_tcp_conn_state conn_state :4;
 	uint8_t              bound         : 1;
 #else
 	uint8_t              bound         : 1;
-	unsigned             /*reserved*/  : 7;
+	enum alvs_tcp_conn_state conn_state :4;
+	unsigned             /*reserved*/  : 3;
 #endif
 	/*byte2-3*/
 	union {
-		unsigned             /*reserved*/  : 16;  /* bound */
+		uint16_t             local_port;          /* bound - full NAT local port */
 		uint16_t             server_port;         /* not bound */
 	};
 	/*byte4-7*/
@@ -264,20 +569,88 @@ struct alvs_conn_info_result {
 		uint32_t             server_index;        /* bound */
 		in_addr_t            server_addr;         /* not bound */
 	};
-	/*byte8-11*/
-	unsigned             /*reserved*/  : 32;
+	/*byte8*/
+	uint8_t              service_index;
+	/*byte9*/
+	uint8_t              age_iteration;
+	/*byte10-11*/
+	union {
+		uint16_t             bind_gen;            /* not bound - server config generation of last bind attempt */
+		uint16_t             nat_server_port;     /* bound - server port of NAT classification key */
+	};
 	/*byte12-25*/
 	struct alvs_conn_classification_key conn_class_key;
-	/*byte26*/
-	enum alvs_tcp_conn_state conn_state :8;
-	/*byte27*/
-	uint8_t              age_iteration;
+	/*byte26-27*/
+	uint16_t             conn_flags;          /* as in state sync messages */
 	/*byte28-31*/
-	uint32_t             conn_flags;
+	in_addr_t            nat_server_ip;       /* bound - server address of NAT classification key */
 };
 
 CASSERT(sizeof(struct alvs_conn_info_result) == 32);
 
+#ifdef ALVS_CONN_COMPACT
+/* compact connection info entry - stored in connection info DB instead of
+ * alvs_conn_info_result. virtual address, port and protocol are replaced by
+ * the service index and connection flags are kept in 16 bits as in state
+ * sync messages. unbound connections keep only forwarding method and
+ * inactive flag.
+ */
+struct alvs_conn_compact_info_result {
+	/*byte0*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+
+	uint8_t              inactive      : 1;
+	uint8_t              aging_bit     : 1;
+	uint8_t              delete_bit    : 1;
+	uint8_t              reset_bit     : 1;
+#else
+	uint8_t              reset_bit     : 1;
+	uint8_t              delete_bit    : 1;
+	uint8_t              aging_bit     : 1;
+	uint8_t              inactive      : 1;
+
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+#endif
+	/*byte1*/
+#ifdef NPS_BIG_ENDIAN
+	uint8_t              fwd_method    : 3;
+	enum alvs_tcp_conn_state conn_state :4;
+	uint8_t              bound         : 1;
+#else
+	uint8_t              bound         : 1;
+	enum alvs_tcp_conn_state conn_state :4;
+	uint8_t              fwd_method    : 3;
+#endif
+	/*byte2*/
+	uint8_t              service_index;
+	/*byte3*/
+	uint8_t              age_iteration;
+	/*byte4-7*/
+	union {
+		uint32_t             server_index;        /* bound */
+		in_addr_t            server_addr;         /* not bound */
+	};
+	/*byte8-9*/
+	union {
+		uint16_t             conn_flags;          /* bound */
+		uint16_t             server_port;         /* not bound */
+	};
+	/*byte10-11*/
+	uint16_t             client_port;
+	/*byte12-15*/
+	in_addr_t            client_ip;
+};
+
+CASSERT(sizeof(struct alvs_conn_compact_info_result) == 16);
+
+#define ALVS_CONN_INFO_ENTRY_SIZE	sizeof(struct alvs_conn_compact_info_result)
+#else
+#define ALVS_CONN_INFO_ENTRY_SIZE	sizeof(struct alvs_conn_info_result)
+#endif
+
 /*********************************
  * Server info DB defs
  *********************************/
@@ -327,6 +700,34 @@ struct alvs_server_info_result {
 
 CASSERT(sizeof(struct alvs_server_info_result) == 32);
 
+/*********************************
+ * Server IPv6 info DB defs
+ *********************************/
+
+/* key is struct alvs_server_info_key */
+
+/*result*/
+struct alvs_server6_info_result {
+	/*byte0*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : 4;
+#else
+	unsigned             /*reserved*/  : 4;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+#endif
+	/*byte1-3*/
+	unsigned             /*reserved*/  : 24;
+	/*byte4-19*/
+	struct in6_addr      server_ip;
+	/*byte20-31*/
+	uint32_t             reserved[3];
+};
+
+CASSERT(sizeof(struct alvs_server6_info_result) == 32);
+
 
 
 /*********************************
@@ -395,9 +796,11 @@ struct alvs_app_info_result {
 	/*byte4-7*/
 	in_addr_t	source_ip;
 	/*byte8-11*/
-	unsigned	/*reserved*/ : 32;
-	/*byte12-15*/
-	unsigned	/*reserved*/ : 32;
+	in_addr_t	tunnel_source_ip;	/* 0 - use source_ip */
+	/*byte12-13*/
+	uint16_t	tunnel_mtu;
+	/*byte14-15*/
+	unsigned	/*reserved*/ : 16;
 };
 
 CASSERT(sizeof(struct alvs_app_info_result) == 16);
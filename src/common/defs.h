@@ -55,8 +55,29 @@ struct net_hdr {
 
 #define ALVS_SIZE_OF_SCHED_BUCKET   256
 
+/* compact connection info entry is half the size - same memory holds twice the connections */
+#ifdef ALVS_CONN_COMPACT
+#define ALVS_CONN_MAX_ENTRIES       (128*1024*1024)
+#else
 #define ALVS_CONN_MAX_ENTRIES       (64*1024*1024)
+#endif
+/* server to client entries of NAT and full NAT connections - NAT needs the full connection entry */
+#ifdef ALVS_CONN_COMPACT
+#define ALVS_NAT_MAX_ENTRIES        (64*1024)
+#else
+#define ALVS_NAT_MAX_ENTRIES        (ALVS_CONN_MAX_ENTRIES / 4)
+#endif
+/* half-open (SYN_RECV) connections of one service - a SYN flood on a service does not starve other services */
+#define ALVS_CONN_HALF_OPEN_PER_SERVICE      (ALVS_CONN_MAX_ENTRIES / 32)
+/* connection indexes kept free of half-open connections - a SYN flood on many services can not exhaust the pool */
+#define ALVS_CONN_HALF_OPEN_RESERVED_INDEXES (ALVS_CONN_MAX_ENTRIES / 8)
+/* path MTU towards IP-in-IP tunneled servers (outer header included) */
+#define ALVS_TUNNEL_DEFAULT_MTU     1500
+#define ALVS_TUNNEL_MIN_MTU         88     /* IPv4 minimum MTU + outer header */
 #define ALVS_SERVICES_MAX_ENTRIES   256
+#define ALVS_FWMARK_MAX_ENTRIES     8192   /* service classification entries of firewall mark services */
+#define ALVS_VIP_FILTER_ENTRIES     4096   /* must be a power of 2 */
+#define ALVS_LBLC_MAX_ENTRIES       (64*1024) /* destinations of LBLC/LBLCR services - must be a power of 2 */
 #define ALVS_SCHED_MAX_ENTRIES      (ALVS_SERVICES_MAX_ENTRIES * ALVS_SIZE_OF_SCHED_BUCKET)
 #define ALVS_SERVERS_MAX_ENTRIES    (ALVS_SERVICES_MAX_ENTRIES * 1024)
 
@@ -79,6 +100,8 @@ enum alvs_server_posted_stats_offsets {
 };
 enum alvs_server_on_demand_stats_offsets {
 	ALVS_SERVER_STATS_CONNECTION_TOTAL_OFFSET = 0,
+	ALVS_SERVER_STATS_ACTIVE_CONN_ON_DEMAND_OFFSET = 1,
+	ALVS_SERVER_STATS_INACTIVE_CONN_ON_DEMAND_OFFSET = 2,
 	ALVS_NUM_OF_SERVERS_ON_DEMAND_STATS
 };
 
@@ -96,6 +119,7 @@ enum nw_if_posted_stats_offsets {
 	NW_IF_STATS_FAIL_FIB_LOOKUP         = 9,
 	NW_IF_STATS_REJECT_BY_FIB           = 10,
 	NW_IF_STATS_UNKNOWN_FIB_RESULT	    = 11,
+	NW_IF_STATS_IPV6_ERROR              = 12,
 
 	/*
 	 * Note: 1. The following define must be at the end.
@@ -136,6 +160,15 @@ enum alvs_error_stats_offsets {
 	ALVS_ERROR_STATE_SYNC_BAD_BUFFER       = 28,
 	ALVS_ERROR_STATE_SYNC_DECODE_CONN       = 29,
 	ALVS_ERROR_STATE_SYNC_BAD_MESSAGE_VERSION  = 30,
+	ALVS_ERROR_NON_SYN_MISS_DROP            = 31,
+	ALVS_ERROR_NON_SYN_MISS_PUNT_LIMIT      = 32,
+	ALVS_ERROR_HALF_OPEN_LIMIT              = 33,
+	ALVS_ERROR_NAT_CLASS_ALLOC_FAIL         = 34,
+	ALVS_ERROR_TUNNEL_NO_HEADROOM           = 35,
+	ALVS_ERROR_TUNNEL_NO_SOURCE_IP          = 36,
+	ALVS_ERROR_TUNNEL_FRAG_NEEDED           = 37,
+	ALVS_ERROR_FULLNAT_PORT_ALLOC_FAIL      = 38,
+	ALVS_ERROR_TUNNEL_MTU_EXCEEDED          = 39,
 	ALVS_NUM_OF_ALVS_ERROR_STATS            = 40 /* MUST BE EVEN! */
 };
 
@@ -160,6 +193,32 @@ enum alvs_error_stats_offsets {
 #define EMEM_SERVER_FLAGS_OFFSET	(EMEM_SPINLOCK_OFFSET + ALVS_CONN_LOCK_ELEMENTS_COUNT)
 #define EMEM_SERVER_FLAGS_OFFSET_CP	(EMEM_SPINLOCK_OFFSET + ALVS_CONN_LOCK_ELEMENTS_COUNT * 4) /*TODO - change to sizeof()*/
 
+/*connection refresh bitmap - one bit per connection index, set by DP without taking the connection lock*/
+#define EMEM_CONN_REFRESH_FLAGS_MSID	USER_EMEM_OUT_OF_BAND_MSID
+#define EMEM_CONN_REFRESH_FLAGS_OFFSET	(EMEM_SERVER_FLAGS_OFFSET + ALVS_SERVERS_MAX_ENTRIES)
+#define EMEM_CONN_REFRESH_FLAGS_COUNT	(ALVS_CONN_MAX_ENTRIES / 32)
+
+/*route generation - bumped by CP on every FIB/ARP change to invalidate DP next hop entries*/
+#define EMEM_NW_ROUTE_GEN_MSID		USER_EMEM_OUT_OF_BAND_MSID
+#define EMEM_NW_ROUTE_GEN_OFFSET	(EMEM_CONN_REFRESH_FLAGS_OFFSET + EMEM_CONN_REFRESH_FLAGS_COUNT)
+#define EMEM_NW_ROUTE_GEN_OFFSET_CP	(EMEM_NW_ROUTE_GEN_OFFSET * 4)
+
+/*service virtual address/port/protocol by service index - used to rebuild compact connection keys*/
+#define EMEM_SERVICE_KEY_MSID		USER_EMEM_OUT_OF_BAND_MSID
+#define EMEM_SERVICE_KEY_OFFSET		(EMEM_NW_ROUTE_GEN_OFFSET + 1)
+#define EMEM_SERVICE_KEY_OFFSET_CP	(EMEM_SERVICE_KEY_OFFSET * 4)
+#define EMEM_SERVICE_KEY_ELEMENTS	2
+
+/*server config generation - bumped by CP on every server add, unbound connections retry to bind only when it changes*/
+#define EMEM_SERVER_CONFIG_GEN_MSID	USER_EMEM_OUT_OF_BAND_MSID
+#define EMEM_SERVER_CONFIG_GEN_OFFSET	(EMEM_SERVICE_KEY_OFFSET + ALVS_SERVICES_MAX_ENTRIES * EMEM_SERVICE_KEY_ELEMENTS)
+#define EMEM_SERVER_CONFIG_GEN_OFFSET_CP	(EMEM_SERVER_CONFIG_GEN_OFFSET * 4)
+
+/*full NAT local address - written once by CP, source address of frames sent to full NAT servers*/
+#define EMEM_FULLNAT_LOCAL_IP_MSID	USER_EMEM_OUT_OF_BAND_MSID
+#define EMEM_FULLNAT_LOCAL_IP_OFFSET	(EMEM_SERVER_CONFIG_GEN_OFFSET + 1)
+#define EMEM_FULLNAT_LOCAL_IP_OFFSET_CP	(EMEM_FULLNAT_LOCAL_IP_OFFSET * 4)
+
 /*definition of long counters for server needs*/
 #define EMEM_SERVER_STATS_ON_DEMAND_MSID USER_ON_DEMAND_STATS_MSID
 #define EMEM_SERVER_STATS_ON_DEMAND_OFFSET 0x0
@@ -175,14 +234,32 @@ enum alvs_error_stats_offsets {
 #define EMEM_STATS_ON_DEMAND_TB_OFFSET         (EMEM_STATS_ON_DEMAND_COLOR_FLAG_OFFSET + EMEM_STATS_ON_DEMAND_COLOR_FLAG_NUM)
 #define EMEM_STATS_ON_DEMAND_TB_STATS_NUM      1
 
+/*definition of TB counter - rate limit of non-SYN connection misses sent to host*/
+#define EMEM_STATS_ON_DEMAND_NON_SYN_TB_OFFSET (EMEM_STATS_ON_DEMAND_TB_OFFSET + EMEM_STATS_ON_DEMAND_TB_STATS_NUM)
+#define EMEM_STATS_ON_DEMAND_NON_SYN_TB_NUM    1
+
+/*definition of long counters for service half-open (SYN_RECV) connections*/
+#define EMEM_STATS_ON_DEMAND_HALF_OPEN_OFFSET  (EMEM_STATS_ON_DEMAND_NON_SYN_TB_OFFSET + EMEM_STATS_ON_DEMAND_NON_SYN_TB_NUM)
+#define EMEM_STATS_ON_DEMAND_HALF_OPEN_NUM     ALVS_SERVICES_MAX_ENTRIES
 
 #define ALVS_TB_PROFILE_0_CIR_RESOLUTION EZapiStat_TBProfileResolution_1_BYTE
 #define ALVS_TB_PROFILE_0_CIR            0x40000000
 #define ALVS_TB_PROFILE_0_CBS            0x40000000
 
+/*non-SYN miss punt - each frame is charged ALVS_NON_SYN_PUNT_TB_SIZE, CIR is in frames per second*/
+#define ALVS_NON_SYN_PUNT_TB_SIZE        1
+#define ALVS_TB_PROFILE_1_CIR_RESOLUTION EZapiStat_TBProfileResolution_1_BYTE
+#define ALVS_TB_PROFILE_1_CIR            10000
+#define ALVS_TB_PROFILE_1_CBS            1000
+
 #define ALVS_HOST_LOGICAL_ID            USER_HOST_LOGICAL_ID
 #define ALVS_AGING_TIMER_LOGICAL_ID     USER_TIMER_LOGICAL_ID
 #define ALVS_CONN_INDEX_POOL_ID	        USER_POOL_ID
+#define ALVS_FULLNAT_PORT_POOL_ID       USER_FULLNAT_POOL_ID
+
+/*full NAT local ports - index i of the port pool is local port ALVS_FULLNAT_MIN_PORT + i*/
+#define ALVS_FULLNAT_MIN_PORT           1024
+#define ALVS_FULLNAT_PORT_COUNT         (65536 - ALVS_FULLNAT_MIN_PORT)
 
 enum struct_id {
 	STRUCT_ID_NW_INTERFACES                = 0,
@@ -197,13 +274,26 @@ enum struct_id {
 	STRUCT_ID_NW_ARP                       = 9,
 	STRUCT_ID_ALVS_SERVER_CLASSIFICATION   = 10,
 	STRUCT_ID_APPLICATION_INFO             = 11,
+	STRUCT_ID_NW_NEXT_HOP                  = 12,
+	STRUCT_ID_ALVS_SERVICE6_CLASSIFICATION = 13,
+	STRUCT_ID_ALVS_SERVER6_INFO            = 14,
+	STRUCT_ID_NW_ARP6                      = 15,
+	STRUCT_ID_NW_FIB6_GW                   = 16,
+	STRUCT_ID_ALVS_NAT_CLASSIFICATION      = 17,
+	STRUCT_ID_ALVS_VIP_FILTER              = 18,
+	STRUCT_ID_ALVS_LBLC_INFO               = 19,
 	NUM_OF_STRUCT_IDS
 };
 
 
 /* timer defines */
+#define ALVS_TIMER_INTERVAL_SEC 16
 #define ALVS_AGING_TIMER_SCAN_ENTRIES_PER_JOB   128
 #define ALVS_AGING_TIMER_EVENTS_PER_ITERATION   (ALVS_CONN_MAX_ENTRIES / ALVS_AGING_TIMER_SCAN_ENTRIES_PER_JOB)
+/*LBLC destination entry unused for 6 minutes (as IPVS) is aged out.
+ *one entry is aged by each of the first ALVS_LBLC_MAX_ENTRIES timer jobs of an iteration.
+ */
+#define ALVS_LBLC_AGING_ITERATIONS              ((6 * 60) / ALVS_TIMER_INTERVAL_SEC)
 
 
 #endif /* DEFS_H_ */
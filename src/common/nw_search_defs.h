@@ -100,6 +100,8 @@ CASSERT(sizeof(struct nw_if_result) == 16);
  * arp DB defs
  *********************************/
 
+#define NW_ARP_MAX_ENTRIES              (64 * 1024)
+
 /*key*/
 struct nw_arp_key {
 	in_addr_t real_server_address;
@@ -127,6 +129,59 @@ struct nw_arp_result {
 
 CASSERT(sizeof(struct nw_arp_result) == 8);
 
+/*********************************
+ * ARP6 (IPv6 neighbors) DB defs
+ *********************************/
+
+#define NW_ARP6_MAX_ENTRIES             (64 * 1024)
+
+/*key*/
+struct nw_arp6_key {
+	struct in6_addr real_server_address;
+};
+
+CASSERT(sizeof(struct nw_arp6_key) == 16);
+
+/* result is struct nw_arp_result */
+
+/*********************************
+ * next hop DB defs
+ *********************************/
+
+/* one entry per real server - holds the resolved FIB & ARP result */
+#define NW_NEXT_HOP_MAX_ENTRIES         (256 * 1024)
+
+/*key*/
+struct nw_next_hop_key {
+	uint32_t             next_hop_index;
+};
+
+CASSERT(sizeof(struct nw_next_hop_key) == 4);
+
+/*result*/
+struct nw_next_hop_result {
+	/*byte0*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : 4;
+#else
+	unsigned             /*reserved*/  : 4;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+#endif
+	/*byte1*/
+	uint8_t              base_logical_id;
+	/*byte2-7*/
+	struct ether_addr    dest_mac_addr;
+	/*byte8-11*/
+	uint32_t             route_gen;
+	/*byte12-15*/
+	in_addr_t            dest_ip;
+};
+
+CASSERT(sizeof(struct nw_next_hop_result) == 16);
+
 /*********************************
  * FIB DB defs
  *********************************/
@@ -182,4 +237,84 @@ struct nw_fib_result {
 
 CASSERT(sizeof(struct nw_fib_result) == 8);
 
+/*********************************
+ * FIB6 DB defs
+ *********************************/
+
+/* only one internal TCAM table can be configured per side - IPv6 FIB uses side 1 */
+#define NW_FIB6_TCAM_SIDE                1
+#define NW_FIB6_TCAM_LOOKUP_TABLE_COUNT  1
+#define NW_FIB6_TCAM_TABLE               0
+#define NW_FIB6_TCAM_PROFILE             0
+#define NW_FIB6_TCAM_MAX_SIZE            0x1000
+
+/*key*/
+struct nw_fib6_key {
+	/* bytes 0-3 */
+	uint32_t             rsv0;
+
+	/* bytes 4-19 */
+	struct in6_addr      dest_ip;
+} __packed;
+
+CASSERT(sizeof(struct nw_fib6_key) == 20);
+
+/*result*/
+struct nw_fib6_result {
+	/* byte 0-2 */
+#ifdef ALVS_BIG_ENDIAN
+	unsigned             match         : EZDP_LOOKUP_INT_TCAM_8B_DATA_RESULT_MATCH_SIZE;
+	unsigned             /*reserved*/  : 23;
+
+#else
+	unsigned             /*reserved*/  : 23;
+	unsigned             match         : EZDP_LOOKUP_INT_TCAM_8B_DATA_RESULT_MATCH_SIZE;
+
+#endif
+	/* byte 3 */
+	enum nw_fib_type     result_type    : 8;
+
+	/* bytes 4-7 */
+	uint32_t             gw_index;
+	/* IPv6 gateway does not fit TCAM result - index of FIB6 GW entry */
+};
+
+CASSERT(sizeof(struct nw_fib6_result) == 8);
+
+/*********************************
+ * FIB6 GW DB defs
+ *********************************/
+
+/* one entry per FIB6 TCAM entry - holds the gateway of NW_FIB_GW entries */
+#define NW_FIB6_GW_MAX_ENTRIES          NW_FIB6_TCAM_MAX_SIZE
+
+/*key*/
+struct nw_fib6_gw_key {
+	uint32_t             gw_index;
+};
+
+CASSERT(sizeof(struct nw_fib6_gw_key) == 4);
+
+/*result*/
+struct nw_fib6_gw_result {
+	/*byte0*/
+#ifdef NPS_BIG_ENDIAN
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : 4;
+#else
+	unsigned             /*reserved*/  : 4;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_RESERVED_BITS_SIZE;
+	unsigned             /*reserved*/  : EZDP_LOOKUP_PARITY_BITS_SIZE;
+#endif
+	/*byte1-3*/
+	unsigned             /*reserved*/  : 24;
+	/*byte4-19*/
+	struct in6_addr      gw_ip;
+	/*byte20-31*/
+	uint32_t             reserved[3];
+};
+
+CASSERT(sizeof(struct nw_fib6_gw_result) == 32);
+
 #endif /* NW_SEARCH_DEFS_H_ */
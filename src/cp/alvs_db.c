@@ -39,7 +39,9 @@
 #include <signal.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <byteswap.h>
 #include <arpa/inet.h>
 #include <netdb.h>
@@ -60,15 +62,30 @@
 sqlite3 *alvs_db;
 struct index_pool server_index_pool;
 struct index_pool service_index_pool;
+uint16_t vip_filter_refcnt[ALVS_VIP_FILTER_ENTRIES];
+uint16_t nat_server_filter_refcnt[ALVS_VIP_FILTER_ENTRIES];
+pthread_mutex_t vip_filter_lock = PTHREAD_MUTEX_INITIALIZER;
 pthread_t server_db_aging_thread;
 bool *alvs_db_cancel_application_flag_ptr;
+uint32_t alvs_db_server_config_gen;
+uint32_t alvs_db_addr6_alias_count;
 
 extern const char *alvs_error_stats_offsets_names[];
+extern uint32_t non_syn_miss_flags;
+extern in_addr_t tunnel_source_ip;
+extern uint16_t tunnel_mtu;
+extern in_addr_t fullnat_local_ip;
+extern char *fwmark_file;
 
 void server_db_aging(void);
 
 #define ALVS_DB_FILE_NAME "alvs.db"
 
+/* Index of a deleted service is reused only after its connections and
+ * persistence templates had a full aging cycle to expire.
+ */
+#define ALVS_DB_SERVICE_INDEX_QUARANTINE_SEC	(ALVS_PERSIST_MAX_ITERATIONS * ALVS_TIMER_INTERVAL_SEC)
+
 void server_db_exit_with_error(void);
 
 struct alvs_db_service_stats {
@@ -88,6 +105,7 @@ struct alvs_db_service {
 	enum alvs_scheduler_type sched_alg;
 	struct ezdp_sum_addr stats_base;
 	uint16_t sched_entries_count;
+	uint8_t persist_iterations;	/* 0 - not persistent */
 	/* used this statistics when we want to display stats, on reset we save those stats from original counters */
 	struct alvs_db_service_stats service_stats;
 };
@@ -130,6 +148,15 @@ struct alvs_db_application_info {
 	in_addr_t	source_ip;
 };
 
+/* operation on NPS service classification entries */
+enum alvs_db_class_op {
+	ALVS_DB_CLASS_ADD,
+	ALVS_DB_CLASS_MODIFY,
+	ALVS_DB_CLASS_DELETE
+};
+
+const char *alvs_db_class_op_name[] = {"add", "modify", "delete"};
+
 struct alvs_server_node {
 	struct alvs_db_server server;
 	struct alvs_server_node *next;
@@ -156,6 +183,246 @@ char *my_inet_ntoa(in_addr_t ip)
 #define TABLE_ENTRY_OUT_PACKET			10
 #define TABLE_ENTRY_OUT_BYTE			11
 #define TABLE_ENTRY_SCHED_ENTRIES_COUNT		12
+#define TABLE_ENTRY_PERSIST_ITERATIONS		13
+
+/**************************************************************************//**
+ * \brief       Add an address, port and protocol of a firewall mark to
+ *              internal DB
+ *
+ * \param[in]   fwmark     - firewall mark
+ * \param[in]   ip         - address (host order)
+ * \param[in]   port       - port
+ * \param[in]   protocol   - protocol
+ *
+ * \return      ALVS_DB_OK - entry added
+ *              ALVS_DB_FAILURE - address, port and protocol already mapped
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ */
+enum alvs_db_rc internal_db_add_fwmark_entry(uint32_t fwmark, in_addr_t ip, uint16_t port, uint16_t protocol)
+{
+	int rc;
+	char sql[256];
+	char *zErrMsg = NULL;
+
+	sprintf(sql, "INSERT INTO fwmarks "
+		"(fwmark, ip, port, protocol) "
+		"VALUES (%d, %d, %d, %d);",
+		fwmark, ip, port, protocol);
+
+	/* Execute SQL statement */
+	rc = sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg);
+	if (rc == SQLITE_CONSTRAINT) {
+		sqlite3_free(zErrMsg);
+		return ALVS_DB_FAILURE;
+	}
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s", zErrMsg);
+		sqlite3_free(zErrMsg);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	return ALVS_DB_OK;
+}
+
+/**************************************************************************//**
+ * \brief       Load firewall mark classification from file. every line is
+ *              <fwmark> <tcp|udp> <address>[/<prefix length>] <port>[-<last port>]
+ *              and is expanded to an entry per address and port. text after
+ *              '#' is ignored.
+ *
+ * \param[in]   file_name   - firewall mark file
+ *
+ * \return      ALVS_DB_OK - file loaded
+ *              ALVS_DB_FAILURE - bad file
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ */
+enum alvs_db_rc alvs_db_load_fwmarks(const char *file_name)
+{
+	FILE *file;
+	char line[256];
+	char proto_str[8];
+	char addr_str[32];
+	char *delim;
+	int fields;
+	uint32_t line_num = 0;
+	uint32_t entry_count = 0;
+	uint32_t fwmark;
+	uint32_t prefix_len;
+	uint32_t first_port, last_port, port;
+	uint32_t mask;
+	uint64_t ip, first_ip, last_ip;
+	uint16_t protocol;
+	struct in_addr addr;
+	enum alvs_db_rc rc = ALVS_DB_OK;
+
+	file = fopen(file_name, "r");
+	if (file == NULL) {
+		write_log(LOG_CRIT, "Can't open firewall mark file %s.", file_name);
+		return ALVS_DB_FAILURE;
+	}
+
+	while (rc == ALVS_DB_OK && fgets(line, sizeof(line), file) != NULL) {
+		line_num++;
+		delim = strchr(line, '#');
+		if (delim != NULL) {
+			*delim = '\0';
+		}
+
+		fields = sscanf(line, "%u %7s %31s %u-%u", &fwmark, proto_str, addr_str, &first_port, &last_port);
+		if (fields == EOF) {
+			/* empty line */
+			continue;
+		}
+		if (fields == 4) {
+			last_port = first_port;
+		}
+
+		prefix_len = 32;
+		delim = strchr(addr_str, '/');
+		if (delim != NULL) {
+			*delim = '\0';
+			prefix_len = strtoul(delim + 1, NULL, 10);
+		}
+
+		if (strcmp(proto_str, "tcp") == 0) {
+			protocol = IPPROTO_TCP;
+		} else if (strcmp(proto_str, "udp") == 0) {
+			protocol = IPPROTO_UDP;
+		} else {
+			protocol = 0;
+		}
+
+		if (fields < 4 || fwmark == 0 || protocol == 0 || prefix_len > 32 ||
+		    inet_aton(addr_str, &addr) == 0 ||
+		    first_port == 0 || first_port > last_port || last_port > UINT16_MAX) {
+			write_log(LOG_CRIT, "Bad firewall mark entry in %s line %d.", file_name, line_num);
+			rc = ALVS_DB_FAILURE;
+			break;
+		}
+
+		mask = (prefix_len == 0) ? 0 : ~0U << (32 - prefix_len);
+		first_ip = bswap_32(addr.s_addr) & mask;
+		last_ip = first_ip | ~mask;
+		if (entry_count + (last_ip - first_ip + 1) * (last_port - first_port + 1) > ALVS_FWMARK_MAX_ENTRIES) {
+			write_log(LOG_CRIT, "Too many firewall mark entries in %s line %d, maximum is %d.",
+				  file_name, line_num, ALVS_FWMARK_MAX_ENTRIES);
+			rc = ALVS_DB_FAILURE;
+			break;
+		}
+
+		for (ip = first_ip; rc == ALVS_DB_OK && ip <= last_ip; ip++) {
+			for (port = first_port; rc == ALVS_DB_OK && port <= last_port; port++) {
+				rc = internal_db_add_fwmark_entry(fwmark, ip, port, protocol);
+				if (rc == ALVS_DB_FAILURE) {
+					write_log(LOG_CRIT, "Firewall mark entry %s:%d in %s line %d is already mapped.",
+						  my_inet_ntoa(ip), port, file_name, line_num);
+				}
+			}
+		}
+		entry_count += (last_ip - first_ip + 1) * (last_port - first_port + 1);
+	}
+
+	fclose(file);
+	if (rc == ALVS_DB_OK) {
+		write_log(LOG_INFO, "Loaded %d firewall mark entries from %s.", entry_count, file_name);
+	}
+	return rc;
+}
+
+/**************************************************************************//**
+ * \brief       Get the firewall mark an address, port and protocol are
+ *              classified to
+ *
+ * \param[in]   service   - service with address, port and protocol
+ * \param[out]  fwmark    - firewall mark
+ *
+ * \return      ALVS_DB_OK - address, port and protocol are mapped
+ *              ALVS_DB_FAILURE - not mapped to any firewall mark
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ */
+enum alvs_db_rc internal_db_get_fwmark(struct alvs_db_service *service, uint32_t *fwmark)
+{
+	int rc;
+	sqlite3_stmt *statement;
+	char sql[256];
+
+	sprintf(sql, "SELECT fwmark FROM fwmarks "
+		"WHERE ip=%d AND port=%d AND protocol=%d;",
+		service->ip, service->port, service->protocol);
+
+	/* Prepare SQL statement */
+	rc = sqlite3_prepare_v2(alvs_db, sql, -1, &statement, NULL);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	/* Execute SQL statement */
+	rc = sqlite3_step(statement);
+
+	/* Error */
+	if (rc < SQLITE_ROW) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		sqlite3_finalize(statement);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	/* No mapping */
+	if (rc == SQLITE_DONE) {
+		sqlite3_finalize(statement);
+		return ALVS_DB_FAILURE;
+	}
+
+	*fwmark = sqlite3_column_int(statement, 0);
+	sqlite3_finalize(statement);
+	return ALVS_DB_OK;
+}
+
+/**************************************************************************//**
+ * \brief       Get the amount of addresses, ports and protocols classified
+ *              to a firewall mark
+ *
+ * \param[in]   fwmark        - firewall mark
+ * \param[out]  entry_count   - amount of entries
+ *
+ * \return      ALVS_DB_OK - count retrieved
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ */
+enum alvs_db_rc internal_db_get_fwmark_count(uint32_t fwmark, uint32_t *entry_count)
+{
+	int rc;
+	sqlite3_stmt *statement;
+	char sql[256];
+
+	sprintf(sql, "SELECT COUNT (fwmark) AS entry_count FROM fwmarks "
+		"WHERE fwmark=%d;",
+		fwmark);
+
+	/* Prepare SQL statement */
+	rc = sqlite3_prepare_v2(alvs_db, sql, -1, &statement, NULL);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	/* Execute SQL statement */
+	rc = sqlite3_step(statement);
+
+	/* In case of error return 0 */
+	if (rc != SQLITE_ROW) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		sqlite3_finalize(statement);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	*entry_count = sqlite3_column_int(statement, 0);
+	sqlite3_finalize(statement);
+	return ALVS_DB_OK;
+}
 
 enum alvs_db_rc alvs_db_init(bool *cancel_application_flag)
 {
@@ -212,6 +479,7 @@ enum alvs_db_rc alvs_db_init(bool *cancel_application_flag)
 		"out_packet BIGINT NOT NULL,"		/* TABLE_ENTRY_OUT_PACKET */
 		"out_byte BIGINT NOT NULL,"		/* TABLE_ENTRY_OUT_BYTE */
 		"sched_entries_count INT NOT NULL,"	/* TABLE_ENTRY_SCHED_ENTRIES_COUNT */
+		"persist_iterations INT NOT NULL,"	/* TABLE_ENTRY_PERSIST_ITERATIONS */
 		"PRIMARY KEY (ip,port,protocol));";
 
 	/* Execute SQL statement */
@@ -300,6 +568,80 @@ enum alvs_db_rc alvs_db_init(bool *cancel_application_flag)
 		return ALVS_DB_INTERNAL_ERROR;
 	}
 
+	/* Create the addr6_aliases table:
+	 * Fields:
+	 *    alias (host order address from 0.0.0.0/8)
+	 *    IPv6 address
+	 */
+	sql = "CREATE TABLE addr6_aliases("
+		"alias INT NOT NULL,"
+		"addr TEXT NOT NULL UNIQUE,"
+		"PRIMARY KEY (alias));";
+
+	/* Execute SQL statement */
+	rc = sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s", zErrMsg);
+		sqlite3_free(zErrMsg);
+		index_pool_destroy(&server_index_pool);
+		index_pool_destroy(&service_index_pool);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+	alvs_db_addr6_alias_count = 0;
+
+	/* Create the fwmarks table:
+	 * Fields:
+	 *    firewall mark
+	 *    ip address, port and protocol classified to the mark
+	 */
+	sql = "CREATE TABLE fwmarks("
+		"fwmark INT NOT NULL,"
+		"ip INT NOT NULL,"
+		"port INT NOT NULL,"
+		"protocol INT NOT NULL,"
+		"PRIMARY KEY (ip,port,protocol));";
+
+	/* Execute SQL statement */
+	rc = sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s", zErrMsg);
+		sqlite3_free(zErrMsg);
+		index_pool_destroy(&server_index_pool);
+		index_pool_destroy(&service_index_pool);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	/* Create the released_services table:
+	 * Fields:
+	 *    nps_index of a deleted service
+	 *    ip address, port and protocol of the deleted service
+	 *    time the last server of the service was aged (0 - not yet)
+	 */
+	sql = "CREATE TABLE released_services("
+		"nps_index INT NOT NULL,"
+		"ip INT NOT NULL,"
+		"port INT NOT NULL,"
+		"protocol INT NOT NULL,"
+		"drain_time BIGINT NOT NULL,"
+		"PRIMARY KEY (nps_index));";
+
+	/* Execute SQL statement */
+	rc = sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s", zErrMsg);
+		sqlite3_free(zErrMsg);
+		index_pool_destroy(&server_index_pool);
+		index_pool_destroy(&service_index_pool);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	if (fwmark_file != NULL && alvs_db_load_fwmarks(fwmark_file) != ALVS_DB_OK) {
+		write_log(LOG_CRIT, "Failed to load firewall marks from %s.", fwmark_file);
+		index_pool_destroy(&server_index_pool);
+		index_pool_destroy(&service_index_pool);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
 	alvs_db_cancel_application_flag_ptr = cancel_application_flag;
 
 	/* open aging thread */
@@ -325,40 +667,29 @@ void alvs_db_destroy(void)
 	index_pool_destroy(&server_index_pool);
 }
 
-#define EXCLUDE_WEIGHT_ZERO 0x1
-#define EXCLUDE_INACTIVE    0x2
-
 /**************************************************************************//**
- * \brief       Get number of active servers assigned to a service
+ * \brief       Get the alias of an IPv6 address. alias is allocated on first
+ *              use and is never released.
  *
- * \param[in]   service          - reference to the service
- * \param[out]  server_count     - number of active servers
- * \param[in]   flags            - any combination of the following:
- *                                    EXCLUDE_WEIGHT_ZERO
- *                                    EXCLUDE_INACTIVE
+ * \param[in]   addr6   - reference to IPv6 address
+ * \param[out]  alias   - alias address (host order)
  *
- * \return      ALVS_DB_OK - service exists (info is filled with service
- *                           information if it not NULL).
+ * \return      ALVS_DB_OK - alias found or allocated
+ *              ALVS_DB_NOT_SUPPORTED - out of aliases
  *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
  */
-enum alvs_db_rc internal_db_get_server_count(struct alvs_db_service *service,
-					     uint32_t *server_count,
-					     uint32_t flags)
+enum alvs_db_rc alvs_db_get_addr6_alias(struct in6_addr *addr6, in_addr_t *alias)
 {
 	int rc;
 	sqlite3_stmt *statement;
 	char sql[256];
+	char *zErrMsg = NULL;
+	char addr_str[INET6_ADDRSTRLEN];
 
-	sprintf(sql, "SELECT COUNT (nps_index) AS server_count FROM servers "
-		"WHERE srv_ip=%d AND srv_port=%d AND srv_protocol=%d",
-		service->ip, service->port, service->protocol);
-	if (flags & EXCLUDE_WEIGHT_ZERO) {
-		strcat(sql, " AND weight>0");
-	}
-	if (flags & EXCLUDE_INACTIVE) {
-		strcat(sql, " AND active=1");
-	}
-	strcat(sql, ";");
+	inet_ntop(AF_INET6, addr6, addr_str, sizeof(addr_str));
+	sprintf(sql, "SELECT alias FROM addr6_aliases "
+		"WHERE addr='%s';",
+		addr_str);
 
 	/* Prepare SQL statement */
 	rc = sqlite3_prepare_v2(alvs_db, sql, -1, &statement, NULL);
@@ -371,45 +702,186 @@ enum alvs_db_rc internal_db_get_server_count(struct alvs_db_service *service,
 	/* Execute SQL statement */
 	rc = sqlite3_step(statement);
 
-	/* In case of error return 0 */
-	if (rc != SQLITE_ROW) {
+	/* Error */
+	if (rc < SQLITE_ROW) {
 		write_log(LOG_CRIT, "SQL error: %s",
 			  sqlite3_errmsg(alvs_db));
 		sqlite3_finalize(statement);
 		return ALVS_DB_INTERNAL_ERROR;
 	}
 
-	/* retrieve count from result,
-	 * finalize SQL statement and return count
-	 */
-	*server_count = sqlite3_column_int(statement, 0);
+	/* Alias found */
+	if (rc == SQLITE_ROW) {
+		*alias = sqlite3_column_int(statement, 0);
+		sqlite3_finalize(statement);
+		return ALVS_DB_OK;
+	}
 	sqlite3_finalize(statement);
+
+	/* Allocate a new alias */
+	if (alvs_db_addr6_alias_count == ALVS_DB_ADDR6_ALIAS_MAX) {
+		write_log(LOG_ERR, "Can't allocate alias for %s. Reached maximum.", addr_str);
+		return ALVS_DB_NOT_SUPPORTED;
+	}
+	*alias = alvs_db_addr6_alias_count + 1;
+
+	sprintf(sql, "INSERT INTO addr6_aliases "
+		"(alias, addr) "
+		"VALUES (%d, '%s');",
+		*alias, addr_str);
+
+	/* Execute SQL statement */
+	rc = sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s", zErrMsg);
+		sqlite3_free(zErrMsg);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+	alvs_db_addr6_alias_count++;
+
+	write_log(LOG_DEBUG, "Allocated alias %s for %s", my_inet_ntoa(*alias), addr_str);
 	return ALVS_DB_OK;
 }
 
 /**************************************************************************//**
- * \brief       Update server_flags (OVERLOADED bit) according to the predefined algorithm
+ * \brief       Get the IPv6 address of an alias
  *
- * \param[in]   server   - server received from CP.
+ * \param[in]   alias   - alias address (host order)
+ * \param[out]  addr6   - reference to IPv6 address
  *
- * \return      true if operation succeeded
+ * \return      ALVS_DB_OK - address found
+ *              ALVS_DB_FAILURE - alias is not allocated
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
  */
-enum alvs_db_rc alvs_clear_overloaded_flag_of_server(struct alvs_db_server *cp_server)
+enum alvs_db_rc alvs_db_get_addr6_by_alias(in_addr_t alias, struct in6_addr *addr6)
 {
+	int rc;
+	sqlite3_stmt *statement;
+	char sql[256];
 
-	uint32_t server_flags = 0;
-	EZstatus ret_val;
-
-	write_log(LOG_DEBUG, "raw = 0x%x ext = %d msid = %d, lsb_addr = 0x%x",
-		  cp_server->server_flags_dp_base.raw_data,
-		  (cp_server->server_flags_dp_base.raw_data & EZDP_SUM_ADDR_MEM_TYPE_MASK) >> EZDP_SUM_ADDR_MEM_TYPE_OFFSET,
-		  (cp_server->server_flags_dp_base.raw_data & ~EZDP_SUM_ADDR_MEM_TYPE_MASK) >> EZDP_SUM_ADDR_MSID_OFFSET,
-		  (uint32_t)(EMEM_SERVER_FLAGS_OFFSET_CP + cp_server->nps_index * sizeof(server_flags)));
-
-	write_log(LOG_DEBUG, "from_msid %d to index %d", (cp_server->server_flags_dp_base.raw_data & ~EZDP_SUM_ADDR_MEM_TYPE_MASK) >> EZDP_SUM_ADDR_MSID_OFFSET,
-		  infra_from_msid_to_index(1, (cp_server->server_flags_dp_base.raw_data & ~EZDP_SUM_ADDR_MEM_TYPE_MASK) >> EZDP_SUM_ADDR_MSID_OFFSET));
+	sprintf(sql, "SELECT addr FROM addr6_aliases "
+		"WHERE alias=%d;",
+		alias);
 
-	ret_val =  EZapiPrm_WriteMem(0, /*uiChannelId*/
+	/* Prepare SQL statement */
+	rc = sqlite3_prepare_v2(alvs_db, sql, -1, &statement, NULL);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	/* Execute SQL statement */
+	rc = sqlite3_step(statement);
+
+	/* Error */
+	if (rc < SQLITE_ROW) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		sqlite3_finalize(statement);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	/* Alias not found */
+	if (rc == SQLITE_DONE) {
+		write_log(LOG_DEBUG, "No IPv6 address found for alias %s.", my_inet_ntoa(alias));
+		sqlite3_finalize(statement);
+		return ALVS_DB_FAILURE;
+	}
+
+	inet_pton(AF_INET6, (const char *)sqlite3_column_text(statement, 0), addr6);
+
+	/* finalize SQL statement */
+	sqlite3_finalize(statement);
+
+	return ALVS_DB_OK;
+}
+
+#define EXCLUDE_WEIGHT_ZERO 0x1
+#define EXCLUDE_INACTIVE    0x2
+
+/**************************************************************************//**
+ * \brief       Get number of active servers assigned to a service
+ *
+ * \param[in]   service          - reference to the service
+ * \param[out]  server_count     - number of active servers
+ * \param[in]   flags            - any combination of the following:
+ *                                    EXCLUDE_WEIGHT_ZERO
+ *                                    EXCLUDE_INACTIVE
+ *
+ * \return      ALVS_DB_OK - service exists (info is filled with service
+ *                           information if it not NULL).
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ */
+enum alvs_db_rc internal_db_get_server_count(struct alvs_db_service *service,
+					     uint32_t *server_count,
+					     uint32_t flags)
+{
+	int rc;
+	sqlite3_stmt *statement;
+	char sql[256];
+
+	sprintf(sql, "SELECT COUNT (nps_index) AS server_count FROM servers "
+		"WHERE srv_ip=%d AND srv_port=%d AND srv_protocol=%d",
+		service->ip, service->port, service->protocol);
+	if (flags & EXCLUDE_WEIGHT_ZERO) {
+		strcat(sql, " AND weight>0");
+	}
+	if (flags & EXCLUDE_INACTIVE) {
+		strcat(sql, " AND active=1");
+	}
+	strcat(sql, ";");
+
+	/* Prepare SQL statement */
+	rc = sqlite3_prepare_v2(alvs_db, sql, -1, &statement, NULL);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	/* Execute SQL statement */
+	rc = sqlite3_step(statement);
+
+	/* In case of error return 0 */
+	if (rc != SQLITE_ROW) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		sqlite3_finalize(statement);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	/* retrieve count from result,
+	 * finalize SQL statement and return count
+	 */
+	*server_count = sqlite3_column_int(statement, 0);
+	sqlite3_finalize(statement);
+	return ALVS_DB_OK;
+}
+
+/**************************************************************************//**
+ * \brief       Update server_flags (OVERLOADED bit) according to the predefined algorithm
+ *
+ * \param[in]   server   - server received from CP.
+ *
+ * \return      true if operation succeeded
+ */
+enum alvs_db_rc alvs_clear_overloaded_flag_of_server(struct alvs_db_server *cp_server)
+{
+
+	uint32_t server_flags = 0;
+	EZstatus ret_val;
+
+	write_log(LOG_DEBUG, "raw = 0x%x ext = %d msid = %d, lsb_addr = 0x%x",
+		  cp_server->server_flags_dp_base.raw_data,
+		  (cp_server->server_flags_dp_base.raw_data & EZDP_SUM_ADDR_MEM_TYPE_MASK) >> EZDP_SUM_ADDR_MEM_TYPE_OFFSET,
+		  (cp_server->server_flags_dp_base.raw_data & ~EZDP_SUM_ADDR_MEM_TYPE_MASK) >> EZDP_SUM_ADDR_MSID_OFFSET,
+		  (uint32_t)(EMEM_SERVER_FLAGS_OFFSET_CP + cp_server->nps_index * sizeof(server_flags)));
+
+	write_log(LOG_DEBUG, "from_msid %d to index %d", (cp_server->server_flags_dp_base.raw_data & ~EZDP_SUM_ADDR_MEM_TYPE_MASK) >> EZDP_SUM_ADDR_MSID_OFFSET,
+		  infra_from_msid_to_index(1, (cp_server->server_flags_dp_base.raw_data & ~EZDP_SUM_ADDR_MEM_TYPE_MASK) >> EZDP_SUM_ADDR_MSID_OFFSET));
+
+	ret_val =  EZapiPrm_WriteMem(0, /*uiChannelId*/
 				   (((cp_server->server_flags_dp_base.raw_data & EZDP_SUM_ADDR_MEM_TYPE_MASK) >> EZDP_SUM_ADDR_MEM_TYPE_OFFSET) == EZDP_EXTERNAL_MS) ? EZapiPrm_MemId_EXT_MEM : EZapiPrm_MemId_INT_MEM, /*eMemId*/
 				    infra_from_msid_to_index(1, (cp_server->server_flags_dp_base.raw_data & ~EZDP_SUM_ADDR_MEM_TYPE_MASK) >> EZDP_SUM_ADDR_MSID_OFFSET),
 				    EMEM_SERVER_FLAGS_OFFSET_CP + cp_server->nps_index * sizeof(server_flags),
@@ -520,6 +992,7 @@ enum alvs_db_rc internal_db_get_service(struct alvs_db_service *service,
 		service->service_stats.out_packet = sqlite3_column_int64(statement, TABLE_ENTRY_OUT_PACKET);
 		service->service_stats.out_byte = sqlite3_column_int64(statement, TABLE_ENTRY_OUT_BYTE);
 		service->sched_entries_count = sqlite3_column_int(statement, TABLE_ENTRY_SCHED_ENTRIES_COUNT);
+		service->persist_iterations = sqlite3_column_int(statement, TABLE_ENTRY_PERSIST_ITERATIONS);
 	}
 
 	/* finalize SQL statement */
@@ -546,13 +1019,13 @@ enum alvs_db_rc internal_db_add_service(struct alvs_db_service *service)
 
 	sprintf(sql, "INSERT INTO services "
 		"(ip, port, protocol, nps_index, flags, sched_alg, connection_scheduled, stats_base, "
-		"in_packet, in_byte, out_packet, out_byte, sched_entries_count) "
-		"VALUES (%d, %d, %d, %d, %d, %d, %ld, %d, %ld, %ld, %ld, %ld, %d);",
+		"in_packet, in_byte, out_packet, out_byte, sched_entries_count, persist_iterations) "
+		"VALUES (%d, %d, %d, %d, %d, %d, %ld, %d, %ld, %ld, %ld, %ld, %d, %d);",
 		service->ip, service->port, service->protocol,
 		service->nps_index, service->flags, service->sched_alg,
 		service->service_stats.connection_scheduled, service->stats_base.raw_data,
 		service->service_stats.in_packet, service->service_stats.in_byte, service->service_stats.out_packet,
-		service->service_stats.out_byte, service->sched_entries_count);
+		service->service_stats.out_byte, service->sched_entries_count, service->persist_iterations);
 
 	/* Execute SQL statement */
 	rc = sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg);
@@ -582,10 +1055,10 @@ enum alvs_db_rc internal_db_modify_service(struct alvs_db_service *service)
 	char *zErrMsg = NULL;
 
 	sprintf(sql, "UPDATE services "
-		"SET flags=%d, sched_alg=%d, sched_entries_count=%d "
+		"SET flags=%d, sched_alg=%d, sched_entries_count=%d, persist_iterations=%d "
 		"WHERE ip=%d AND port=%d AND protocol=%d;",
 		service->flags, service->sched_alg, service->sched_entries_count,
-		service->ip, service->port, service->protocol);
+		service->persist_iterations, service->ip, service->port, service->protocol);
 
 	/* Execute SQL statement */
 	rc = sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg);
@@ -701,6 +1174,106 @@ enum alvs_db_rc internal_db_delete_service(struct alvs_db_service *service)
 	return ALVS_DB_OK;
 }
 
+/**************************************************************************//**
+ * \brief       Quarantine the index of a deleted service. connections of the
+ *              service keep the index (compact connection entries rebuild
+ *              their key from it), so it is returned to the index pool by
+ *              server_db_aging() only after the servers of the service were
+ *              aged and a full aging cycle passed.
+ *
+ * \param[in]   service   - reference to the deleted service
+ *
+ * \return      ALVS_DB_OK - index quarantined
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ */
+enum alvs_db_rc internal_db_quarantine_service_index(struct alvs_db_service *service)
+{
+	int rc;
+	char sql[256];
+	char *zErrMsg = NULL;
+
+	sprintf(sql, "INSERT INTO released_services "
+		"(nps_index, ip, port, protocol, drain_time) "
+		"VALUES (%d, %d, %d, %d, 0);",
+		service->nps_index, service->ip, service->port,
+		service->protocol);
+
+	/* Execute SQL statement */
+	rc = sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s", zErrMsg);
+		sqlite3_free(zErrMsg);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	return ALVS_DB_OK;
+}
+
+/**************************************************************************//**
+ * \brief       Take back the quarantined index of a deleted service with the
+ *              same address, port and protocol. the key of the index is
+ *              unchanged, so its remaining connections stay valid.
+ *
+ * \param[in/out]   service   - reference to service, nps_index is filled
+ *
+ * \return      ALVS_DB_OK - index taken back
+ *              ALVS_DB_FAILURE - no quarantined index of the service
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ */
+enum alvs_db_rc internal_db_reclaim_service_index(struct alvs_db_service *service)
+{
+	int rc;
+	char sql[256];
+	char *zErrMsg = NULL;
+	sqlite3_stmt *statement;
+
+	sprintf(sql, "SELECT nps_index FROM released_services "
+		"WHERE ip=%d AND port=%d AND protocol=%d;",
+		service->ip, service->port, service->protocol);
+
+	/* Prepare SQL statement */
+	rc = sqlite3_prepare_v2(alvs_db, sql, -1, &statement, NULL);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	/* Execute SQL statement */
+	rc = sqlite3_step(statement);
+
+	/* Error */
+	if (rc < SQLITE_ROW) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		sqlite3_finalize(statement);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	/* No quarantined index */
+	if (rc == SQLITE_DONE) {
+		sqlite3_finalize(statement);
+		return ALVS_DB_FAILURE;
+	}
+
+	service->nps_index = sqlite3_column_int(statement, 0);
+	sqlite3_finalize(statement);
+
+	sprintf(sql, "DELETE FROM released_services "
+		"WHERE nps_index=%d;",
+		service->nps_index);
+
+	/* Execute SQL statement */
+	rc = sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s", zErrMsg);
+		sqlite3_free(zErrMsg);
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	return ALVS_DB_OK;
+}
+
 /**************************************************************************//**
  * \brief       Free server cyclic list created by get_server_list().
  *
@@ -1438,6 +2011,137 @@ void alvs_db_sh_fill_buckets(struct alvs_db_server *bucket[], struct alvs_server
 	}
 }
 
+/**************************************************************************//**
+ * \brief       Hash a server address for its Maglev permutation (FNV-1a).
+ *
+ * \param[in]   server   - server
+ * \param[in]   seed     - hash seed
+ *
+ * \return      hash value
+ */
+uint32_t alvs_db_maglev_hash(struct alvs_db_server *server, uint32_t seed)
+{
+	uint8_t data[sizeof(server->ip) + sizeof(server->port)];
+	uint32_t hash = 2166136261u ^ seed;
+	uint32_t ind;
+
+	memcpy(data, &server->ip, sizeof(server->ip));
+	memcpy(data + sizeof(server->ip), &server->port, sizeof(server->port));
+	for (ind = 0; ind < sizeof(data); ind++) {
+		hash = (hash ^ data[ind]) * 16777619u;
+	}
+	return hash;
+}
+
+/**************************************************************************//**
+ * \brief       Fills a bucket of 256 entries with Maglev consistent hashing.
+ *              every server has a permutation of the bucket entries derived
+ *              from its address (offset and odd skip - coprime with the bucket
+ *              size). servers take turns by weight to claim the next free entry
+ *              of their permutation, so adding or removing a server remaps
+ *              about 1/N of the entries.
+ *
+ * \param[in]   bucket        - bucket of 256 entries to be filled with servers from server_list
+ *                              bucket must be initialized with NULL
+ * \param[in]   server_list   - list of servers with weight > 0,
+ *                              server_list != NULL
+ * \param[in]   server_count  - number of servers in list, at most
+ *                              ALVS_SIZE_OF_SCHED_BUCKET (enforced on server add)
+ *
+ * \return      void
+ */
+void alvs_db_maglev_fill_buckets(struct alvs_db_server *bucket[], struct alvs_server_node *server_list, uint32_t server_count)
+{
+	struct alvs_maglev_state {
+		struct alvs_db_server *server;
+		uint32_t offset;
+		uint32_t skip;
+		uint32_t next;
+	} state[ALVS_SIZE_OF_SCHED_BUCKET];
+	uint32_t ind, entry, filled = 0, turn = 0;
+	uint16_t max_weight = 0;
+
+	if (server_count > ALVS_SIZE_OF_SCHED_BUCKET) {
+		server_count = ALVS_SIZE_OF_SCHED_BUCKET;
+	}
+
+	for (ind = 0; ind < server_count; ind++) {
+		state[ind].server = &(server_list->server);
+		state[ind].offset = alvs_db_maglev_hash(state[ind].server, 0) & (ALVS_SIZE_OF_SCHED_BUCKET - 1);
+		state[ind].skip = ((alvs_db_maglev_hash(state[ind].server, 1) % (ALVS_SIZE_OF_SCHED_BUCKET / 2)) * 2) + 1;
+		state[ind].next = 0;
+		if (server_list->server.weight > max_weight) {
+			max_weight = server_list->server.weight;
+		}
+		server_list = server_list->next;
+	}
+
+	/* callers pass only servers with weight > 0 (EXCLUDE_WEIGHT_ZERO) and
+	 * alvs_db_reduce_weights keeps them positive. guard anyway - with no
+	 * weight no server would ever claim an entry.
+	 */
+	if (max_weight == 0) {
+		write_log(LOG_ERR, "Maglev fill called with no weighted servers.");
+		return;
+	}
+
+	/* in every max_weight turns a server claims weight entries */
+	while (filled < ALVS_SIZE_OF_SCHED_BUCKET) {
+		for (ind = 0; ind < server_count && filled < ALVS_SIZE_OF_SCHED_BUCKET; ind++) {
+			if (turn % max_weight >= state[ind].server->weight) {
+				continue;
+			}
+			do {
+				entry = (state[ind].offset + state[ind].next * state[ind].skip) & (ALVS_SIZE_OF_SCHED_BUCKET - 1);
+				state[ind].next++;
+			} while (bucket[entry] != NULL);
+			bucket[entry] = state[ind].server;
+			filled++;
+		}
+		turn++;
+	}
+}
+
+/**************************************************************************//**
+ * \brief       Bump server config generation. DP retries to bind unbound
+ *              connections and revalidates servers of LBLC destinations
+ *              only when it changes.
+ *
+ * \return      ALVS_DB_OK - succeed.
+ *              ALVS_DB_NPS_ERROR - failed to write memory
+ */
+enum alvs_db_rc alvs_db_bump_server_config_gen(void)
+{
+	EZstatus ret_val;
+	uint32_t nps_server_config_gen;
+
+	alvs_db_server_config_gen++;
+	nps_server_config_gen = bswap_32(alvs_db_server_config_gen);
+	write_log(LOG_DEBUG, "Server config generation changed to %d", alvs_db_server_config_gen);
+
+	ret_val = EZapiPrm_WriteMem(0, /*uiChannelId*/
+				    EZapiPrm_MemId_EXT_MEM, /*eMemId*/
+				    infra_from_msid_to_index(1, EMEM_SERVER_CONFIG_GEN_MSID),
+				    EMEM_SERVER_CONFIG_GEN_OFFSET_CP,
+				    0, /* uiMSBAddress */
+				    0, /* bRange */
+				    0, /* uiRangeSize */
+				    0, /* uiRangeStep */
+				    0, /* bSingleCopy */
+				    0, /* bGCICopy */
+				    0, /* uiCopyIndex */
+				    sizeof(nps_server_config_gen),
+				    (EZuc8 *)&nps_server_config_gen, /*pucData*/
+				    0 /* pSpecialParams */);
+
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "alvs_db_bump_server_config_gen: EZapiPrm_WriteMem failed.");
+		return ALVS_DB_NPS_ERROR;
+	}
+
+	return ALVS_DB_OK;
+}
+
 /**************************************************************************//**
  * \brief       Recalculate scheduling info DB in NPS for a service.
  *
@@ -1475,7 +2179,15 @@ enum alvs_db_rc alvs_db_recalculate_scheduling_info(struct alvs_db_service *serv
 	if (server_count > 0) {
 		switch (service->sched_alg) {
 		case ALVS_SOURCE_HASH_SCHEDULER:
-			write_log(LOG_DEBUG, "filling bucket array according to SH scheduling algorithm.");
+		case ALVS_DESTINATION_HASH_SCHEDULER:
+			/* consistent hashing - server change remaps only its share of entries */
+			write_log(LOG_DEBUG, "filling bucket array according to SH/DH scheduling algorithm.");
+			alvs_db_reduce_weights(server_list, server_count);
+			alvs_db_maglev_fill_buckets(servers_buckets, server_list, server_count);
+			break;
+		case ALVS_TWO_CHOICES_SCHEDULER:
+			/* twos picks 2 random entries - all entries are filled by weight */
+			write_log(LOG_DEBUG, "filling bucket array according to twos scheduling algorithm.");
 			alvs_db_reduce_weights(server_list, server_count);
 			alvs_db_sh_fill_buckets(servers_buckets, server_list);
 			break;
@@ -1488,6 +2200,16 @@ enum alvs_db_rc alvs_db_recalculate_scheduling_info(struct alvs_db_service *serv
 			alvs_db_reduce_weights(server_list, server_count);
 			alvs_db_wrr_fill_buckets(servers_buckets, server_list, server_count);
 			break;
+		case ALVS_LEAST_CONNECTION_SCHEDULER:
+		case ALVS_WEIGHTED_LEAST_CONNECTION_SCHEDULER:
+		case ALVS_SHORTEST_EXPECTED_DELAY_SCHEDULER:
+		case ALVS_NEVER_QUEUE_SCHEDULER:
+		case ALVS_LB_LEAST_CONNECTION_SCHEDULER:
+		case ALVS_LB_LEAST_CONNECTION_SCHEDULER_WITH_REPLICATION:
+			/* DP scans all the entries and picks the least loaded server */
+			write_log(LOG_DEBUG, "filling bucket array according to LC/WLC/SED/NQ/LBLC/LBLCR scheduling algorithm.");
+			alvs_db_rr_fill_buckets(servers_buckets, server_list, server_count);
+			break;
 		default:
 			/* Other algorithms are currently not supported */
 			alvs_free_server_list(server_list);
@@ -1497,6 +2219,7 @@ enum alvs_db_rc alvs_db_recalculate_scheduling_info(struct alvs_db_service *serv
 	}
 
 	/* Populate NPS scheduling info DB according to array */
+	memset(&sched_info_result, 0, sizeof(sched_info_result));
 	service->sched_entries_count = 0;
 	for (ind = 0; ind < ALVS_SIZE_OF_SCHED_BUCKET; ind++) {
 		server = servers_buckets[ind];
@@ -1506,6 +2229,7 @@ enum alvs_db_rc alvs_db_recalculate_scheduling_info(struct alvs_db_service *serv
 			 * In case no entry, CP treats 'modify' as 'add'
 			 */
 			sched_info_result.server_index = bswap_32(server->nps_index);
+			sched_info_result.weight = bswap_16(server->weight);
 			write_log(LOG_DEBUG, "(%d) %d --> %d", service->nps_index, ind, server->nps_index);
 			if (infra_modify_entry(STRUCT_ID_ALVS_SCHED_INFO, &sched_info_key,
 					       sizeof(struct alvs_sched_info_key), &sched_info_result,
@@ -1534,6 +2258,15 @@ enum alvs_db_rc alvs_db_recalculate_scheduling_info(struct alvs_db_service *serv
 	/* Free the list when finished using */
 	alvs_free_server_list(server_list);
 
+	/* Let LBLC destinations revalidate their servers */
+	if (service->sched_alg == ALVS_LB_LEAST_CONNECTION_SCHEDULER ||
+	    service->sched_alg == ALVS_LB_LEAST_CONNECTION_SCHEDULER_WITH_REPLICATION) {
+		if (alvs_db_bump_server_config_gen() != ALVS_DB_OK) {
+			write_log(LOG_ERR, "Failed to bump server config generation.");
+			return ALVS_DB_NPS_ERROR;
+		}
+	}
+
 	write_log(LOG_DEBUG, "Scheduling info recalculated.");
 	return ALVS_DB_OK;
 }
@@ -1638,6 +2371,41 @@ enum alvs_db_rc alvs_db_clean_service_stats(uint32_t service_index)
 	return ALVS_DB_OK;
 }
 
+/**************************************************************************//**
+ * \brief       Write full NAT local address to NPS. DP uses it as source
+ *              address of frames sent to full NAT servers.
+ *
+ * \return      ALVS_DB_OK - succeed.
+ *              ALVS_DB_NPS_ERROR - failed to write memory
+ */
+enum alvs_db_rc alvs_db_write_fullnat_local_ip(void)
+{
+	EZstatus ret_val;
+	in_addr_t nps_fullnat_local_ip = bswap_32(fullnat_local_ip);
+
+	ret_val = EZapiPrm_WriteMem(0, /*uiChannelId*/
+				    EZapiPrm_MemId_EXT_MEM, /*eMemId*/
+				    infra_from_msid_to_index(1, EMEM_FULLNAT_LOCAL_IP_MSID),
+				    EMEM_FULLNAT_LOCAL_IP_OFFSET_CP,
+				    0, /* uiMSBAddress */
+				    0, /* bRange */
+				    0, /* uiRangeSize */
+				    0, /* uiRangeStep */
+				    0, /* bSingleCopy */
+				    0, /* bGCICopy */
+				    0, /* uiCopyIndex */
+				    sizeof(nps_fullnat_local_ip),
+				    (EZuc8 *)&nps_fullnat_local_ip, /*pucData*/
+				    0 /* pSpecialParams */);
+
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "alvs_db_write_fullnat_local_ip: EZapiPrm_WriteMem failed.");
+		return ALVS_DB_NPS_ERROR;
+	}
+
+	return ALVS_DB_OK;
+}
+
 /**************************************************************************//**
  * \brief       translate scheduling algorithm string to type
  *
@@ -1677,10 +2445,135 @@ enum alvs_scheduler_type get_sched_alg(char *sched_name)
 	if (strcmp(sched_name, "nq") == 0) {
 		return ALVS_NEVER_QUEUE_SCHEDULER;
 	}
+	if (strcmp(sched_name, "twos") == 0) {
+		return ALVS_TWO_CHOICES_SCHEDULER;
+	}
 
 	return ALVS_SCHEDULER_LAST;
 }
 
+/**************************************************************************//**
+ * \brief       translate persistence timeout to aging iterations. timeout is
+ *              rounded up and limited to a single aging cycle.
+ *
+ * \param[in]   timeout   - persistence timeout in seconds
+ *
+ * \return      amount of aging iterations
+ */
+uint8_t get_persist_iterations(uint32_t timeout)
+{
+	uint32_t iterations = (timeout + ALVS_TIMER_INTERVAL_SEC - 1) / ALVS_TIMER_INTERVAL_SEC;
+
+	if (iterations == 0) {
+		return 1;
+	}
+	if (iterations > ALVS_PERSIST_MAX_ITERATIONS) {
+		write_log(LOG_NOTICE, "Persistence timeout (%d) is above maximum (%d), maximum is used.",
+			  timeout, ALVS_PERSIST_MAX_ITERATIONS * ALVS_TIMER_INTERVAL_SEC);
+		return ALVS_PERSIST_MAX_ITERATIONS;
+	}
+	return iterations;
+}
+
+/**************************************************************************//**
+ * \brief       Checks if persistence of a service is supported by application.
+ *              client affinity is kept per client address only.
+ *
+ * \param[in]   ip_vs_service   - service reference
+ *
+ * \return      true/false
+ */
+bool supported_persistence(struct ip_vs_service_user *ip_vs_service)
+{
+	if ((ip_vs_service->flags & IP_VS_SVC_F_PERSISTENT) && ip_vs_service->netmask != 0xffffffff &&
+	    !ALVS_DB_IS_ADDR6_ALIAS(bswap_32(ip_vs_service->addr))) {
+		return false;
+	}
+	return true;
+}
+
+/**************************************************************************//**
+ * \brief       Build internal DB key (address, port and protocol) of a service.
+ *              firewall mark service is kept by its mark as address.
+ *
+ * \param[in]   ip_vs_service   - service reference
+ * \param[out]  cp_service      - internal service entry
+ *
+ * \return
+ */
+void alvs_db_service_key(struct ip_vs_service_user *ip_vs_service, struct alvs_db_service *cp_service)
+{
+	if (ip_vs_service->fwmark) {
+		cp_service->ip = ip_vs_service->fwmark;
+		cp_service->port = 0;
+		cp_service->protocol = ALVS_DB_FWMARK_PROTOCOL;
+	} else {
+		cp_service->ip = bswap_32(ip_vs_service->addr);
+		cp_service->port = bswap_16(ip_vs_service->port);
+		cp_service->protocol = ip_vs_service->protocol;
+	}
+}
+
+/**************************************************************************//**
+ * \brief       Checks if a firewall mark service is supported by application.
+ *              the mark should have classification entries and the full
+ *              connection entry is needed - compact entry rebuilds virtual
+ *              address and port from the service.
+ *
+ * \param[in]   fwmark   - firewall mark
+ *
+ * \return      true/false
+ */
+bool supported_fwmark(uint32_t fwmark)
+{
+#ifdef ALVS_CONN_COMPACT
+	return false;
+#else
+	uint32_t entry_count;
+
+	if (internal_db_get_fwmark_count(fwmark, &entry_count) != ALVS_DB_OK) {
+		return false;
+	}
+	return entry_count != 0;
+#endif
+}
+
+/**************************************************************************//**
+ * \brief       Checks if a wildcard port service (port 0) is supported by
+ *              application. compact connection keeps the service key, so
+ *              destination port of the connection can't be restored.
+ *
+ * \return      true/false
+ */
+bool supported_wildcard_port(void)
+{
+#ifdef ALVS_CONN_COMPACT
+	return false;
+#else
+	return true;
+#endif
+}
+
+/**************************************************************************//**
+ * \brief       Checks if a server of a firewall mark service or of a wildcard
+ *              port service is supported by application. NAT servers should
+ *              have a port - destination port of the frame is not kept.
+ *
+ * \param[in]   ip_vs_service   - service reference
+ * \param[in]   ip_vs_dest      - server reference
+ *
+ * \return      true/false
+ */
+bool supported_server_port(struct ip_vs_service_user *ip_vs_service, struct ip_vs_dest_user *ip_vs_dest)
+{
+	if ((ip_vs_service->fwmark || ip_vs_service->port == 0) && ip_vs_dest->port == 0 &&
+	    (ip_vs_dest->conn_flags & IP_VS_CONN_F_FWD_MASK) != IP_VS_CONN_F_DROUTE &&
+	    (ip_vs_dest->conn_flags & IP_VS_CONN_F_FWD_MASK) != IP_VS_CONN_F_TUNNEL) {
+		return false;
+	}
+	return true;
+}
+
 /**************************************************************************//**
  * \brief       Checks if a protocol is supported by application
  *
@@ -1690,7 +2583,7 @@ enum alvs_scheduler_type get_sched_alg(char *sched_name)
  */
 bool supported_protocol(uint16_t protocol)
 {
-	if (protocol == IPPROTO_TCP) {
+	if (protocol == IPPROTO_TCP || protocol == IPPROTO_UDP) {
 		return true;
 	}
 	return false;
@@ -1708,30 +2601,187 @@ bool supported_sched_alg(enum alvs_scheduler_type sched_alg)
 	if (sched_alg == ALVS_SOURCE_HASH_SCHEDULER) {
 		return true;
 	}
+	if (sched_alg == ALVS_DESTINATION_HASH_SCHEDULER) {
+		return true;
+	}
 	if (sched_alg == ALVS_ROUND_ROBIN_SCHEDULER) {
 		return true;
 	}
 	if (sched_alg == ALVS_WEIGHTED_ROUND_ROBIN_SCHEDULER) {
 		return true;
 	}
+	if (sched_alg == ALVS_LEAST_CONNECTION_SCHEDULER) {
+		return true;
+	}
+	if (sched_alg == ALVS_WEIGHTED_LEAST_CONNECTION_SCHEDULER) {
+		return true;
+	}
+	if (sched_alg == ALVS_SHORTEST_EXPECTED_DELAY_SCHEDULER) {
+		return true;
+	}
+	if (sched_alg == ALVS_NEVER_QUEUE_SCHEDULER) {
+		return true;
+	}
+	if (sched_alg == ALVS_LB_LEAST_CONNECTION_SCHEDULER) {
+		return true;
+	}
+	if (sched_alg == ALVS_LB_LEAST_CONNECTION_SCHEDULER_WITH_REPLICATION) {
+		return true;
+	}
+	if (sched_alg == ALVS_TWO_CHOICES_SCHEDULER) {
+		return true;
+	}
+	return false;
+}
+
+/**************************************************************************//**
+ * \brief       Checks if a scheduling algorithm is supported for a service
+ *              address. IPv6 services have no connection table - every frame
+ *              is hashed, so only SH and DH schedulers keep their semantics.
+ *
+ * \param[in]   ip_vs_service   - service reference
+ *
+ * \return      true/false
+ */
+bool supported_addr_sched_alg(struct ip_vs_service_user *ip_vs_service)
+{
+	enum alvs_scheduler_type sched_alg = get_sched_alg(ip_vs_service->sched_name);
+
+	if (ip_vs_service->fwmark || !ALVS_DB_IS_ADDR6_ALIAS(bswap_32(ip_vs_service->addr))) {
+		return true;
+	}
+	if (sched_alg == ALVS_SOURCE_HASH_SCHEDULER) {
+		return true;
+	}
+	if (sched_alg == ALVS_DESTINATION_HASH_SCHEDULER) {
+		return true;
+	}
 	return false;
 }
 
 /**************************************************************************//**
- * \brief       Checks if a routing algorithm is supported by application
+ * \brief       Checks if a routing algorithm is supported by application.
+ *              NAT, tunneling and full NAT are supported for IPv4 servers
+ *              only. NAT and full NAT need the full connection entry, which
+ *              keeps the server side key of the connection. full NAT needs a
+ *              configured local address as well.
  *
  * \param[in]   conn_flags   - received connection flags
+ * \param[in]   addr         - server address as received from CP
  *
  * \return      true/false
  */
-bool supported_routing_alg(uint32_t conn_flags)
+bool supported_routing_alg(uint32_t conn_flags, in_addr_t addr)
 {
 	if ((conn_flags & IP_VS_CONN_F_FWD_MASK) == IP_VS_CONN_F_DROUTE) {
 		return true;
 	}
+	if ((conn_flags & IP_VS_CONN_F_FWD_MASK) == IP_VS_CONN_F_TUNNEL &&
+	    !ALVS_DB_IS_ADDR6_ALIAS(bswap_32(addr))) {
+		return true;
+	}
+#ifndef ALVS_CONN_COMPACT
+	if ((conn_flags & IP_VS_CONN_F_FWD_MASK) == IP_VS_CONN_F_MASQ &&
+	    !ALVS_DB_IS_ADDR6_ALIAS(bswap_32(addr))) {
+		return true;
+	}
+	if ((conn_flags & IP_VS_CONN_F_FWD_MASK) == ALVS_CONN_F_FULLNAT &&
+	    fullnat_local_ip != 0 &&
+	    !ALVS_DB_IS_ADDR6_ALIAS(bswap_32(addr))) {
+		return true;
+	}
+#endif
 	return false;
 }
 
+/**************************************************************************//**
+ * \brief       Checks if a routing algorithm is supported on a service.
+ *              a one-packet service schedules every UDP datagram without a
+ *              connection entry, so no server to client entry (NAT and full
+ *              NAT) and no full NAT local port can be kept for it.
+ *
+ * \param[in]   service_flags   - service flags
+ * \param[in]   conn_flags      - server connection flags
+ *
+ * \return      true/false
+ */
+bool supported_service_routing_alg(uint32_t service_flags, uint32_t conn_flags)
+{
+	if ((service_flags & IP_VS_SVC_F_ONEPACKET) &&
+	    ((conn_flags & IP_VS_CONN_F_FWD_MASK) == IP_VS_CONN_F_MASQ ||
+	     (conn_flags & IP_VS_CONN_F_FWD_MASK) == ALVS_CONN_F_FULLNAT)) {
+		return false;
+	}
+	return true;
+}
+
+/**************************************************************************//**
+ * \brief       Checks if all active servers of a service are supported with
+ *              new service flags.
+ *
+ * \param[in]   cp_service      - service reference
+ * \param[in]   service_flags   - new service flags
+ * \param[out]  supported       - true if all servers are supported
+ *
+ * \return      ALVS_DB_OK - operation succeeded
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ */
+enum alvs_db_rc alvs_db_service_servers_supported(struct alvs_db_service *cp_service, uint32_t service_flags, bool *supported)
+{
+	struct alvs_server_node *server_list, *node;
+
+	*supported = true;
+	if (internal_db_get_server_list(cp_service, &server_list, EXCLUDE_INACTIVE) != ALVS_DB_OK) {
+		write_log(LOG_CRIT, "Can't retrieve server list - internal error.");
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+	if (server_list == NULL) {
+		return ALVS_DB_OK;
+	}
+
+	node = server_list;
+	do {
+		if (supported_service_routing_alg(service_flags, node->server.conn_flags) == false) {
+			*supported = false;
+			break;
+		}
+		node = node->next;
+	} while (node != server_list);
+
+	alvs_free_server_list(server_list);
+	return ALVS_DB_OK;
+}
+
+/**************************************************************************//**
+ * \brief       Checks if servers of a service can be changed. IPv6 services
+ *              (SH and DH only) keep no connection entries - a flow reaches
+ *              its server only by hash, so adding, deleting or reweighting a
+ *              server remaps flows of all clients. servers of an IPv6 service
+ *              can be changed only before it forwarded its first frame.
+ *
+ * \param[in]   cp_service   - service reference
+ * \param[out]  changeable   - true if servers can be changed
+ *
+ * \return      ALVS_DB_OK - operation succeeded
+ *              ALVS_DB_NPS_ERROR - failed to read service counters
+ */
+enum alvs_db_rc alvs_db_service_servers_changeable(struct alvs_db_service *cp_service, bool *changeable)
+{
+	struct alvs_db_service_stats service_stats;
+
+	*changeable = true;
+	if (ALVS_DB_IS_FWMARK(cp_service) || !ALVS_DB_IS_ADDR6_ALIAS(cp_service->ip)) {
+		return ALVS_DB_OK;
+	}
+
+	if (alvs_db_get_service_counters(cp_service->nps_index, &service_stats) != ALVS_DB_OK) {
+		return ALVS_DB_NPS_ERROR;
+	}
+	*changeable = (service_stats.in_packet == 0);
+
+	return ALVS_DB_OK;
+}
+
 /**************************************************************************//**
  * \brief       Build service info key for NPS table
  *
@@ -1745,6 +2795,12 @@ void build_nps_service_info_key(struct alvs_db_service *cp_service,
 	nps_service_info_key->service_index = cp_service->nps_index;
 }
 
+/* scheduling counter of the service on all cluster data */
+#define ALVS_DB_SERVICE_SCHED_CTR(nps_index) \
+	((EZDP_INTERNAL_MS << EZDP_SUM_ADDR_MEM_TYPE_OFFSET) | \
+	 (EZDP_ALL_CLUSTER_DATA << EZDP_SUM_ADDR_MSID_OFFSET) | \
+	 ((nps_index) << EZDP_SUM_ADDR_ELEMENT_INDEX_OFFSET))
+
 /**************************************************************************//**
  * \brief       Build service info result for NPS table
  *
@@ -1756,12 +2812,11 @@ void build_nps_service_info_result(struct alvs_db_service *cp_service,
 				   struct alvs_service_info_result *nps_service_info_result)
 {
 	nps_service_info_result->sched_alg = cp_service->sched_alg;
+	nps_service_info_result->persist_iterations = cp_service->persist_iterations;
 	nps_service_info_result->sched_entries_count = bswap_16(cp_service->sched_entries_count);
 	nps_service_info_result->service_flags = bswap_32(cp_service->flags);
 	nps_service_info_result->service_stats_base = bswap_32(cp_service->stats_base.raw_data);
-	nps_service_info_result->service_sched_ctr = bswap_32((EZDP_INTERNAL_MS << EZDP_SUM_ADDR_MEM_TYPE_OFFSET) |
-		(EZDP_ALL_CLUSTER_DATA << EZDP_SUM_ADDR_MSID_OFFSET) |
-		(cp_service->nps_index << EZDP_SUM_ADDR_ELEMENT_INDEX_OFFSET));
+	nps_service_info_result->service_sched_ctr = bswap_32(ALVS_DB_SERVICE_SCHED_CTR(cp_service->nps_index));
 }
 
 /**************************************************************************//**
@@ -1774,23 +2829,519 @@ void build_nps_service_info_result(struct alvs_db_service *cp_service,
 void build_nps_service_classification_key(struct alvs_db_service *cp_service,
 					  struct alvs_service_classification_key *nps_service_classification_key)
 {
-	nps_service_classification_key->service_address = bswap_32(cp_service->ip);
-	nps_service_classification_key->service_port = bswap_16(cp_service->port);
-	nps_service_classification_key->service_protocol = bswap_16(cp_service->protocol);
+	nps_service_classification_key->service_address = bswap_32(cp_service->ip);
+	nps_service_classification_key->service_port = bswap_16(cp_service->port);
+	nps_service_classification_key->service_protocol = bswap_16(cp_service->protocol);
+}
+
+/**************************************************************************//**
+ * \brief       Build service classification result for NPS table
+ *
+ * \param[in]   cp_service   - service received from CP.
+ *
+ * \return
+ */
+void build_nps_service_classification_result(struct alvs_db_service *cp_service,
+					     struct alvs_service_classification_result *nps_service_classification_result)
+{
+	nps_service_classification_result->service_index = cp_service->nps_index;
+#ifdef ALVS_SERVICE_INLINE_INFO
+	nps_service_classification_result->sched_alg = cp_service->sched_alg;
+	nps_service_classification_result->persist_iterations = cp_service->persist_iterations;
+	nps_service_classification_result->sched_entries_count = bswap_16(cp_service->sched_entries_count);
+	nps_service_classification_result->service_flags = bswap_32(cp_service->flags);
+	nps_service_classification_result->service_sched_ctr = bswap_32(ALVS_DB_SERVICE_SCHED_CTR(cp_service->nps_index));
+#endif
+}
+
+/**************************************************************************//**
+ * \brief       Write VIP filter entry of a bucket with new address counts.
+ *              NPS entry of the bucket is added with the first address, modified
+ *              when the roles of the bucket change and deleted with the last
+ *              address. called with vip_filter_lock taken.
+ *
+ * \param[in]   bucket_index       - VIP filter bucket
+ * \param[in]   vip_count          - new count of service addresses
+ * \param[in]   nat_server_count   - new count of NAT server addresses
+ *
+ * \return      true/false
+ */
+bool alvs_db_write_vip_filter_bucket(uint16_t bucket_index, uint16_t vip_count, uint16_t nat_server_count)
+{
+	struct alvs_vip_filter_key nps_vip_filter_key;
+	struct alvs_vip_filter_result nps_vip_filter_result;
+	bool existed = (vip_filter_refcnt[bucket_index] > 0 || nat_server_filter_refcnt[bucket_index] > 0);
+
+	if ((vip_filter_refcnt[bucket_index] > 0) == (vip_count > 0) &&
+	    (nat_server_filter_refcnt[bucket_index] > 0) == (nat_server_count > 0)) {
+		/* roles of the bucket did not change */
+		return true;
+	}
+
+	nps_vip_filter_key.bucket_index = bswap_16(bucket_index);
+	if (vip_count == 0 && nat_server_count == 0) {
+		return infra_delete_entry(STRUCT_ID_ALVS_VIP_FILTER,
+					  &nps_vip_filter_key,
+					  sizeof(struct alvs_vip_filter_key));
+	}
+
+	memset(&nps_vip_filter_result, 0, sizeof(nps_vip_filter_result));
+	nps_vip_filter_result.vip = (vip_count > 0);
+	nps_vip_filter_result.nat_server = (nat_server_count > 0);
+	if (existed) {
+		return infra_modify_entry(STRUCT_ID_ALVS_VIP_FILTER,
+					  &nps_vip_filter_key,
+					  sizeof(struct alvs_vip_filter_key),
+					  &nps_vip_filter_result,
+					  sizeof(struct alvs_vip_filter_result));
+	}
+	return infra_add_entry(STRUCT_ID_ALVS_VIP_FILTER,
+			       &nps_vip_filter_key,
+			       sizeof(struct alvs_vip_filter_key),
+			       &nps_vip_filter_result,
+			       sizeof(struct alvs_vip_filter_result));
+}
+
+/**************************************************************************//**
+ * \brief       Count a service classification address in its VIP filter
+ *              bucket. entry should be added before the classification entry
+ *              and deleted after it.
+ *
+ * \param[in]   ip    - service classification address (host order)
+ * \param[in]   add   - count address when true, uncount otherwise.
+ *
+ * \return      ALVS_DB_OK - succeed.
+ *              ALVS_DB_NPS_ERROR - failed to update NPS DB
+ */
+enum alvs_db_rc alvs_db_update_vip_filter(in_addr_t ip, bool add)
+{
+	uint16_t bucket_index = ALVS_VIP_FILTER_INDEX(ip);
+	uint16_t vip_count;
+	bool ret;
+
+	pthread_mutex_lock(&vip_filter_lock);
+	vip_count = vip_filter_refcnt[bucket_index];
+	if (add) {
+		vip_count++;
+	} else if (vip_count > 0) {
+		vip_count--;
+	}
+	ret = alvs_db_write_vip_filter_bucket(bucket_index, vip_count, nat_server_filter_refcnt[bucket_index]);
+	if (ret == true) {
+		vip_filter_refcnt[bucket_index] = vip_count;
+	}
+	pthread_mutex_unlock(&vip_filter_lock);
+
+	if (ret == false) {
+		write_log(LOG_CRIT, "Failed to %s VIP filter entry %d.", add ? "add" : "delete", bucket_index);
+		return ALVS_DB_NPS_ERROR;
+	}
+
+	return ALVS_DB_OK;
+}
+
+/**************************************************************************//**
+ * \brief       Checks if connections of a server are NAT or full NAT - replies
+ *              of the server are classified to their connection.
+ *
+ * \param[in]   conn_flags   - server connection flags
+ *
+ * \return      true/false
+ */
+bool alvs_db_is_nat_server(uint32_t conn_flags)
+{
+	return (conn_flags & IP_VS_CONN_F_FWD_MASK) == IP_VS_CONN_F_MASQ ||
+	       (conn_flags & IP_VS_CONN_F_FWD_MASK) == ALVS_CONN_F_FULLNAT;
+}
+
+/**************************************************************************//**
+ * \brief       Count a NAT or full NAT server address in its VIP filter
+ *              bucket. DP looks up NAT connections only for frames from these
+ *              addresses. server is counted when it becomes a NAT server and
+ *              uncounted when it is aged out, after its connections - a server
+ *              modified to another forwarding method stays counted, which only
+ *              costs NAT lookups.
+ *
+ * \param[in]   ip    - server address (host order)
+ * \param[in]   add   - count address when true, uncount otherwise.
+ *
+ * \return      ALVS_DB_OK - succeed.
+ *              ALVS_DB_NPS_ERROR - failed to update NPS DB
+ */
+enum alvs_db_rc alvs_db_update_nat_server_filter(in_addr_t ip, bool add)
+{
+	uint16_t bucket_index = ALVS_VIP_FILTER_INDEX(ip);
+	uint16_t nat_server_count;
+	bool ret;
+
+	pthread_mutex_lock(&vip_filter_lock);
+	nat_server_count = nat_server_filter_refcnt[bucket_index];
+	if (add) {
+		nat_server_count++;
+	} else if (nat_server_count > 0) {
+		nat_server_count--;
+	}
+	ret = alvs_db_write_vip_filter_bucket(bucket_index, vip_filter_refcnt[bucket_index], nat_server_count);
+	if (ret == true) {
+		nat_server_filter_refcnt[bucket_index] = nat_server_count;
+	}
+	pthread_mutex_unlock(&vip_filter_lock);
+
+	if (ret == false) {
+		write_log(LOG_CRIT, "Failed to %s NAT server filter entry %d.", add ? "add" : "delete", bucket_index);
+		return ALVS_DB_NPS_ERROR;
+	}
+
+	return ALVS_DB_OK;
+}
+
+/**************************************************************************//**
+ * \brief       Build server classification key for NPS table
+ *
+ * \param[in]   cp_service  - service received from CP.
+ * \param[in]   cp_server   - server received from CP.
+ * \param[out]  nps_server_classification_key   - server classification key.
+ *
+ * \return
+ */
+void build_nps_server_classification_key(struct alvs_db_service *cp_service,
+					 struct alvs_db_server *cp_server,
+					 struct alvs_server_classification_key *nps_server_classification_key)
+{
+	nps_server_classification_key->virtual_ip = bswap_32(cp_service->ip);
+	nps_server_classification_key->virtual_port = bswap_16(cp_service->port);
+	nps_server_classification_key->server_ip = bswap_32(cp_server->ip);
+	nps_server_classification_key->server_port = bswap_16(cp_server->port);
+	nps_server_classification_key->protocol = bswap_16(cp_service->protocol);
+}
+
+/**************************************************************************//**
+ * \brief       Build server classification result for NPS table
+ *
+ * \param[in]   cp_server   - server received from CP.
+ * \param[out]  nps_server_classification_result   - server classification key.
+ *
+ * \return
+ */
+void build_nps_server_classification_result(struct alvs_db_server *cp_server,
+					    struct alvs_server_classification_result *nps_server_classification_result)
+{
+	nps_server_classification_result->server_index = bswap_32(cp_server->nps_index);
+}
+
+/**************************************************************************//**
+ * \brief       Add or delete a server classification entry in NPS.
+ *
+ * \param[in]   cp_service  - address, port and protocol of the entry.
+ * \param[in]   cp_server   - server received from CP.
+ * \param[in]   op          - operation (modify is not used)
+ *
+ * \return      true/false
+ */
+bool alvs_db_write_server_classification(struct alvs_db_service *cp_service, struct alvs_db_server *cp_server,
+					 enum alvs_db_class_op op)
+{
+	struct alvs_server_classification_key nps_server_classification_key;
+	struct alvs_server_classification_result nps_server_classification_result;
+
+	build_nps_server_classification_key(cp_service,
+					    cp_server,
+					    &nps_server_classification_key);
+	switch (op) {
+	case ALVS_DB_CLASS_ADD:
+		build_nps_server_classification_result(cp_server,
+						       &nps_server_classification_result);
+		return infra_add_entry(STRUCT_ID_ALVS_SERVER_CLASSIFICATION,
+				       &nps_server_classification_key,
+				       sizeof(struct alvs_server_classification_key),
+				       &nps_server_classification_result,
+				       sizeof(struct alvs_server_classification_result));
+	case ALVS_DB_CLASS_DELETE:
+		return infra_delete_entry(STRUCT_ID_ALVS_SERVER_CLASSIFICATION,
+					  &nps_server_classification_key,
+					  sizeof(struct alvs_server_classification_key));
+	default:
+		/* Can't reach here */
+		return false;
+	}
+}
+
+/**************************************************************************//**
+ * \brief       Add, modify or delete a service classification entry in NPS.
+ *              VIP filter of IPv4 entries is updated with the entry - before
+ *              an added entry and after a deleted one.
+ *
+ * \param[in]   struct_id   - IPv4 or IPv6 service classification structure
+ * \param[in]   key         - entry key
+ * \param[in]   key_size    - entry key size
+ * \param[in]   ip          - IPv4 address of the entry (host order)
+ * \param[in]   result      - entry result (not used on delete)
+ * \param[in]   op          - operation
+ *
+ * \return      true/false
+ */
+bool alvs_db_write_service_classification(uint32_t struct_id, void *key, uint32_t key_size, in_addr_t ip,
+					  struct alvs_service_classification_result *result, enum alvs_db_class_op op)
+{
+	bool vip_filter = (struct_id == STRUCT_ID_ALVS_SERVICE_CLASSIFICATION);
+
+	switch (op) {
+	case ALVS_DB_CLASS_ADD:
+		if (vip_filter && alvs_db_update_vip_filter(ip, true) != ALVS_DB_OK) {
+			return false;
+		}
+		return infra_add_entry(struct_id, key, key_size, result,
+				       sizeof(struct alvs_service_classification_result));
+	case ALVS_DB_CLASS_MODIFY:
+		return infra_modify_entry(struct_id, key, key_size, result,
+					  sizeof(struct alvs_service_classification_result));
+	case ALVS_DB_CLASS_DELETE:
+		if (infra_delete_entry(struct_id, key, key_size) == false) {
+			return false;
+		}
+		return !vip_filter || alvs_db_update_vip_filter(ip, false) == ALVS_DB_OK;
+	default:
+		/* Can't reach here */
+		return false;
+	}
+}
+
+/**************************************************************************//**
+ * \brief       Expand a firewall mark service to the addresses, ports and
+ *              protocols loaded for its mark and update an NPS entry for each
+ *              one - service classification entries when no server is given,
+ *              otherwise classification entries of the server. DP looks both
+ *              up by the destination of the frame, which never holds the mark.
+ *
+ * \param[in]   cp_service   - firewall mark service received from CP.
+ * \param[in]   cp_server    - server of the service, NULL for service entries.
+ * \param[in]   op           - operation on the entries.
+ *
+ * \return      ALVS_DB_OK - succeed.
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ *              ALVS_DB_NPS_ERROR - failed to update NPS DB
+ */
+enum alvs_db_rc alvs_db_update_fwmark_classification(struct alvs_db_service *cp_service, struct alvs_db_server *cp_server,
+						     enum alvs_db_class_op op)
+{
+	int rc;
+	sqlite3_stmt *statement;
+	char sql[256];
+	struct alvs_db_service fwmark_entry;
+	struct alvs_db_server fwmark_server;
+	struct alvs_service_classification_key nps_service_classification_key;
+	struct alvs_service_classification_result nps_service_classification_result;
+	bool ret = true;
+
+	sprintf(sql, "SELECT ip, port, protocol FROM fwmarks "
+		"WHERE fwmark=%d;",
+		cp_service->ip);
+
+	/* Prepare SQL statement */
+	rc = sqlite3_prepare_v2(alvs_db, sql, -1, &statement, NULL);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	build_nps_service_classification_result(cp_service,
+						&nps_service_classification_result);
+
+	/* Execute SQL statement */
+	rc = sqlite3_step(statement);
+	while (rc == SQLITE_ROW && ret == true) {
+		fwmark_entry.ip = sqlite3_column_int(statement, 0);
+		fwmark_entry.port = sqlite3_column_int(statement, 1);
+		fwmark_entry.protocol = sqlite3_column_int(statement, 2);
+		if (cp_server == NULL) {
+			build_nps_service_classification_key(&fwmark_entry,
+							     &nps_service_classification_key);
+			ret = alvs_db_write_service_classification(STRUCT_ID_ALVS_SERVICE_CLASSIFICATION,
+								   &nps_service_classification_key,
+								   sizeof(struct alvs_service_classification_key),
+								   fwmark_entry.ip,
+								   &nps_service_classification_result,
+								   op);
+		} else {
+			/* server without a port gets the port of the frame */
+			fwmark_server = *cp_server;
+			if (fwmark_server.port == 0) {
+				fwmark_server.port = fwmark_entry.port;
+			}
+			ret = alvs_db_write_server_classification(&fwmark_entry, &fwmark_server, op);
+		}
+		rc = sqlite3_step(statement);
+	}
+	sqlite3_finalize(statement);
+
+	if (ret == false) {
+		write_log(LOG_CRIT, "Failed to %s firewall mark classification entry %s:%d.",
+			  alvs_db_class_op_name[op], my_inet_ntoa(fwmark_entry.ip), fwmark_entry.port);
+		return ALVS_DB_NPS_ERROR;
+	}
+	if (rc < SQLITE_ROW) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+
+	return ALVS_DB_OK;
+}
+
+/**************************************************************************//**
+ * \brief       Add, modify or delete service classification entry in NPS.
+ *              services with an IPv6 alias address are classified by the IPv6
+ *              service classification table.
+ *
+ * \param[in]   cp_service   - service received from CP.
+ * \param[in]   op           - operation on the entry.
+ *
+ * \return      ALVS_DB_OK - succeed.
+ *              ALVS_DB_INTERNAL_ERROR - failed to get IPv6 address of alias
+ *              ALVS_DB_NPS_ERROR - failed to update NPS DB
+ */
+enum alvs_db_rc alvs_db_update_service_classification(struct alvs_db_service *cp_service, enum alvs_db_class_op op)
+{
+	struct alvs_service_classification_key nps_service_classification_key;
+	struct alvs_service6_classification_key nps_service6_classification_key;
+	struct alvs_service_classification_result nps_service_classification_result;
+	uint32_t struct_id = STRUCT_ID_ALVS_SERVICE_CLASSIFICATION;
+	void *key = &nps_service_classification_key;
+	uint32_t key_size = sizeof(struct alvs_service_classification_key);
+
+	if (ALVS_DB_IS_FWMARK(cp_service)) {
+		return alvs_db_update_fwmark_classification(cp_service, NULL, op);
+	}
+
+	if (ALVS_DB_IS_ADDR6_ALIAS(cp_service->ip)) {
+		if (alvs_db_get_addr6_by_alias(cp_service->ip, &nps_service6_classification_key.service_address) != ALVS_DB_OK) {
+			write_log(LOG_CRIT, "Can't find IPv6 address of service alias %s.", my_inet_ntoa(cp_service->ip));
+			return ALVS_DB_INTERNAL_ERROR;
+		}
+		nps_service6_classification_key.service_port = bswap_16(cp_service->port);
+		nps_service6_classification_key.service_protocol = bswap_16(cp_service->protocol);
+		struct_id = STRUCT_ID_ALVS_SERVICE6_CLASSIFICATION;
+		key = &nps_service6_classification_key;
+		key_size = sizeof(struct alvs_service6_classification_key);
+	} else {
+		build_nps_service_classification_key(cp_service,
+						     &nps_service_classification_key);
+	}
+
+	build_nps_service_classification_result(cp_service,
+						&nps_service_classification_result);
+	if (alvs_db_write_service_classification(struct_id, key, key_size, cp_service->ip,
+						 &nps_service_classification_result, op) == false) {
+		write_log(LOG_CRIT, "Failed to %s service classification entry.", alvs_db_class_op_name[op]);
+		return ALVS_DB_NPS_ERROR;
+	}
+
+	return ALVS_DB_OK;
+}
+
+/**************************************************************************//**
+ * \brief       Add or delete classification entry of a server in NPS.
+ *              servers of a firewall mark service get an entry for every
+ *              address, port and protocol classified to the mark.
+ *
+ * \param[in]   cp_service   - service received from CP.
+ * \param[in]   cp_server    - server received from CP.
+ * \param[in]   op           - operation on the entry (add or delete).
+ *
+ * \return      ALVS_DB_OK - succeed.
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ *              ALVS_DB_NPS_ERROR - failed to update NPS DB
+ */
+enum alvs_db_rc alvs_db_update_server_classification(struct alvs_db_service *cp_service, struct alvs_db_server *cp_server,
+						     enum alvs_db_class_op op)
+{
+	if (ALVS_DB_IS_FWMARK(cp_service)) {
+		return alvs_db_update_fwmark_classification(cp_service, cp_server, op);
+	}
+
+	if (alvs_db_write_server_classification(cp_service, cp_server, op) == false) {
+		return ALVS_DB_NPS_ERROR;
+	}
+
+	return ALVS_DB_OK;
+}
+
+/**************************************************************************//**
+ * \brief       Modify service info entry of a service in NPS. with inline
+ *              service info the scheduling fields are kept in the service
+ *              classification entries as well, and they are modified too.
+ *
+ * \param[in]   cp_service   - service received from CP.
+ *
+ * \return      ALVS_DB_OK - succeed.
+ *              ALVS_DB_INTERNAL_ERROR - failed to communicate with DB
+ *              ALVS_DB_NPS_ERROR - failed to update NPS DB
+ */
+enum alvs_db_rc alvs_db_modify_service_info(struct alvs_db_service *cp_service)
+{
+	struct alvs_service_info_key nps_service_info_key;
+	struct alvs_service_info_result nps_service_info_result;
+
+	build_nps_service_info_key(cp_service, &nps_service_info_key);
+	build_nps_service_info_result(cp_service, &nps_service_info_result);
+	if (infra_modify_entry(STRUCT_ID_ALVS_SERVICE_INFO, &nps_service_info_key,
+			       sizeof(struct alvs_service_info_key), &nps_service_info_result,
+			       sizeof(struct alvs_service_info_result)) == false) {
+		write_log(LOG_CRIT, "Failed to modify service info entry in NPS.");
+		return ALVS_DB_NPS_ERROR;
+	}
+
+#ifdef ALVS_SERVICE_INLINE_INFO
+	return alvs_db_update_service_classification(cp_service, ALVS_DB_CLASS_MODIFY);
+#else
+	return ALVS_DB_OK;
+#endif
 }
 
+#ifdef ALVS_CONN_COMPACT
 /**************************************************************************//**
- * \brief       Build service classification result for NPS table
+ * \brief       Write service address, port and protocol to the service key
+ *              array. DP uses it to rebuild the classification key of compact
+ *              connection entries. entry is not cleared on service delete -
+ *              connections of a deleted service still need it for aging, and
+ *              the index is quarantined until they are aged out.
  *
  * \param[in]   cp_service   - service received from CP.
  *
- * \return
+ * \return      ALVS_DB_OK - succeed.
+ *              ALVS_DB_NPS_ERROR - failed to write memory
  */
-void build_nps_service_classification_result(struct alvs_db_service *cp_service,
-					     struct alvs_service_classification_result *nps_service_classification_result)
+enum alvs_db_rc alvs_db_write_service_key(struct alvs_db_service *cp_service)
 {
-	nps_service_classification_result->service_index = cp_service->nps_index;
+	struct alvs_service_classification_key nps_service_key;
+	EZstatus ret_val;
+
+	build_nps_service_classification_key(cp_service, &nps_service_key);
+
+	ret_val = EZapiPrm_WriteMem(0, /*uiChannelId*/
+				    EZapiPrm_MemId_EXT_MEM, /*eMemId*/
+				    infra_from_msid_to_index(1, EMEM_SERVICE_KEY_MSID),
+				    EMEM_SERVICE_KEY_OFFSET_CP + cp_service->nps_index * sizeof(nps_service_key),
+				    0, /* uiMSBAddress */
+				    0, /* bRange */
+				    0, /* uiRangeSize */
+				    0, /* uiRangeStep */
+				    0, /* bSingleCopy */
+				    0, /* bGCICopy */
+				    0, /* uiCopyIndex */
+				    sizeof(nps_service_key),
+				    (EZuc8 *)&nps_service_key,   /*pucData*/
+				    0                /* pSpecialParams */);
+
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "alvs_db_write_service_key: EZapiPrm_WriteMem failed.");
+		return ALVS_DB_NPS_ERROR;
+	}
+
+	return ALVS_DB_OK;
 }
+#endif
 
 /**************************************************************************//**
  * \brief       Build server info key for NPS table
@@ -1830,37 +3381,41 @@ void build_nps_server_info_result(struct alvs_db_server *cp_server,
 }
 
 /**************************************************************************//**
- * \brief       Build server classification key for NPS table
+ * \brief       Write server6 info entry of a server with an IPv6 alias
+ *              address. entry holds the IPv6 address of the server and is
+ *              keyed by the server index.
  *
- * \param[in]   cp_service  - service received from CP.
  * \param[in]   cp_server   - server received from CP.
- * \param[out]  nps_server_classification_key   - server classification key.
  *
- * \return
+ * \return      ALVS_DB_OK - succeed (or server is not IPv6).
+ *              ALVS_DB_INTERNAL_ERROR - failed to get IPv6 address of alias
+ *              ALVS_DB_NPS_ERROR - failed to update NPS DB
  */
-void build_nps_server_classification_key(struct alvs_db_service *cp_service,
-					 struct alvs_db_server *cp_server,
-					 struct alvs_server_classification_key *nps_server_classification_key)
+enum alvs_db_rc alvs_db_write_server6_info(struct alvs_db_server *cp_server)
 {
-	nps_server_classification_key->virtual_ip = bswap_32(cp_service->ip);
-	nps_server_classification_key->virtual_port = bswap_16(cp_service->port);
-	nps_server_classification_key->server_ip = bswap_32(cp_server->ip);
-	nps_server_classification_key->server_port = bswap_16(cp_server->port);
-	nps_server_classification_key->protocol = bswap_16(cp_service->protocol);
-}
+	struct alvs_server_info_key nps_server_info_key;
+	struct alvs_server6_info_result nps_server6_info_result;
 
-/**************************************************************************//**
- * \brief       Build server classification result for NPS table
- *
- * \param[in]   cp_server   - server received from CP.
- * \param[out]  nps_server_classification_result   - server classification key.
- *
- * \return
- */
-void build_nps_server_classification_result(struct alvs_db_server *cp_server,
-					    struct alvs_server_classification_result *nps_server_classification_result)
-{
-	nps_server_classification_result->server_index = bswap_32(cp_server->nps_index);
+	if (!ALVS_DB_IS_ADDR6_ALIAS(cp_server->ip)) {
+		return ALVS_DB_OK;
+	}
+
+	memset(&nps_server6_info_result, 0, sizeof(nps_server6_info_result));
+	if (alvs_db_get_addr6_by_alias(cp_server->ip, &nps_server6_info_result.server_ip) != ALVS_DB_OK) {
+		write_log(LOG_CRIT, "Can't find IPv6 address of server alias %s.", my_inet_ntoa(cp_server->ip));
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+	build_nps_server_info_key(cp_server, &nps_server_info_key);
+	if (infra_modify_entry(STRUCT_ID_ALVS_SERVER6_INFO,
+			       &nps_server_info_key,
+			       sizeof(struct alvs_server_info_key),
+			       &nps_server6_info_result,
+			       sizeof(struct alvs_server6_info_result)) == false) {
+		write_log(LOG_CRIT, "Failed to add server6 info entry.");
+		return ALVS_DB_NPS_ERROR;
+	}
+
+	return ALVS_DB_OK;
 }
 
 /**************************************************************************//**
@@ -1878,6 +3433,8 @@ void build_nps_application_info_result(struct alvs_db_application_info *cp_daemo
 	nps_application_info_result->alvs_app.m_sync_id = cp_daemon_info->m_sync_id;
 	nps_application_info_result->alvs_app.b_sync_id = cp_daemon_info->b_sync_id;
 	nps_application_info_result->alvs_app.source_ip = bswap_32(cp_daemon_info->source_ip);
+	nps_application_info_result->alvs_app.tunnel_source_ip = bswap_32(tunnel_source_ip);
+	nps_application_info_result->alvs_app.tunnel_mtu = bswap_16(tunnel_mtu);
 }
 
 /**************************************************************************//**
@@ -1964,14 +3521,13 @@ void build_cp_state_sync_daemons(struct alvs_db_application_info *cp_daemon_info
  */
 enum alvs_db_rc alvs_db_add_service(struct ip_vs_service_user *ip_vs_service)
 {
+	uint32_t fwmark;
 	struct alvs_db_service cp_service;
 	struct alvs_service_info_key nps_service_info_key;
 	struct alvs_service_info_result nps_service_info_result;
-	struct alvs_service_classification_key nps_service_classification_key;
-	struct alvs_service_classification_result nps_service_classification_result;
 
 	/* Check is request is supported */
-	if (supported_protocol(ip_vs_service->protocol) == false) {
+	if (!ip_vs_service->fwmark && supported_protocol(ip_vs_service->protocol) == false) {
 		write_log(LOG_NOTICE, "Protocol (%d) is not supported.", ip_vs_service->protocol);
 		return ALVS_DB_NOT_SUPPORTED;
 	}
@@ -1979,14 +3535,34 @@ enum alvs_db_rc alvs_db_add_service(struct ip_vs_service_user *ip_vs_service)
 		write_log(LOG_NOTICE, "Scheduling algorithm (%s) is not supported.", ip_vs_service->sched_name);
 		return ALVS_DB_NOT_SUPPORTED;
 	}
+	if (supported_addr_sched_alg(ip_vs_service) == false) {
+		write_log(LOG_NOTICE, "Scheduling algorithm (%s) is not supported for IPv6 service.", ip_vs_service->sched_name);
+		return ALVS_DB_NOT_SUPPORTED;
+	}
+	if (supported_persistence(ip_vs_service) == false) {
+		write_log(LOG_NOTICE, "Persistence netmask (0x%08x) is not supported.", ip_vs_service->netmask);
+		return ALVS_DB_NOT_SUPPORTED;
+	}
+
+	if (ip_vs_service->fwmark && supported_fwmark(ip_vs_service->fwmark) == false) {
+		write_log(LOG_NOTICE, "Firewall mark (%d) service is not supported.", ip_vs_service->fwmark);
+		return ALVS_DB_NOT_SUPPORTED;
+	}
+	if (!ip_vs_service->fwmark && ip_vs_service->port == 0 && supported_wildcard_port() == false) {
+		write_log(LOG_NOTICE, "Wildcard port service is not supported.");
+		return ALVS_DB_NOT_SUPPORTED;
+	}
 
 	/* init the cp_service internal entry */
 	memset(&cp_service, 0, sizeof(cp_service));
 
 	/* Check if service already exists in internal DB */
-	cp_service.ip = bswap_32(ip_vs_service->addr);
-	cp_service.port = bswap_16(ip_vs_service->port);
-	cp_service.protocol = ip_vs_service->protocol;
+	alvs_db_service_key(ip_vs_service, &cp_service);
+	if (!ip_vs_service->fwmark && internal_db_get_fwmark(&cp_service, &fwmark) != ALVS_DB_FAILURE) {
+		write_log(LOG_NOTICE, "Service (%s:%d, protocol=%d) is classified by firewall mark.",
+			  my_inet_ntoa(cp_service.ip), cp_service.port, cp_service.protocol);
+		return ALVS_DB_NOT_SUPPORTED;
+	}
 	switch (internal_db_get_service(&cp_service, false)) {
 	case ALVS_DB_OK:
 		/* Service already exists */
@@ -2008,18 +3584,36 @@ enum alvs_db_rc alvs_db_add_service(struct ip_vs_service_user *ip_vs_service)
 	}
 
 	/* Service doesn't exist
-	 * Allocate an index for the new service
+	 * Take back the index of the service if it was deleted while its
+	 * connections still live, otherwise allocate an index for the new service
 	 */
-	if (index_pool_alloc(&service_index_pool, &cp_service.nps_index) == false) {
-		write_log(LOG_ERR, "Can't add service. Reached maximum.");
-		return ALVS_DB_NOT_SUPPORTED;
+	switch (internal_db_reclaim_service_index(&cp_service)) {
+	case ALVS_DB_OK:
+		break;
+	case ALVS_DB_FAILURE:
+		if (index_pool_alloc(&service_index_pool, &cp_service.nps_index) == false) {
+			write_log(LOG_ERR, "Can't add service. Reached maximum.");
+			return ALVS_DB_NOT_SUPPORTED;
+		}
+		break;
+	default:
+		write_log(LOG_ERR, "Can't reclaim service index (internal error).");
+		return ALVS_DB_INTERNAL_ERROR;
 	}
 	write_log(LOG_DEBUG, "Allocated nps_index = %d", cp_service.nps_index);
 
 	/* Fill information of the service */
 	cp_service.sched_alg = get_sched_alg(ip_vs_service->sched_name);
 	cp_service.flags = ip_vs_service->flags;
+	if (!(cp_service.flags & ALVS_SVC_F_NON_SYN_MASK)) {
+		/* no policy given for service - use daemon default */
+		cp_service.flags |= non_syn_miss_flags;
+	}
 	cp_service.sched_entries_count = 0;
+	if ((cp_service.flags & IP_VS_SVC_F_PERSISTENT) &&
+	    (ALVS_DB_IS_FWMARK(&cp_service) || !ALVS_DB_IS_ADDR6_ALIAS(cp_service.ip))) {
+		cp_service.persist_iterations = get_persist_iterations(ip_vs_service->timeout);
+	}
 	cp_service.stats_base.raw_data = (EZDP_EXTERNAL_MS << EZDP_SUM_ADDR_MEM_TYPE_OFFSET) |
 		(EMEM_SERVICE_STATS_POSTED_MSID << EZDP_SUM_ADDR_MSID_OFFSET) |
 		((EMEM_SERVICE_STATS_POSTED_OFFSET + cp_service.nps_index * ALVS_NUM_OF_SERVICE_STATS) << EZDP_SUM_ADDR_ELEMENT_INDEX_OFFSET);
@@ -2031,14 +3625,14 @@ enum alvs_db_rc alvs_db_add_service(struct ip_vs_service_user *ip_vs_service)
 	write_log(LOG_DEBUG, "Cleaning service statistics.");
 	if (alvs_db_clean_service_stats(cp_service.nps_index) == ALVS_DB_INTERNAL_ERROR) {
 		write_log(LOG_CRIT, "Failed to clean statistics.");
-		index_pool_release(&service_index_pool, cp_service.nps_index);
+		internal_db_quarantine_service_index(&cp_service);
 		return ALVS_DB_INTERNAL_ERROR;
 	}
 
 	/* Add service info to internal DB */
 	if (internal_db_add_service(&cp_service) == ALVS_DB_INTERNAL_ERROR) {
 		write_log(LOG_CRIT, "Failed to add service to internal DB.");
-		index_pool_release(&service_index_pool, cp_service.nps_index);
+		internal_db_quarantine_service_index(&cp_service);
 		return ALVS_DB_INTERNAL_ERROR;
 	}
 
@@ -2052,25 +3646,25 @@ enum alvs_db_rc alvs_db_add_service(struct ip_vs_service_user *ip_vs_service)
 			    &nps_service_info_result,
 			    sizeof(struct alvs_service_info_result)) == false) {
 		write_log(LOG_CRIT, "Failed to add service info entry to NPS.");
-		index_pool_release(&service_index_pool, cp_service.nps_index);
+		internal_db_quarantine_service_index(&cp_service);
 		return ALVS_DB_NPS_ERROR;
 	}
 
 	/* Add service classification to NPS search structure */
-	build_nps_service_classification_key(&cp_service,
-					     &nps_service_classification_key);
-	build_nps_service_classification_result(&cp_service,
-						&nps_service_classification_result);
-	if (infra_add_entry(STRUCT_ID_ALVS_SERVICE_CLASSIFICATION,
-			    &nps_service_classification_key,
-			    sizeof(struct alvs_service_classification_key),
-			    &nps_service_classification_result,
-			    sizeof(struct alvs_service_classification_result)) == false) {
+	if (alvs_db_update_service_classification(&cp_service, ALVS_DB_CLASS_ADD) != ALVS_DB_OK) {
 		write_log(LOG_CRIT, "Failed to add service classification entry to NPS.");
-		index_pool_release(&service_index_pool, cp_service.nps_index);
+		internal_db_quarantine_service_index(&cp_service);
 		return ALVS_DB_NPS_ERROR;
 	}
 
+#ifdef ALVS_CONN_COMPACT
+	/* Write service key used by compact connection entries */
+	if (alvs_db_write_service_key(&cp_service) != ALVS_DB_OK) {
+		write_log(LOG_CRIT, "Failed to write service key to NPS.");
+		return ALVS_DB_NPS_ERROR;
+	}
+#endif
+
 	write_log(LOG_INFO, "Service (%s:%d, protocol=%d) added successfully.",
 		  my_inet_ntoa(cp_service.ip), cp_service.port, cp_service.protocol);
 	return ALVS_DB_OK;
@@ -2090,20 +3684,26 @@ enum alvs_db_rc alvs_db_add_service(struct ip_vs_service_user *ip_vs_service)
 enum alvs_db_rc alvs_db_modify_service(struct ip_vs_service_user *ip_vs_service)
 {
 	struct alvs_db_service cp_service;
-	struct alvs_service_info_key nps_service_info_key;
-	struct alvs_service_info_result nps_service_info_result;
+	enum alvs_db_rc rc;
 	enum alvs_scheduler_type   prev_sched_alg;
+	bool servers_supported;
 
 	/* Check if request is supported */
 	if (supported_sched_alg(get_sched_alg(ip_vs_service->sched_name)) == false) {
 		write_log(LOG_NOTICE, "Scheduling algorithm (%s) is not supported.", ip_vs_service->sched_name);
 		return ALVS_DB_NOT_SUPPORTED;
 	}
+	if (supported_addr_sched_alg(ip_vs_service) == false) {
+		write_log(LOG_NOTICE, "Scheduling algorithm (%s) is not supported for IPv6 service.", ip_vs_service->sched_name);
+		return ALVS_DB_NOT_SUPPORTED;
+	}
+	if (supported_persistence(ip_vs_service) == false) {
+		write_log(LOG_NOTICE, "Persistence netmask (0x%08x) is not supported.", ip_vs_service->netmask);
+		return ALVS_DB_NOT_SUPPORTED;
+	}
 
 	/* Check if service exists in internal DB */
-	cp_service.ip = bswap_32(ip_vs_service->addr);
-	cp_service.port = bswap_16(ip_vs_service->port);
-	cp_service.protocol = ip_vs_service->protocol;
+	alvs_db_service_key(ip_vs_service, &cp_service);
 	switch (internal_db_get_service(&cp_service, true)) {
 	case ALVS_DB_FAILURE:
 		/* Service doesn't exist */
@@ -2124,18 +3724,36 @@ enum alvs_db_rc alvs_db_modify_service(struct ip_vs_service_user *ip_vs_service)
 		return ALVS_DB_INTERNAL_ERROR;
 	}
 
+	/* servers of the service must stay supported with the new flags */
+	if (alvs_db_service_servers_supported(&cp_service, ip_vs_service->flags, &servers_supported) != ALVS_DB_OK) {
+		return ALVS_DB_INTERNAL_ERROR;
+	}
+	if (servers_supported == false) {
+		write_log(LOG_NOTICE, "One-packet scheduling is not supported on service with NAT or full NAT servers.");
+		return ALVS_DB_NOT_SUPPORTED;
+	}
+
 	/* Modify information of the service */
 	prev_sched_alg = cp_service.sched_alg;
 	cp_service.sched_alg = get_sched_alg(ip_vs_service->sched_name);
-	cp_service.flags = ip_vs_service->flags;
+	if (ip_vs_service->flags & ALVS_SVC_F_NON_SYN_MASK) {
+		cp_service.flags = ip_vs_service->flags;
+	} else {
+		/* no policy given for service - keep policy of the service */
+		cp_service.flags = ip_vs_service->flags | (cp_service.flags & ALVS_SVC_F_NON_SYN_MASK);
+	}
+	cp_service.persist_iterations = 0;
+	if ((cp_service.flags & IP_VS_SVC_F_PERSISTENT) &&
+	    (ALVS_DB_IS_FWMARK(&cp_service) || !ALVS_DB_IS_ADDR6_ALIAS(cp_service.ip))) {
+		cp_service.persist_iterations = get_persist_iterations(ip_vs_service->timeout);
+	}
 
 	write_log(LOG_DEBUG, "Service info: alg=%d, flags=%d",
 		  cp_service.sched_alg, cp_service.flags);
 
 	if (prev_sched_alg != cp_service.sched_alg) {
 		/* Recalculate scheduling information */
-		enum alvs_db_rc rc = alvs_db_recalculate_scheduling_info(&cp_service);
-
+		rc = alvs_db_recalculate_scheduling_info(&cp_service);
 		if (rc != ALVS_DB_OK) {
 			write_log(LOG_CRIT, "Failed to recalculate scheduling information.");
 			return rc;
@@ -2149,13 +3767,10 @@ enum alvs_db_rc alvs_db_modify_service(struct ip_vs_service_user *ip_vs_service)
 	}
 
 	/* Modify service information in NPS search structure */
-	build_nps_service_info_key(&cp_service, &nps_service_info_key);
-	build_nps_service_info_result(&cp_service, &nps_service_info_result);
-	if (infra_modify_entry(STRUCT_ID_ALVS_SERVICE_INFO, &nps_service_info_key,
-			       sizeof(struct alvs_service_info_key), &nps_service_info_result,
-			       sizeof(struct alvs_service_info_result)) == false) {
+	rc = alvs_db_modify_service_info(&cp_service);
+	if (rc != ALVS_DB_OK) {
 		write_log(LOG_CRIT, "Failed to modify service info entry in NPS.");
-		return ALVS_DB_NPS_ERROR;
+		return rc;
 	}
 
 	write_log(LOG_INFO, "Service (%s:%d, protocol=%d) modified successfully.",
@@ -2179,15 +3794,12 @@ enum alvs_db_rc alvs_db_delete_service(struct ip_vs_service_user *ip_vs_service)
 	uint32_t server_count;
 	struct alvs_db_service cp_service;
 	struct alvs_service_info_key nps_service_info_key;
-	struct alvs_service_classification_key nps_service_classification_key;
 	struct alvs_server_info_key nps_server_info_key;
 	struct alvs_server_info_result nps_server_info_result;
 	struct alvs_server_node *server_list;
 
 	/* Check if service exists in internal DB */
-	cp_service.ip = bswap_32(ip_vs_service->addr);
-	cp_service.port = bswap_16(ip_vs_service->port);
-	cp_service.protocol = ip_vs_service->protocol;
+	alvs_db_service_key(ip_vs_service, &cp_service);
 	switch (internal_db_get_service(&cp_service, true)) {
 	case ALVS_DB_FAILURE:
 		/* Service doesn't exist */
@@ -2226,16 +3838,15 @@ enum alvs_db_rc alvs_db_delete_service(struct ip_vs_service_user *ip_vs_service)
 		return ALVS_DB_INTERNAL_ERROR;
 	}
 
-	/* Release service index */
-	write_log(LOG_DEBUG, "Releasing nps_index %d.", cp_service.nps_index);
-	index_pool_release(&service_index_pool, cp_service.nps_index);
+	/* Quarantine service index until connections of the service are aged */
+	write_log(LOG_DEBUG, "Quarantining nps_index %d.", cp_service.nps_index);
+	if (internal_db_quarantine_service_index(&cp_service) == ALVS_DB_INTERNAL_ERROR) {
+		write_log(LOG_CRIT, "Failed to quarantine service index.");
+		return ALVS_DB_INTERNAL_ERROR;
+	}
 
 	/* Delete service classification to NPS search structure */
-	build_nps_service_classification_key(&cp_service,
-					     &nps_service_classification_key);
-	if (infra_delete_entry(STRUCT_ID_ALVS_SERVICE_CLASSIFICATION,
-			       &nps_service_classification_key,
-			       sizeof(struct alvs_service_classification_key)) == false) {
+	if (alvs_db_update_service_classification(&cp_service, ALVS_DB_CLASS_DELETE) != ALVS_DB_OK) {
 		write_log(LOG_CRIT, "Failed to delete service classification entry.");
 		return ALVS_DB_NPS_ERROR;
 	}
@@ -2297,9 +3908,7 @@ enum alvs_db_rc alvs_db_get_service_flags(struct ip_vs_service_user *ip_vs_servi
 	struct alvs_db_service cp_service;
 
 	/* Check if service exists in internal DB */
-	cp_service.ip = bswap_32(ip_vs_service->addr);
-	cp_service.port = bswap_16(ip_vs_service->port);
-	cp_service.protocol = ip_vs_service->protocol;
+	alvs_db_service_key(ip_vs_service, &cp_service);
 	switch (internal_db_get_service(&cp_service, true)) {
 	case ALVS_DB_FAILURE:
 		/* Service doesn't exist */
@@ -2348,16 +3957,17 @@ enum alvs_db_rc alvs_db_add_server(struct ip_vs_service_user *ip_vs_service,
 	struct alvs_db_server cp_server;
 	struct alvs_server_info_key nps_server_info_key;
 	struct alvs_server_info_result nps_server_info_result;
-	struct alvs_service_info_key nps_service_info_key;
-	struct alvs_service_info_result nps_service_info_result;
-	struct alvs_server_classification_key nps_server_classification_key;
-	struct alvs_server_classification_result nps_server_classification_result;
+	bool servers_changeable;
 
 	/* Check if request is supported */
-	if (supported_routing_alg(ip_vs_dest->conn_flags) == false) {
+	if (supported_routing_alg(ip_vs_dest->conn_flags, ip_vs_dest->addr) == false) {
 		write_log(LOG_NOTICE, "Routing algorithm (%d) is not supported.", ip_vs_dest->conn_flags & IP_VS_CONN_F_FWD_MASK);
 		return ALVS_DB_NOT_SUPPORTED;
 	}
+	if (supported_server_port(ip_vs_service, ip_vs_dest) == false) {
+		write_log(LOG_NOTICE, "NAT server of firewall mark or wildcard port service should have a port.");
+		return ALVS_DB_NOT_SUPPORTED;
+	}
 
 	if (ip_vs_dest->l_threshold > ip_vs_dest->u_threshold) {
 		write_log(LOG_ERR, "l_threshold %d > u_threshold %d", ip_vs_dest->l_threshold, ip_vs_dest->u_threshold);
@@ -2368,9 +3978,7 @@ enum alvs_db_rc alvs_db_add_server(struct ip_vs_service_user *ip_vs_service,
 	memset(&cp_server, 0, sizeof(cp_server));
 
 	/* Check if service already exists in internal DB */
-	cp_service.ip = bswap_32(ip_vs_service->addr);
-	cp_service.port = bswap_16(ip_vs_service->port);
-	cp_service.protocol = ip_vs_service->protocol;
+	alvs_db_service_key(ip_vs_service, &cp_service);
 	switch (internal_db_get_service(&cp_service, true)) {
 	case ALVS_DB_FAILURE:
 		/* Service doesn't exist */
@@ -2391,6 +3999,19 @@ enum alvs_db_rc alvs_db_add_server(struct ip_vs_service_user *ip_vs_service,
 		return ALVS_DB_INTERNAL_ERROR;
 	}
 
+	if (supported_service_routing_alg(cp_service.flags, ip_vs_dest->conn_flags) == false) {
+		write_log(LOG_NOTICE, "NAT and full NAT servers are not supported on one-packet scheduling service.");
+		return ALVS_DB_NOT_SUPPORTED;
+	}
+
+	if (alvs_db_service_servers_changeable(&cp_service, &servers_changeable) != ALVS_DB_OK) {
+		return ALVS_DB_NPS_ERROR;
+	}
+	if (servers_changeable == false) {
+		write_log(LOG_NOTICE, "Servers of live IPv6 service can't be changed - flows would be remapped. Delete and add the service instead.");
+		return ALVS_DB_NOT_SUPPORTED;
+	}
+
 	/* check if service has maximum servers already */
 	internal_db_get_server_count(&cp_service, &server_count, EXCLUDE_INACTIVE);
 	if (server_count == ALVS_SIZE_OF_SCHED_BUCKET) {
@@ -2415,6 +4036,13 @@ enum alvs_db_rc alvs_db_add_server(struct ip_vs_service_user *ip_vs_service,
 		 */
 		write_log(LOG_DEBUG, "Server (%s:%d) exists (inactive).",
 			  my_inet_ntoa(cp_server.ip), cp_server.port);
+		/* Replies of a NAT server are classified to their connection */
+		if (!alvs_db_is_nat_server(cp_server.conn_flags) && alvs_db_is_nat_server(ip_vs_dest->conn_flags)) {
+			rc = alvs_db_update_nat_server_filter(cp_server.ip, true);
+			if (rc != ALVS_DB_OK) {
+				return rc;
+			}
+		}
 		cp_server.server_flags |= IP_VS_DEST_F_AVAILABLE;
 		cp_server.conn_flags = ip_vs_dest->conn_flags;
 		cp_server.weight = ip_vs_dest->weight;
@@ -2497,6 +4125,20 @@ enum alvs_db_rc alvs_db_add_server(struct ip_vs_service_user *ip_vs_service,
 			return ALVS_DB_INTERNAL_ERROR;
 		}
 
+		/* Replies of a NAT server are classified to their connection */
+		if (alvs_db_is_nat_server(cp_server.conn_flags)) {
+			rc = alvs_db_update_nat_server_filter(cp_server.ip, true);
+			if (rc != ALVS_DB_OK) {
+				return rc;
+			}
+		}
+
+		rc = alvs_db_write_server6_info(&cp_server);
+		if (rc != ALVS_DB_OK) {
+			index_pool_release(&server_index_pool, cp_server.nps_index);
+			return rc;
+		}
+
 		build_nps_server_info_key(&cp_server,
 					  &nps_server_info_key);
 		build_nps_server_info_result(&cp_server,
@@ -2530,31 +4172,22 @@ enum alvs_db_rc alvs_db_add_server(struct ip_vs_service_user *ip_vs_service,
 			return ALVS_DB_INTERNAL_ERROR;
 		}
 
-		build_nps_service_info_key(&cp_service,
-					   &nps_service_info_key);
-		build_nps_service_info_result(&cp_service,
-					      &nps_service_info_result);
-		if (infra_modify_entry(STRUCT_ID_ALVS_SERVICE_INFO,
-				       &nps_service_info_key,
-				       sizeof(struct alvs_service_info_key),
-				       &nps_service_info_result,
-				       sizeof(struct alvs_service_info_result)) == false) {
+		rc = alvs_db_modify_service_info(&cp_service);
+		if (rc != ALVS_DB_OK) {
 			write_log(LOG_CRIT, "Failed to change server count in service info entry.");
-			return ALVS_DB_NPS_ERROR;
+			return rc;
 		}
 	}
 
-	build_nps_server_classification_key(&cp_service,
-					    &cp_server,
-					    &nps_server_classification_key);
-	build_nps_server_classification_result(&cp_server,
-					       &nps_server_classification_result);
-	if (infra_add_entry(STRUCT_ID_ALVS_SERVER_CLASSIFICATION,
-			    &nps_server_classification_key,
-			    sizeof(struct alvs_server_classification_key),
-			    &nps_server_classification_result,
-			    sizeof(struct alvs_server_classification_result)) == false) {
+	rc = alvs_db_update_server_classification(&cp_service, &cp_server, ALVS_DB_CLASS_ADD);
+	if (rc != ALVS_DB_OK) {
 		write_log(LOG_CRIT, "Failed to add server classification entry.");
+		return rc;
+	}
+
+	/* Let unbound connections retry to bind */
+	if (alvs_db_bump_server_config_gen() != ALVS_DB_OK) {
+		write_log(LOG_CRIT, "Failed to bump server config generation.");
 		return ALVS_DB_NPS_ERROR;
 	}
 
@@ -2583,24 +4216,25 @@ enum alvs_db_rc alvs_db_modify_server(struct ip_vs_service_user *ip_vs_service,
 	struct alvs_db_server cp_server;
 	struct alvs_server_info_key nps_server_info_key;
 	struct alvs_server_info_result nps_server_info_result;
-	struct alvs_service_info_key nps_service_info_key;
-	struct alvs_service_info_result nps_service_info_result;
+	bool servers_changeable;
 	uint8_t prev_weight;
 
 	/* Check is request is supported */
-	if (supported_routing_alg(ip_vs_dest->conn_flags) == false) {
+	if (supported_routing_alg(ip_vs_dest->conn_flags, ip_vs_dest->addr) == false) {
 		write_log(LOG_NOTICE, "Routing algorithm (%d) is not supported.", ip_vs_dest->conn_flags & IP_VS_CONN_F_FWD_MASK);
 		return ALVS_DB_NOT_SUPPORTED;
 	}
+	if (supported_server_port(ip_vs_service, ip_vs_dest) == false) {
+		write_log(LOG_NOTICE, "NAT server of firewall mark or wildcard port service should have a port.");
+		return ALVS_DB_NOT_SUPPORTED;
+	}
 
 	if (ip_vs_dest->l_threshold > ip_vs_dest->u_threshold) {
 		write_log(LOG_ERR, "l_threshold %d > u_threshold %d", ip_vs_dest->l_threshold, ip_vs_dest->u_threshold);
 		return ALVS_DB_NOT_SUPPORTED;
 	}
 	/* Check if service already exists in internal DB */
-	cp_service.ip = bswap_32(ip_vs_service->addr);
-	cp_service.port = bswap_16(ip_vs_service->port);
-	cp_service.protocol = ip_vs_service->protocol;
+	alvs_db_service_key(ip_vs_service, &cp_service);
 	switch (internal_db_get_service(&cp_service, true)) {
 	case ALVS_DB_FAILURE:
 		/* Service doesn't exist */
@@ -2621,6 +4255,11 @@ enum alvs_db_rc alvs_db_modify_server(struct ip_vs_service_user *ip_vs_service,
 		return ALVS_DB_INTERNAL_ERROR;
 	}
 
+	if (supported_service_routing_alg(cp_service.flags, ip_vs_dest->conn_flags) == false) {
+		write_log(LOG_NOTICE, "NAT and full NAT servers are not supported on one-packet scheduling service.");
+		return ALVS_DB_NOT_SUPPORTED;
+	}
+
 	cp_server.ip = bswap_32(ip_vs_dest->addr);
 	cp_server.port = bswap_16(ip_vs_dest->port);
 	switch (internal_db_get_server(&cp_service, &cp_server)) {
@@ -2650,6 +4289,24 @@ enum alvs_db_rc alvs_db_modify_server(struct ip_vs_service_user *ip_vs_service,
 		return ALVS_DB_INTERNAL_ERROR;
 	}
 
+	if (ip_vs_dest->weight != cp_server.weight) {
+		if (alvs_db_service_servers_changeable(&cp_service, &servers_changeable) != ALVS_DB_OK) {
+			return ALVS_DB_NPS_ERROR;
+		}
+		if (servers_changeable == false) {
+			write_log(LOG_NOTICE, "Weight of server of live IPv6 service can't be changed - flows would be remapped.");
+			return ALVS_DB_NOT_SUPPORTED;
+		}
+	}
+
+	/* Replies of a NAT server are classified to their connection */
+	if (!alvs_db_is_nat_server(cp_server.conn_flags) && alvs_db_is_nat_server(ip_vs_dest->conn_flags)) {
+		rc = alvs_db_update_nat_server_filter(cp_server.ip, true);
+		if (rc != ALVS_DB_OK) {
+			return rc;
+		}
+	}
+
 	prev_weight = cp_server.weight;
 	cp_server.conn_flags = ip_vs_dest->conn_flags;
 	cp_server.weight = ip_vs_dest->weight;
@@ -2681,17 +4338,10 @@ enum alvs_db_rc alvs_db_modify_server(struct ip_vs_service_user *ip_vs_service,
 			return rc;
 		}
 
-		build_nps_service_info_key(&cp_service,
-					   &nps_service_info_key);
-		build_nps_service_info_result(&cp_service,
-					      &nps_service_info_result);
-		if (infra_modify_entry(STRUCT_ID_ALVS_SERVICE_INFO,
-				       &nps_service_info_key,
-				       sizeof(struct alvs_service_info_key),
-				       &nps_service_info_result,
-				       sizeof(struct alvs_service_info_result)) == false) {
+		rc = alvs_db_modify_service_info(&cp_service);
+		if (rc != ALVS_DB_OK) {
 			write_log(LOG_CRIT, "Failed to change server count in service info entry.");
-			return ALVS_DB_NPS_ERROR;
+			return rc;
 		}
 	}
 
@@ -2728,16 +4378,12 @@ enum alvs_db_rc alvs_db_delete_server(struct ip_vs_service_user *ip_vs_service,
 	enum alvs_db_rc rc;
 	struct alvs_db_service cp_service;
 	struct alvs_db_server cp_server;
-	struct alvs_service_info_key nps_service_info_key;
-	struct alvs_service_info_result nps_service_info_result;
 	struct alvs_server_info_key nps_server_info_key;
 	struct alvs_server_info_result nps_server_info_result;
-	struct alvs_server_classification_key nps_server_classification_key;
+	bool servers_changeable;
 
 	/* Check if service already exists in internal DB */
-	cp_service.ip = bswap_32(ip_vs_service->addr);
-	cp_service.port = bswap_16(ip_vs_service->port);
-	cp_service.protocol = ip_vs_service->protocol;
+	alvs_db_service_key(ip_vs_service, &cp_service);
 	switch (internal_db_get_service(&cp_service, true)) {
 	case ALVS_DB_FAILURE:
 		/* Service doesn't exist */
@@ -2758,6 +4404,14 @@ enum alvs_db_rc alvs_db_delete_server(struct ip_vs_service_user *ip_vs_service,
 		return ALVS_DB_INTERNAL_ERROR;
 	}
 
+	if (alvs_db_service_servers_changeable(&cp_service, &servers_changeable) != ALVS_DB_OK) {
+		return ALVS_DB_NPS_ERROR;
+	}
+	if (servers_changeable == false) {
+		write_log(LOG_NOTICE, "Servers of live IPv6 service can't be changed - flows would be remapped. Delete and add the service instead.");
+		return ALVS_DB_NOT_SUPPORTED;
+	}
+
 	cp_server.ip = bswap_32(ip_vs_dest->addr);
 	cp_server.port = bswap_16(ip_vs_dest->port);
 	switch (internal_db_get_server(&cp_service, &cp_server)) {
@@ -2802,15 +4456,10 @@ enum alvs_db_rc alvs_db_delete_server(struct ip_vs_service_user *ip_vs_service,
 			return rc;
 		}
 
-		build_nps_service_info_key(&cp_service, &nps_service_info_key);
-		build_nps_service_info_result(&cp_service, &nps_service_info_result);
-		if (infra_modify_entry(STRUCT_ID_ALVS_SERVICE_INFO,
-				       &nps_service_info_key,
-				       sizeof(struct alvs_service_info_key),
-				       &nps_service_info_result,
-				       sizeof(struct alvs_service_info_result)) == false) {
+		rc = alvs_db_modify_service_info(&cp_service);
+		if (rc != ALVS_DB_OK) {
 			write_log(LOG_CRIT, "Failed to change server count in service info entry.");
-			return ALVS_DB_NPS_ERROR;
+			return rc;
 		}
 	}
 
@@ -2825,14 +4474,10 @@ enum alvs_db_rc alvs_db_delete_server(struct ip_vs_service_user *ip_vs_service,
 		return ALVS_DB_NPS_ERROR;
 	}
 
-	build_nps_server_classification_key(&cp_service,
-					    &cp_server,
-					    &nps_server_classification_key);
-	if (infra_delete_entry(STRUCT_ID_ALVS_SERVER_CLASSIFICATION,
-			       &nps_server_classification_key,
-			       sizeof(struct alvs_server_classification_key)) == false) {
+	rc = alvs_db_update_server_classification(&cp_service, &cp_server, ALVS_DB_CLASS_DELETE);
+	if (rc != ALVS_DB_OK) {
 		write_log(LOG_CRIT, "Failed to delete server classification entry.");
-		return ALVS_DB_NPS_ERROR;
+		return rc;
 	}
 
 	write_log(LOG_INFO, "Server (%s:%d) deleted successfully.",
@@ -3345,9 +4990,7 @@ enum alvs_db_rc alvs_db_print_servers_stats(struct ip_vs_service_user *ip_vs_ser
 	memset(&service, 0, sizeof(service));
 	memset(&server_counters, 0, sizeof(server_counters));
 
-	service.ip = bswap_32(ip_vs_service->addr);
-	service.port = bswap_16(ip_vs_service->port);
-	service.protocol = ip_vs_service->protocol;
+	alvs_db_service_key(ip_vs_service, &service);
 
 	/* check if service exist */
 	if (internal_db_get_service(&service, false) == ALVS_DB_FAILURE) {
@@ -3576,7 +5219,6 @@ enum alvs_db_rc alvs_db_clear(void)
 	uint32_t ind;
 	uint32_t service_count;
 	struct alvs_service_node *service_list;
-	struct alvs_service_classification_key nps_service_classification_key;
 
 	if (internal_db_get_service_count(&service_count) != ALVS_DB_OK) {
 		/* Can't retrieve service list */
@@ -3595,14 +5237,15 @@ enum alvs_db_rc alvs_db_clear(void)
 
 	for (ind = 0; ind < service_count; ind++) {
 		write_log(LOG_DEBUG, "Deleting service with nps_index %d.", service_list->service.nps_index);
-		build_nps_service_classification_key(&service_list->service,
-						     &nps_service_classification_key);
-		if (infra_delete_entry(STRUCT_ID_ALVS_SERVICE_CLASSIFICATION,
-				&nps_service_classification_key,
-				sizeof(struct alvs_service_classification_key)) == false) {
+		if (alvs_db_update_service_classification(&service_list->service, ALVS_DB_CLASS_DELETE) != ALVS_DB_OK) {
 			write_log(LOG_CRIT, "Failed to delete service classification entry.");
 			return ALVS_DB_NPS_ERROR;
 		}
+		/* Quarantine service index until connections of the service are aged */
+		if (internal_db_quarantine_service_index(&service_list->service) == ALVS_DB_INTERNAL_ERROR) {
+			write_log(LOG_CRIT, "Failed to quarantine service index.");
+			return ALVS_DB_INTERNAL_ERROR;
+		}
 		service_list = service_list->next;
 	}
 
@@ -3624,7 +5267,6 @@ enum alvs_db_rc alvs_db_clear(void)
 		write_log(LOG_CRIT, "Failed to delete all services in internal DB.");
 		return ALVS_DB_INTERNAL_ERROR;
 	}
-	index_pool_rewind(&service_index_pool);
 	write_log(LOG_DEBUG, "Internal DB cleared.");
 
 	write_log(LOG_INFO, "ALVS DBs cleared successfully.");
@@ -3644,6 +5286,85 @@ void server_db_exit_with_error(void)
 	pthread_exit(NULL);
 }
 
+/**************************************************************************//**
+ * \brief       Age quarantined service indexes. drain time of an index is
+ *              stamped once all servers of its service were aged, and the
+ *              index is returned to the index pool a full aging cycle later,
+ *              after unbound connections and templates of the service expired.
+ *
+ * \return      void
+ */
+void server_db_service_index_aging(void)
+{
+	int rc;
+	sqlite3_stmt *statement;
+	char sql[512];
+	char *zErrMsg = NULL;
+	time_t now = time(NULL);
+	uint32_t nps_index;
+
+	/* Stamp drain time of services which have no server left */
+	sprintf(sql, "UPDATE released_services SET drain_time=%ld "
+		"WHERE drain_time=0 AND NOT EXISTS (SELECT 1 FROM servers "
+		"WHERE srv_ip=released_services.ip AND srv_port=released_services.port "
+		"AND srv_protocol=released_services.protocol);",
+		(long)now);
+
+	/* Execute SQL statement */
+	rc = sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s", zErrMsg);
+		sqlite3_free(zErrMsg);
+		server_db_exit_with_error();
+	}
+
+	sprintf(sql, "SELECT nps_index FROM released_services "
+		"WHERE drain_time>0 AND drain_time<=%ld;",
+		(long)(now - ALVS_DB_SERVICE_INDEX_QUARANTINE_SEC));
+
+	/* Prepare SQL statement */
+	rc = sqlite3_prepare_v2(alvs_db, sql, -1, &statement, NULL);
+	if (rc != SQLITE_OK) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		server_db_exit_with_error();
+	}
+
+	/* Execute SQL statement */
+	rc = sqlite3_step(statement);
+
+	/* Release service indexes */
+	while (rc == SQLITE_ROW) {
+		nps_index = sqlite3_column_int(statement, 0);
+
+		sprintf(sql, "DELETE FROM released_services "
+			"WHERE nps_index=%d;",
+			nps_index);
+		if (sqlite3_exec(alvs_db, sql, NULL, NULL, &zErrMsg) != SQLITE_OK) {
+			write_log(LOG_CRIT, "SQL error: %s", zErrMsg);
+			sqlite3_free(zErrMsg);
+			sqlite3_finalize(statement);
+			server_db_exit_with_error();
+		}
+
+		write_log(LOG_DEBUG, "Releasing service index %d", nps_index);
+		index_pool_release(&service_index_pool, nps_index);
+
+		rc = sqlite3_step(statement);
+	}
+
+	/* Error */
+	if (rc < SQLITE_ROW) {
+		write_log(LOG_CRIT, "SQL error: %s",
+			  sqlite3_errmsg(alvs_db));
+		sqlite3_finalize(statement);
+		server_db_exit_with_error();
+	}
+
+	/* finalize SQL statement */
+	sqlite3_finalize(statement);
+}
+
 void server_db_aging(void)
 {
 	int rc;
@@ -3702,6 +5423,13 @@ void server_db_aging(void)
 					server_db_exit_with_error();
 				}
 
+				/* NAT server has no connections left to classify replies to */
+				if (alvs_db_is_nat_server(sqlite3_column_int(statement, 7)) &&
+				    alvs_db_update_nat_server_filter(cp_server.ip, false) != ALVS_DB_OK) {
+					write_log(LOG_CRIT, "Delete NAT server filter failed in aging thread");
+					server_db_exit_with_error();
+				}
+
 				/* Delete server from NPS DB */
 				build_nps_server_info_key(&cp_server, &nps_server_info_key);
 				if (infra_delete_entry(STRUCT_ID_ALVS_SERVER_INFO,
@@ -3729,6 +5457,8 @@ void server_db_aging(void)
 
 		/* finalize SQL statement */
 		sqlite3_finalize(statement);
+
+		server_db_service_index_aging();
 	}
 }
 
@@ -55,6 +55,40 @@ enum alvs_db_rc {
 
 char *my_inet_ntoa(in_addr_t ip);
 
+/* IPv6 addresses are kept in the DBs by an alias address from 0.0.0.0/8
+ * (host order). NPS tables of IPv6 services and servers are written with
+ * the IPv6 address of the alias.
+ */
+#define ALVS_DB_ADDR6_ALIAS_MAX		0x00FFFFFF
+#define ALVS_DB_IS_ADDR6_ALIAS(ip)	((ip) != 0 && ((ip) & ~ALVS_DB_ADDR6_ALIAS_MAX) == 0)
+
+/* Firewall mark services are kept in the DBs by the mark as address, port 0
+ * and protocol 0. NPS service classification has an entry for every address,
+ * port and protocol classified to the mark (loaded from the fwmark file).
+ */
+#define ALVS_DB_FWMARK_PROTOCOL		0
+#define ALVS_DB_IS_FWMARK(service)	((service)->protocol == ALVS_DB_FWMARK_PROTOCOL)
+
+/**************************************************************************//**
+ * \brief       Get the alias of an IPv6 address (allocated on first use)
+ *
+ * \param[in]   addr6   - reference to IPv6 address
+ * \param[out]  alias   - alias address (host order)
+ *
+ * \return      success, failure or fatal error.
+ */
+enum alvs_db_rc alvs_db_get_addr6_alias(struct in6_addr *addr6, in_addr_t *alias);
+
+/**************************************************************************//**
+ * \brief       Get the IPv6 address of an alias
+ *
+ * \param[in]   alias   - alias address (host order)
+ * \param[out]  addr6   - reference to IPv6 address
+ *
+ * \return      success, failure or fatal error.
+ */
+enum alvs_db_rc alvs_db_get_addr6_by_alias(in_addr_t alias, struct in6_addr *addr6);
+
 /**************************************************************************//**
  * \brief       Initialize internal DB
  *
@@ -141,6 +175,13 @@ enum alvs_db_rc alvs_db_modify_server(struct ip_vs_service_user *ip_vs_service,
 enum alvs_db_rc alvs_db_delete_server(struct ip_vs_service_user *ip_vs_service,
 				      struct ip_vs_dest_user *ip_vs_dest);
 
+/**************************************************************************//**
+ * \brief       write full NAT local address to NPS
+ *
+ * \return      success or NPS error.
+ */
+enum alvs_db_rc alvs_db_write_fullnat_local_ip(void);
+
 /**************************************************************************//**
  * \brief       init state sync daemon
  *
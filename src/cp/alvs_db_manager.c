@@ -85,7 +85,8 @@ void process_packet(uint8_t *buffer, struct sockaddr *saddr);
 void alvs_nl_init(void);
 static int alvs_msg_parser(struct nl_cache_ops *cache_ops, struct genl_cmd *cmd, struct genl_info *info, void *arg);
 static int alvs_genl_parse_service(struct nlattr *nla, struct ip_vs_service_user *ret_svc, bool need_full_svc);
-static int alvs_genl_parse_dest(struct nlattr *nla, struct ip_vs_dest_user *ret_dest, bool need_full_dest);
+static int alvs_genl_parse_dest(struct nlattr *nla, struct ip_vs_dest_user *ret_dest, bool need_full_dest, bool addr6);
+static int alvs_addr6_to_alias(void *addr6, __be32 *addr);
 static int alvs_genl_parse_daemon(struct nl_msg *msg, void *arg);
 static int alvs_genl_parse_daemon_from_msghdr(struct nlmsghdr *nlh, void *arg);
 struct ip_vs_get_services *alvs_get_services(void);
@@ -339,6 +340,11 @@ void alvs_db_manager_table_init(void)
 	unsigned int i, j;
 	enum alvs_db_rc alvs_ret;
 
+	if (alvs_db_write_fullnat_local_ip() != ALVS_DB_OK) {
+		write_log(LOG_CRIT, "Failed to write full NAT local address during table init.");
+		alvs_db_manager_exit_with_error();
+	}
+
 	/* Get state sync daemon info and start sync daemon with the current configuration */
 	write_log(LOG_DEBUG, "Getting state sync daemon info and start initializing sync daemon with the current configuration");
 	ip_vs_daemon_info = alvs_get_state_sync_info();
@@ -737,7 +743,8 @@ static int alvs_msg_parser(struct nl_cache_ops __attribute__((__unused__))*cache
 		write_log(LOG_DEBUG, "received service: addr = %s:%d, protocol = %d, fwmark = %d, sched_name = %s", my_inet_ntoa(bswap_32(svc.addr)), svc.port, svc.protocol, svc.fwmark, svc.sched_name);
 
 		need_full_dest = true;
-		ret = alvs_genl_parse_dest(info->attrs[IPVS_CMD_ATTR_DEST], &dest, need_full_dest);
+		ret = alvs_genl_parse_dest(info->attrs[IPVS_CMD_ATTR_DEST], &dest, need_full_dest,
+					   ALVS_DB_IS_ADDR6_ALIAS(bswap_32(svc.addr)));
 		if (ret < 0)
 			return NL_SKIP;
 		write_log(LOG_DEBUG, "received dest: %s:%d, weight = %d, flags = 0x%08x", my_inet_ntoa(bswap_32(dest.addr)), dest.port, dest.weight, dest.conn_flags);
@@ -755,7 +762,8 @@ static int alvs_msg_parser(struct nl_cache_ops __attribute__((__unused__))*cache
 		write_log(LOG_DEBUG, "received service: addr = %s:%d, protocol = %d, fwmark = %d, sched_name = %s", my_inet_ntoa(bswap_32(svc.addr)), svc.port, svc.protocol, svc.fwmark, svc.sched_name);
 
 		need_full_dest = true;
-		ret = alvs_genl_parse_dest(info->attrs[IPVS_CMD_ATTR_DEST], &dest, need_full_dest);
+		ret = alvs_genl_parse_dest(info->attrs[IPVS_CMD_ATTR_DEST], &dest, need_full_dest,
+					   ALVS_DB_IS_ADDR6_ALIAS(bswap_32(svc.addr)));
 		if (ret < 0)
 			return NL_SKIP;
 		write_log(LOG_DEBUG, "received dest: %s:%d, weight = %d, flags = 0x%08x", my_inet_ntoa(bswap_32(dest.addr)), dest.port, dest.weight, dest.conn_flags);
@@ -773,7 +781,8 @@ static int alvs_msg_parser(struct nl_cache_ops __attribute__((__unused__))*cache
 			return NL_SKIP;
 		write_log(LOG_DEBUG, "received service: addr = %s:%d, protocol = %d, fwmark = %d, sched_name = %s", my_inet_ntoa(bswap_32(svc.addr)), svc.port, svc.protocol, svc.fwmark, svc.sched_name);
 
-		ret = alvs_genl_parse_dest(info->attrs[IPVS_CMD_ATTR_DEST], &dest, need_full_dest);
+		ret = alvs_genl_parse_dest(info->attrs[IPVS_CMD_ATTR_DEST], &dest, need_full_dest,
+					   ALVS_DB_IS_ADDR6_ALIAS(bswap_32(svc.addr)));
 		if (ret < 0)
 			return NL_SKIP;
 		write_log(LOG_DEBUG, "received dest: %s:%d, weight = %d, flags = 0x%08x", my_inet_ntoa(bswap_32(dest.addr)), dest.port, dest.weight, dest.conn_flags);
@@ -903,7 +912,18 @@ static int alvs_services_parse_cb(struct nl_msg *msg, void *arg)
 		return -1;
 	}
 
-	if (svc_attrs[IPVS_SVC_ATTR_FWMARK]) {
+	if (nla_get_u16(svc_attrs[IPVS_SVC_ATTR_AF]) == AF_INET6) {
+		if (svc_attrs[IPVS_SVC_ATTR_FWMARK]) {
+			write_log(LOG_NOTICE, "IPv6 fwmark service is not supported - skipped");
+			return 0;
+		}
+		/* IPv6 service is kept by its alias address */
+		if (alvs_addr6_to_alias(nla_data(svc_attrs[IPVS_SVC_ATTR_ADDR]), &get->entrytable[i].addr) < 0) {
+			return -1;
+		}
+		get->entrytable[i].protocol = nla_get_u16(svc_attrs[IPVS_SVC_ATTR_PROTOCOL]);
+		get->entrytable[i].port = nla_get_u16(svc_attrs[IPVS_SVC_ATTR_PORT]);
+	} else if (svc_attrs[IPVS_SVC_ATTR_FWMARK]) {
 		get->entrytable[i].fwmark = nla_get_u32(svc_attrs[IPVS_SVC_ATTR_FWMARK]);
 	} else {
 		get->entrytable[i].protocol = nla_get_u16(svc_attrs[IPVS_SVC_ATTR_PROTOCOL]);
@@ -979,9 +999,16 @@ static int alvs_dests_parse_cb(struct nl_msg *msg, void *arg)
 		return -1;
 	}
 
-	memcpy(&(d->entrytable[i].addr),
-	       nla_data(dest_attrs[IPVS_DEST_ATTR_ADDR]),
-	       sizeof(d->entrytable[i].addr));
+	if (ALVS_DB_IS_ADDR6_ALIAS(bswap_32(d->addr))) {
+		/* servers of IPv6 service are kept by their alias address */
+		if (alvs_addr6_to_alias(nla_data(dest_attrs[IPVS_DEST_ATTR_ADDR]), &d->entrytable[i].addr) < 0) {
+			return -1;
+		}
+	} else {
+		memcpy(&(d->entrytable[i].addr),
+		       nla_data(dest_attrs[IPVS_DEST_ATTR_ADDR]),
+		       sizeof(d->entrytable[i].addr));
+	}
 	d->entrytable[i].port = nla_get_u16(dest_attrs[IPVS_DEST_ATTR_PORT]);
 	d->entrytable[i].conn_flags = nla_get_u32(dest_attrs[IPVS_DEST_ATTR_FWD_METHOD]);
 	d->entrytable[i].weight = nla_get_u32(dest_attrs[IPVS_DEST_ATTR_WEIGHT]);
@@ -1146,12 +1173,24 @@ static int alvs_genl_parse_service(struct nlattr *nla, struct ip_vs_service_user
 
 	memset(ret_svc, 0, sizeof(struct ip_vs_service_user));
 
-	if (nla_get_u16(nla_af) != AF_INET) {
-		write_log(LOG_ERR, "Error - Not IPV4");
+	if (nla_get_u16(nla_af) == AF_INET6) {
+		if (nla_fwmark) {
+			write_log(LOG_ERR, "Error - IPV6 fwmark service is not supported");
+			return -1;
+		}
+		/* IPv6 service is kept by its alias address */
+		if (nla_len(nla_addr) < (int)sizeof(struct in6_addr) ||
+		    alvs_addr6_to_alias(nla_data(nla_addr), &ret_svc->addr) < 0) {
+			write_log(LOG_ERR, "Error - bad IPV6 service address");
+			return -1;
+		}
+		ret_svc->protocol = nla_get_u16(nla_protocol);
+		ret_svc->port = nla_get_u16(nla_port);
+		ret_svc->fwmark = 0;
+	} else if (nla_get_u16(nla_af) != AF_INET) {
+		write_log(LOG_ERR, "Error - Not IPV4 or IPV6");
 		return -1;
-	}
-
-	if (nla_fwmark) {
+	} else if (nla_fwmark) {
 		ret_svc->protocol = IPPROTO_TCP;
 		ret_svc->fwmark = nla_get_u32(nla_fwmark);
 	} else {
@@ -1183,10 +1222,12 @@ static int alvs_genl_parse_service(struct nlattr *nla, struct ip_vs_service_user
 }
 /******************************************************************************
  * \brief         Parses destination received in NL message using dest attr
+ *                Destination of an IPv6 service (addr6) is kept by its alias
+ *                address.
  *
  * \return        int - ret code
  */
-static int alvs_genl_parse_dest(struct nlattr *nla, struct ip_vs_dest_user *ret_dest, bool need_full_dest)
+static int alvs_genl_parse_dest(struct nlattr *nla, struct ip_vs_dest_user *ret_dest, bool need_full_dest, bool addr6)
 {
 	struct nlattr *attrs[IPVS_DEST_ATTR_MAX + 1];
 	struct nlattr *nla_addr, *nla_port;
@@ -1207,7 +1248,15 @@ static int alvs_genl_parse_dest(struct nlattr *nla, struct ip_vs_dest_user *ret_
 	}
 
 	memset(ret_dest, 0, sizeof(struct ip_vs_dest_user));
-	nla_memcpy(&ret_dest->addr, nla_addr, sizeof(ret_dest->addr));
+	if (addr6) {
+		if (nla_len(nla_addr) < (int)sizeof(struct in6_addr) ||
+		    alvs_addr6_to_alias(nla_data(nla_addr), &ret_dest->addr) < 0) {
+			write_log(LOG_ERR, "Error - bad IPV6 dest address");
+			return -1;
+		}
+	} else {
+		nla_memcpy(&ret_dest->addr, nla_addr, sizeof(ret_dest->addr));
+	}
 	ret_dest->port = nla_get_u16(nla_port); /* was nla_get_be16 */
 
 	/* If a full entry was requested, check for the additional fields */
@@ -1225,6 +1274,27 @@ static int alvs_genl_parse_dest(struct nlattr *nla, struct ip_vs_dest_user *ret_
 	return 0;
 }
 
+/******************************************************************************
+ * \brief         Translate IPv6 address received in NL message to its alias
+ *                address (network order).
+ *
+ * \return        int - ret code
+ */
+static int alvs_addr6_to_alias(void *addr6, __be32 *addr)
+{
+	struct in6_addr ip6;
+	in_addr_t alias;
+
+	memcpy(&ip6, addr6, sizeof(ip6));
+	if (alvs_db_get_addr6_alias(&ip6, &alias) != ALVS_DB_OK) {
+		write_log(LOG_ERR, "Failed to get alias of IPv6 address");
+		return -1;
+	}
+	*addr = bswap_32(alias);
+
+	return 0;
+}
+
 /******************************************************************************
  * \brief         Send get dests request to kernel using NL message.
  *                returns the destination (server) list received and parsed by
@@ -1274,11 +1344,23 @@ struct ip_vs_get_dests *alvs_get_dests(struct ip_vs_service_entry *svc)
 		free(d);
 		return NULL;
 	}
-	NLA_PUT_U16(msg, IPVS_SVC_ATTR_AF, AF_INET);
-	if (svc->fwmark) {
-		NLA_PUT_U32(msg, IPVS_SVC_ATTR_FWMARK, ntohl(svc->fwmark));
+	memset(&addr, 0, sizeof(addr));
+	if (!svc->fwmark && ALVS_DB_IS_ADDR6_ALIAS(bswap_32(svc->addr))) {
+		/* IPv6 service - send its real address */
+		if (alvs_db_get_addr6_by_alias(bswap_32(svc->addr), &addr.in6) != ALVS_DB_OK) {
+			write_log(LOG_ERR, "Failed to get IPv6 address of service alias");
+			nlmsg_free(msg);
+			free(d);
+			return NULL;
+		}
+		NLA_PUT_U16(msg, IPVS_SVC_ATTR_AF, AF_INET6);
 	} else {
+		NLA_PUT_U16(msg, IPVS_SVC_ATTR_AF, AF_INET);
 		addr.ip = svc->addr;
+	}
+	if (svc->fwmark) {
+		NLA_PUT_U32(msg, IPVS_SVC_ATTR_FWMARK, svc->fwmark);
+	} else {
 		write_log(LOG_DEBUG, "Fill service details into message: protocol = 0x%x addr = 0x%x port = 0x%x", svc->protocol, svc->addr, svc->port);
 		NLA_PUT_U16(msg, IPVS_SVC_ATTR_PROTOCOL, svc->protocol);
 		NLA_PUT(msg, IPVS_SVC_ATTR_ADDR, sizeof(union nf_inet_addr), &addr);
@@ -1317,7 +1399,7 @@ bool alvs_db_constructor(void)
 	write_log(LOG_DEBUG, "Creating service classification table.");
 	hash_params.key_size = sizeof(struct alvs_service_classification_key);
 	hash_params.result_size = sizeof(struct alvs_service_classification_result);
-	hash_params.max_num_of_entries = ALVS_SERVICES_MAX_ENTRIES;
+	hash_params.max_num_of_entries = ALVS_SERVICES_MAX_ENTRIES + ALVS_FWMARK_MAX_ENTRIES;
 	hash_params.hash_size = 0;
 	hash_params.updated_from_dp = false;
 	hash_params.main_table_search_mem_heap = INFRA_EMEM_SEARCH_HASH_HEAP;
@@ -1329,6 +1411,33 @@ bool alvs_db_constructor(void)
 		return false;
 	}
 
+	write_log(LOG_DEBUG, "Creating VIP filter table.");
+	table_params.key_size = sizeof(struct alvs_vip_filter_key);
+	table_params.result_size = sizeof(struct alvs_vip_filter_result);
+	table_params.max_num_of_entries = ALVS_VIP_FILTER_ENTRIES;
+	table_params.updated_from_dp = false;
+	table_params.search_mem_heap = INFRA_X4_CLUSTER_SEARCH_HEAP;
+	retcode = infra_create_table(STRUCT_ID_ALVS_VIP_FILTER, &table_params);
+	if (retcode == false) {
+		write_log(LOG_CRIT, "Failed to create alvs VIP filter table.");
+		return false;
+	}
+
+	write_log(LOG_DEBUG, "Creating service6 classification table.");
+	hash_params.key_size = sizeof(struct alvs_service6_classification_key);
+	hash_params.result_size = sizeof(struct alvs_service_classification_result);
+	hash_params.max_num_of_entries = ALVS_SERVICES_MAX_ENTRIES;
+	hash_params.hash_size = 0;
+	hash_params.updated_from_dp = false;
+	hash_params.main_table_search_mem_heap = INFRA_EMEM_SEARCH_HASH_HEAP;
+	hash_params.sig_table_search_mem_heap = INFRA_EMEM_SEARCH_HASH_HEAP;
+	hash_params.res_table_search_mem_heap = INFRA_EMEM_SEARCH_1_TABLE_HEAP;
+	retcode = infra_create_hash(STRUCT_ID_ALVS_SERVICE6_CLASSIFICATION, &hash_params);
+	if (retcode == false) {
+		write_log(LOG_CRIT, "Failed to create alvs service6 classification hash.");
+		return false;
+	}
+
 	write_log(LOG_DEBUG, "Creating service info table.");
 	table_params.key_size = sizeof(struct alvs_service_info_key);
 	table_params.result_size = sizeof(struct alvs_service_info_result);
@@ -1365,11 +1474,27 @@ bool alvs_db_constructor(void)
 		return false;
 	}
 
+	write_log(LOG_DEBUG, "Creating server6 info table.");
+	table_params.key_size = sizeof(struct alvs_server_info_key);
+	table_params.result_size = sizeof(struct alvs_server6_info_result);
+	table_params.max_num_of_entries = ALVS_SERVERS_MAX_ENTRIES;
+	table_params.updated_from_dp = false;
+	table_params.search_mem_heap = INFRA_EMEM_SEARCH_1_TABLE_HEAP;
+	retcode = infra_create_table(STRUCT_ID_ALVS_SERVER6_INFO, &table_params);
+	if (retcode == false) {
+		write_log(LOG_CRIT, "Failed to create alvs server6 info table.");
+		return false;
+	}
+
 	write_log(LOG_DEBUG, "Creating connection classification table.");
 	hash_params.key_size = sizeof(struct alvs_conn_classification_key);
 	hash_params.result_size = sizeof(struct alvs_conn_classification_result);
 	hash_params.max_num_of_entries = ALVS_CONN_MAX_ENTRIES;
+#ifdef ALVS_CONN_COMPACT
+	hash_params.hash_size = 27;
+#else
 	hash_params.hash_size = 26;
+#endif
 	hash_params.updated_from_dp = true;
 	hash_params.sig_pool_id = CONNECTION_CLASSIFICATION_SIG_POOL_INDEX;
 	hash_params.result_pool_id = CONNECTION_CLASSIFICATION_RES_POOL_INDEX;
@@ -1382,9 +1507,30 @@ bool alvs_db_constructor(void)
 		return false;
 	}
 
+	write_log(LOG_DEBUG, "Creating NAT classification table.");
+	hash_params.key_size = sizeof(struct alvs_nat_classification_key);
+	hash_params.result_size = sizeof(struct alvs_nat_classification_result);
+	hash_params.max_num_of_entries = ALVS_NAT_MAX_ENTRIES;
+#ifdef ALVS_CONN_COMPACT
+	hash_params.hash_size = 0;
+#else
+	hash_params.hash_size = 24;
+#endif
+	hash_params.updated_from_dp = true;
+	hash_params.sig_pool_id = NAT_CLASSIFICATION_SIG_POOL_INDEX;
+	hash_params.result_pool_id = NAT_CLASSIFICATION_RES_POOL_INDEX;
+	hash_params.main_table_search_mem_heap = INFRA_EMEM_SEARCH_HASH_HEAP;
+	hash_params.sig_table_search_mem_heap = INFRA_EMEM_SEARCH_HASH_HEAP;
+	hash_params.res_table_search_mem_heap = INFRA_EMEM_SEARCH_1_TABLE_HEAP;
+	retcode = infra_create_hash(STRUCT_ID_ALVS_NAT_CLASSIFICATION, &hash_params);
+	if (retcode == false) {
+		write_log(LOG_CRIT, "Failed to create alvs NAT classification hash.");
+		return false;
+	}
+
 	write_log(LOG_DEBUG, "Creating connection info table.");
 	table_params.key_size = sizeof(struct alvs_conn_info_key);
-	table_params.result_size = sizeof(struct alvs_conn_info_result);
+	table_params.result_size = ALVS_CONN_INFO_ENTRY_SIZE;
 	table_params.max_num_of_entries = ALVS_CONN_MAX_ENTRIES;
 	table_params.updated_from_dp = true;
 	table_params.search_mem_heap = INFRA_EMEM_SEARCH_1_TABLE_HEAP;
@@ -1394,6 +1540,18 @@ bool alvs_db_constructor(void)
 		return false;
 	}
 
+	write_log(LOG_DEBUG, "Creating LBLC info table.");
+	table_params.key_size = sizeof(struct alvs_lblc_info_key);
+	table_params.result_size = sizeof(struct alvs_lblc_info_result);
+	table_params.max_num_of_entries = ALVS_LBLC_MAX_ENTRIES;
+	table_params.updated_from_dp = true;
+	table_params.search_mem_heap = INFRA_EMEM_SEARCH_1_TABLE_HEAP;
+	retcode = infra_create_table(STRUCT_ID_ALVS_LBLC_INFO, &table_params);
+	if (retcode == false) {
+		write_log(LOG_CRIT, "Failed to create alvs LBLC info table.");
+		return false;
+	}
+
 	write_log(LOG_DEBUG, "Creating server classification table.");
 	hash_params.key_size = sizeof(struct alvs_server_classification_key);
 	hash_params.result_size = sizeof(struct alvs_server_classification_result);
@@ -42,7 +42,7 @@ const char *nw_if_posted_stats_offsets_names[] = {
 	"FAIL_FIB_LOOKUP",			/* 9 */
 	"REJECT_BY_FIB",			/* 10 */
 	"UNKNOWN_FIB_RESULT",			/* 11 */
-	"",					/* 12 */
+	"IPV6_ERROR",				/* 12 */
 	"",					/* 13 */
 	"",					/* 14 */
 	"",					/* 15 */
@@ -85,15 +85,15 @@ const char *alvs_error_stats_offsets_names[] = {
 	"STATE_SYNC_BAD_BUFFER",		/* 28 */
 	"STATE_SYNC_DECODE_CONN",		/* 29 */
 	"STATE_SYNC_BAD_MESSAGE_VERSION",	/* 30 */
-	"",					/* 31 */
-	"",					/* 32 */
-	"",					/* 33 */
-	"",					/* 34 */
-	"",					/* 35 */
-	"",					/* 36 */
-	"",					/* 37 */
-	"",					/* 38 */
-	"",					/* 39 */
+	"NON_SYN_MISS_DROP",			/* 31 */
+	"NON_SYN_MISS_PUNT_LIMIT",		/* 32 */
+	"HALF_OPEN_LIMIT",			/* 33 */
+	"NAT_CLASS_ALLOC_FAIL",			/* 34 */
+	"TUNNEL_NO_HEADROOM",			/* 35 */
+	"TUNNEL_NO_SOURCE_IP",			/* 36 */
+	"TUNNEL_FRAG_NEEDED",			/* 37 */
+	"FULLNAT_PORT_ALLOC_FAIL",		/* 38 */
+	"TUNNEL_MTU_EXCEEDED",			/* 39 */
 	"",					/* 40 */
 };
 
@@ -122,6 +122,23 @@ enum infra_emem_spaces_params {
 #define INFRA_EMEM_SEARCH_1_TABLE_SIZE      (3500)
 #define INFRA_EMEM_SEARCH_2_TABLE_SIZE      (1*1024)
 
+/* Capacity of EMEM search 1 table heap (MB) for the connection DBs - connection
+ * info entries and the results of connection and NAT classification hashes.
+ * compact mode doubles ALVS_CONN_MAX_ENTRIES in the same heap: its 16 byte info
+ * entry makes up for the doubled classification results, and NAT (full entry
+ * only) keeps a small hash. the rest of the heap is left for the small DBs.
+ * main and signature tables of the hashes are in the search hash heap and grow
+ * with hash_size - EZapiStruct fails their creation on init when they do not fit.
+ */
+#define INFRA_EMEM_CONN_TABLES_SIZE \
+	((((uint64_t)ALVS_CONN_MAX_ENTRIES * (ALVS_CONN_INFO_ENTRY_SIZE + sizeof(struct alvs_conn_classification_result))) + \
+	  ((uint64_t)ALVS_NAT_MAX_ENTRIES * sizeof(struct alvs_nat_classification_result))) >> 20)
+
+#if defined(ALVS_CONN_COMPACT) && defined(ALVS_CONN_INLINE_INFO)
+#error "compact connection entries with inline connection info do not fit EMEM search 1 table heap"
+#endif
+CASSERT(INFRA_EMEM_CONN_TABLES_SIZE < INFRA_EMEM_SEARCH_1_TABLE_SIZE);
+
 #define INFRA_EMEM_DATA_OUT_OF_BAND_SIZE    256
 
 #define NUM_OF_INT_MEMORY_SPACES            5
@@ -616,6 +633,45 @@ bool infra_create_index_pools(void)
 	}
 
 
+	/* configure 2 pools for NAT classification search - pool 4 is USER_POOL_ID */
+	memset(&index_pool_params, 0, sizeof(index_pool_params));
+	index_pool_params.uiPool = NAT_CLASSIFICATION_SIG_POOL_INDEX;
+
+	ret_val = EZapiChannel_Status(0, EZapiChannel_StatCmd_GetIndexPoolParams, &index_pool_params);
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "EZapiChannel_Status: EZapiChannel_StatCmd_GetIndexPoolParams failed.");
+		return false;
+	}
+
+	index_pool_params.bEnable = true;
+	index_pool_params.bSearch = true;
+
+	ret_val = EZapiChannel_Config(0, EZapiChannel_ConfigCmd_SetIndexPoolParams, &index_pool_params);
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "EZapiChannel_Config: EZapiChannel_ConfigCmd_SetIndexPoolParams failed.");
+		return false;
+	}
+
+
+	memset(&index_pool_params, 0, sizeof(index_pool_params));
+	index_pool_params.uiPool = NAT_CLASSIFICATION_RES_POOL_INDEX;
+
+	ret_val = EZapiChannel_Status(0, EZapiChannel_StatCmd_GetIndexPoolParams, &index_pool_params);
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "EZapiChannel_Status: EZapiChannel_StatCmd_GetIndexPoolParams failed.");
+		return false;
+	}
+
+	index_pool_params.bEnable = true;
+	index_pool_params.bSearch = true;
+
+	ret_val = EZapiChannel_Config(0, EZapiChannel_ConfigCmd_SetIndexPoolParams, &index_pool_params);
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "EZapiChannel_Config: EZapiChannel_ConfigCmd_SetIndexPoolParams failed.");
+		return false;
+	}
+
+
 	memset(&index_pool_params, 0, sizeof(index_pool_params));
 	index_pool_params.uiPool = USER_POOL_ID;
 
@@ -634,6 +690,26 @@ bool infra_create_index_pools(void)
 		return false;
 	}
 
+
+	/* full NAT local ports */
+	memset(&index_pool_params, 0, sizeof(index_pool_params));
+	index_pool_params.uiPool = USER_FULLNAT_POOL_ID;
+
+	ret_val = EZapiChannel_Status(0, EZapiChannel_StatCmd_GetIndexPoolParams, &index_pool_params);
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "EZapiChannel_Status: EZapiChannel_StatCmd_GetIndexPoolParams failed.");
+		return false;
+	}
+
+	index_pool_params.bEnable = true;
+	index_pool_params.uiNumIndexes = ALVS_FULLNAT_PORT_COUNT;
+
+	ret_val = EZapiChannel_Config(0, EZapiChannel_ConfigCmd_SetIndexPoolParams, &index_pool_params);
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "EZapiChannel_Status: EZapiChannel_ConfigCmd_SetIndexPoolParams failed.");
+		return false;
+	}
+
 	return true;
 }
 
@@ -756,6 +832,30 @@ bool infra_initialize_statistics(void)
 		return false;
 	}
 
+	/* profile 1 - non-SYN connection misses sent to host */
+	token_bucket_profile.uiPartition = 0;
+	token_bucket_profile.uiProfile = 1;
+
+	ret_val = EZapiStat_Status(0, EZapiStat_StatCmd_GetTokenBucketProfile, &token_bucket_profile);
+
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "EZapiStat_Config: EZapiStat_StatCmd_GetTokenBucketProfile failed.");
+		return false;
+	}
+
+	token_bucket_profile.uiPartition = 0;
+	token_bucket_profile.uiProfile = 1;
+	token_bucket_profile.uiCIR = ALVS_TB_PROFILE_1_CIR;
+	token_bucket_profile.eCIRResolution = ALVS_TB_PROFILE_1_CIR_RESOLUTION;
+	token_bucket_profile.uiCBS = ALVS_TB_PROFILE_1_CBS;
+
+	ret_val = EZapiStat_Config(0, EZapiStat_ConfigCmd_SetTokenBucketProfile, &token_bucket_profile);
+
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "EZapiStat_Config: EZapiStat_ConfigCmd_SetTokenBucketProfile failed.");
+		return false;
+	}
+
 	memset(&token_bucket_counter_config, 0, sizeof(token_bucket_counter_config));
 
 	token_bucket_counter_config.pasCounters = malloc(sizeof(EZapiStat_TBCounter) * 1);
@@ -772,13 +872,25 @@ bool infra_initialize_statistics(void)
 	token_bucket_counter_config.pasCounters[0].eAlgorithm = EZapiStat_TBAlgorithm_SINGLE_BUCKET;
 
 	ret_val = EZapiStat_Config(0, EZapiStat_ConfigCmd_SetTokenBucketCounters, &token_bucket_counter_config);
-	free(token_bucket_counter_config.pasCounters);
 
 	if (EZrc_IS_ERROR(ret_val)) {
+		free(token_bucket_counter_config.pasCounters);
 		write_log(LOG_CRIT, "EZapiStat_Config: EZapiStat_ConfigCmd_SetTokenBucketProfile failed.");
 		return false;
 	}
 
+	token_bucket_counter_config.uiStartCounter = EMEM_STATS_ON_DEMAND_NON_SYN_TB_OFFSET;
+	token_bucket_counter_config.uiNumCounters = EMEM_STATS_ON_DEMAND_NON_SYN_TB_NUM;
+	token_bucket_counter_config.pasCounters[0].uiCommitProfile = 1;
+
+	ret_val = EZapiStat_Config(0, EZapiStat_ConfigCmd_SetTokenBucketCounters, &token_bucket_counter_config);
+	free(token_bucket_counter_config.pasCounters);
+
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "EZapiStat_Config: EZapiStat_ConfigCmd_SetTokenBucketCounters failed.");
+		return false;
+	}
+
 	/* Set posted statistics values to be 0 */
 	memset(&long_counter_config, 0, sizeof(long_counter_config));
 	long_counter_config.pasCounters = malloc(sizeof(EZapiStat_LongCounter));
@@ -798,6 +910,17 @@ bool infra_initialize_statistics(void)
 	long_counter_config.pasCounters[0].bEnableThresholdMsg = FALSE;
 	long_counter_config.pasCounters[0].uiThreshold = 58;
 
+	ret_val = EZapiStat_Config(0, EZapiStat_ConfigCmd_SetLongCounters, &long_counter_config);
+	if (EZrc_IS_ERROR(ret_val)) {
+		free(long_counter_config.pasCounters);
+		write_log(LOG_CRIT, "EZapiStat_Config: EZapiStat_ConfigCmd_SetLongCounters failed.");
+		return false;
+	}
+
+	/* service half-open connection counters */
+	long_counter_config.uiStartCounter = EMEM_STATS_ON_DEMAND_HALF_OPEN_OFFSET;
+	long_counter_config.uiNumCounters = EMEM_STATS_ON_DEMAND_HALF_OPEN_NUM;
+
 	ret_val = EZapiStat_Config(0, EZapiStat_ConfigCmd_SetLongCounters, &long_counter_config);
 	free(long_counter_config.pasCounters);
 	if (EZrc_IS_ERROR(ret_val)) {
@@ -55,13 +55,15 @@ enum infra_search_mem_heaps {
 /*! Sig pool index possible values. */
 enum sig_pool_index {
 	CONNECTION_CLASSIFICATION_SIG_POOL_INDEX = 0,
-	SERVER_CLASSIFICATION_SIG_POOL_INDEX = 2
+	SERVER_CLASSIFICATION_SIG_POOL_INDEX = 2,
+	NAT_CLASSIFICATION_SIG_POOL_INDEX = 5
 };
 
 /*! Sig pool index possible values. */
 enum result_pool_index {
 	CONNECTION_CLASSIFICATION_RES_POOL_INDEX = 1,
-	SERVER_CLASSIFICATION_RES_POOL_INDEX = 3
+	SERVER_CLASSIFICATION_RES_POOL_INDEX = 3,
+	NAT_CLASSIFICATION_RES_POOL_INDEX = 6
 };
 
 /*! Required parameters for hash creation data structure  */
@@ -38,6 +38,9 @@
 #include <stdint.h>
 #include <getopt.h>
 #include <signal.h>
+#include <stdlib.h>
+#include <byteswap.h>
+#include <arpa/inet.h>
 #include <EZenv.h>
 #include <EZdev.h>
 #include <EZlog.h>
@@ -49,6 +52,7 @@
 #include "alvs_db_manager.h"
 
 #include "defs.h"
+#include "alvs_search_defs.h"
 #include "version.h"
 
 /******************************************************************************/
@@ -77,6 +81,11 @@ bool cancel_application_flag;
 int agt_enabled;
 int print_stats_enabled;
 EZapiChannel_EthIFType port_type;
+uint32_t non_syn_miss_flags;
+in_addr_t tunnel_source_ip;
+uint16_t tunnel_mtu;
+in_addr_t fullnat_local_ip;
+char *fwmark_file;
 int fd = -1;
 /******************************************************************************/
 
@@ -84,11 +93,19 @@ int main(int argc, char **argv)
 {
 	int rc;
 	int option_index;
+	struct in_addr tunnel_source_addr;
+	struct in_addr fullnat_local_addr;
+	unsigned long tunnel_mtu_arg;
 
 	struct option long_options[] = {
 		{ "agt_enabled", no_argument, &agt_enabled, true },
 		{ "statistics", no_argument, &print_stats_enabled, true },
 		{ "port_type", required_argument, 0, 'p' },
+		{ "non_syn_miss", required_argument, 0, 'n' },
+		{ "tunnel_source_ip", required_argument, 0, 's' },
+		{ "tunnel_mtu", required_argument, 0, 'm' },
+		{ "fullnat_local_ip", required_argument, 0, 'l' },
+		{ "fwmark_file", required_argument, 0, 'f' },
 		{0, 0, 0, 0} };
 
 	cancel_application_flag = false;
@@ -105,6 +122,11 @@ int main(int argc, char **argv)
 	print_stats_enabled = false;
 	agt_enabled = false;
 	port_type = EZapiChannel_EthIFType_40GE;
+	non_syn_miss_flags = 0;
+	tunnel_source_ip = 0;
+	tunnel_mtu = ALVS_TUNNEL_DEFAULT_MTU;
+	fullnat_local_ip = 0;
+	fwmark_file = NULL;
 
 	while (true) {
 		rc = getopt_long(argc, argv, "", long_options, &option_index);
@@ -129,6 +151,48 @@ int main(int argc, char **argv)
 			}
 			break;
 
+		case 'n':
+			if (strcmp(optarg, "create") == 0) {
+				non_syn_miss_flags = 0;
+			} else if (strcmp(optarg, "drop") == 0) {
+				non_syn_miss_flags = ALVS_SVC_F_NON_SYN_DROP;
+			} else if (strcmp(optarg, "punt") == 0) {
+				non_syn_miss_flags = ALVS_SVC_F_NON_SYN_PUNT;
+			} else {
+				write_log(LOG_CRIT, "Non SYN miss argument is invalid (%s), valid values are create, drop and punt.", optarg);
+				abort();
+			}
+			break;
+
+		case 's':
+			if (inet_aton(optarg, &tunnel_source_addr) == 0) {
+				write_log(LOG_CRIT, "Tunnel source IP argument is invalid (%s).", optarg);
+				abort();
+			}
+			tunnel_source_ip = bswap_32(tunnel_source_addr.s_addr);
+			break;
+
+		case 'm':
+			tunnel_mtu_arg = strtoul(optarg, NULL, 10);
+			if (tunnel_mtu_arg < ALVS_TUNNEL_MIN_MTU || tunnel_mtu_arg > UINT16_MAX) {
+				write_log(LOG_CRIT, "Tunnel MTU argument is invalid (%s), valid values are %d-%d.", optarg, ALVS_TUNNEL_MIN_MTU, UINT16_MAX);
+				abort();
+			}
+			tunnel_mtu = tunnel_mtu_arg;
+			break;
+
+		case 'l':
+			if (inet_aton(optarg, &fullnat_local_addr) == 0) {
+				write_log(LOG_CRIT, "Full NAT local IP argument is invalid (%s).", optarg);
+				abort();
+			}
+			fullnat_local_ip = bswap_32(fullnat_local_addr.s_addr);
+			break;
+
+		case 'f':
+			fwmark_file = optarg;
+			break;
+
 		case '?':
 			break;
 
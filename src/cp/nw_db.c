@@ -54,6 +54,7 @@
 /* Global pointer to the DB */
 sqlite3 *nw_db;
 uint32_t fib_entry_count;
+uint32_t fib6_entry_count;
 
 extern const char *nw_if_posted_stats_offsets_names[];
 
@@ -63,6 +64,9 @@ struct nw_db_fib_entry {
 	enum nw_fib_type           result_type;
 	in_addr_t                  next_hop;
 	uint16_t                   nps_index;
+	int                        family;
+	struct in6_addr            dest_ip6;
+	struct in6_addr            next_hop6;
 };
 
 #define NW_DB_FILE_NAME "nw.db"
@@ -81,6 +85,36 @@ char *nw_inet_ntoa(in_addr_t ip)
 	return inet_ntoa(ip_addr);
 }
 
+/**************************************************************************//**
+ * \brief       Destination IP of FIB entry to string
+ *
+ * \param[in]   fib_entry - reference to fib entry
+ *
+ * \return      String of IP
+ */
+char *nw_fib_entry_ntoa(struct nw_db_fib_entry *fib_entry)
+{
+	static char buf[INET6_ADDRSTRLEN];
+
+	if (fib_entry->family == AF_INET6) {
+		return (char *)inet_ntop(AF_INET6, &fib_entry->dest_ip6, buf, sizeof(buf));
+	}
+	return nw_inet_ntoa(fib_entry->dest_ip);
+}
+
+/**************************************************************************//**
+ * \brief       Get the FIB entries counter of the address family of fib_entry.
+ *              IPv4 and IPv6 entries are kept in separate TCAMs.
+ *
+ * \param[in]   fib_entry - reference to fib entry
+ *
+ * \return      reference to the entries counter
+ */
+uint32_t *nw_fib_entry_count(struct nw_db_fib_entry *fib_entry)
+{
+	return (fib_entry->family == AF_INET6) ? &fib6_entry_count : &fib_entry_count;
+}
+
 /**************************************************************************//**
  * \brief       Create internal DB
  *
@@ -116,9 +150,14 @@ enum nw_db_rc nw_db_init(void)
 	 * result_type
 	 * next_hop
 	 * nps_index
+	 * family
+	 * dest_ip6 - IPv6 entries only
+	 * next_hop6 - IPv6 entries only
 	 *
 	 * Key:
+	 * family
 	 * dest_ip
+	 * dest_ip6
 	 * mask_length
 	 */
 	sql = "CREATE TABLE fib_entries("
@@ -127,7 +166,10 @@ enum nw_db_rc nw_db_init(void)
 		"result_type INT NOT NULL,"
 		"next_hop INT NOT NULL,"
 		"nps_index INT NOT NULL,"
-		"PRIMARY KEY (dest_ip,mask_length));";
+		"family INT NOT NULL,"
+		"dest_ip6 TEXT NOT NULL,"
+		"next_hop6 TEXT NOT NULL,"
+		"PRIMARY KEY (family,dest_ip,dest_ip6,mask_length));";
 
 	/* Execute SQL statement */
 	rc = sqlite3_exec(nw_db, sql, NULL, NULL, &zErrMsg);
@@ -138,6 +180,7 @@ enum nw_db_rc nw_db_init(void)
 	}
 
 	fib_entry_count = 0;
+	fib6_entry_count = 0;
 
 	return NW_DB_OK;
 }
@@ -156,6 +199,53 @@ void nw_db_destroy(void)
 
 }
 
+/**************************************************************************//**
+ * \brief       IPv6 destination and next hop of fib_entry to strings kept in
+ *              internal DB. both are empty strings for IPv4 entries.
+ *
+ * \param[in]   fib_entry   - reference to fib entry
+ * \param[out]  dest_ip6    - destination IP string (INET6_ADDRSTRLEN)
+ * \param[out]  next_hop6   - next hop string (INET6_ADDRSTRLEN), can be NULL
+ *
+ * \return      none
+ */
+void internal_db_fib_entry_ip6_to_str(struct nw_db_fib_entry *fib_entry, char *dest_ip6, char *next_hop6)
+{
+	dest_ip6[0] = '\0';
+	if (next_hop6) {
+		next_hop6[0] = '\0';
+	}
+	if (fib_entry->family != AF_INET6) {
+		return;
+	}
+	inet_ntop(AF_INET6, &fib_entry->dest_ip6, dest_ip6, INET6_ADDRSTRLEN);
+	if (next_hop6) {
+		inet_ntop(AF_INET6, &fib_entry->next_hop6, next_hop6, INET6_ADDRSTRLEN);
+	}
+}
+
+/**************************************************************************//**
+ * \brief       Fill fib_entry from a row of fib_entries table
+ *
+ * \param[in]   statement   - SQL statement positioned on a row
+ * \param[out]  fib_entry   - reference to fib entry
+ *
+ * \return      none
+ */
+void internal_db_read_fib_entry(sqlite3_stmt *statement, struct nw_db_fib_entry *fib_entry)
+{
+	fib_entry->dest_ip = sqlite3_column_int(statement, 0);
+	fib_entry->mask_length = sqlite3_column_int(statement, 1);
+	fib_entry->result_type = (enum nw_fib_type)sqlite3_column_int(statement, 2);
+	fib_entry->next_hop = sqlite3_column_int(statement, 3);
+	fib_entry->nps_index = sqlite3_column_int(statement, 4);
+	fib_entry->family = sqlite3_column_int(statement, 5);
+	if (fib_entry->family == AF_INET6) {
+		inet_pton(AF_INET6, (const char *)sqlite3_column_text(statement, 6), &fib_entry->dest_ip6);
+		inet_pton(AF_INET6, (const char *)sqlite3_column_text(statement, 7), &fib_entry->next_hop6);
+	}
+}
+
 /**************************************************************************//**
  * \brief       Add a fib_entry to internal DB
  *
@@ -167,13 +257,17 @@ void nw_db_destroy(void)
 enum nw_db_rc internal_db_add_fib_entry(struct nw_db_fib_entry *fib_entry)
 {
 	int rc;
-	char sql[256];
+	char sql[512];
 	char *zErrMsg = NULL;
+	char dest_ip6[INET6_ADDRSTRLEN];
+	char next_hop6[INET6_ADDRSTRLEN];
 
+	internal_db_fib_entry_ip6_to_str(fib_entry, dest_ip6, next_hop6);
 	sprintf(sql, "INSERT INTO fib_entries "
-		"(dest_ip, mask_length, result_type, next_hop, nps_index) "
-		"VALUES (%d, %d, %d, %d, %d);",
-		fib_entry->dest_ip, fib_entry->mask_length, fib_entry->result_type, fib_entry->next_hop, fib_entry->nps_index);
+		"(dest_ip, mask_length, result_type, next_hop, nps_index, family, dest_ip6, next_hop6) "
+		"VALUES (%d, %d, %d, %d, %d, %d, '%s', '%s');",
+		fib_entry->dest_ip, fib_entry->mask_length, fib_entry->result_type, fib_entry->next_hop, fib_entry->nps_index,
+		fib_entry->family, dest_ip6, next_hop6);
 
 	/* Execute SQL statement */
 	rc = sqlite3_exec(nw_db, sql, NULL, NULL, &zErrMsg);
@@ -197,13 +291,17 @@ enum nw_db_rc internal_db_add_fib_entry(struct nw_db_fib_entry *fib_entry)
 enum nw_db_rc internal_db_modify_fib_entry(struct nw_db_fib_entry *fib_entry)
 {
 	int rc;
-	char sql[256];
+	char sql[512];
 	char *zErrMsg = NULL;
+	char dest_ip6[INET6_ADDRSTRLEN];
+	char next_hop6[INET6_ADDRSTRLEN];
 
+	internal_db_fib_entry_ip6_to_str(fib_entry, dest_ip6, next_hop6);
 	sprintf(sql, "UPDATE fib_entries "
-		"SET result_type=%d, next_hop=%d, nps_index=%d "
-		"WHERE dest_ip=%d AND mask_length=%d;",
-		fib_entry->result_type, fib_entry->next_hop, fib_entry->nps_index, fib_entry->dest_ip, fib_entry->mask_length);
+		"SET result_type=%d, next_hop=%d, nps_index=%d, next_hop6='%s' "
+		"WHERE family=%d AND dest_ip=%d AND dest_ip6='%s' AND mask_length=%d;",
+		fib_entry->result_type, fib_entry->next_hop, fib_entry->nps_index, next_hop6,
+		fib_entry->family, fib_entry->dest_ip, dest_ip6, fib_entry->mask_length);
 
 	/* Execute SQL statement */
 	rc = sqlite3_exec(nw_db, sql, NULL, NULL, &zErrMsg);
@@ -229,10 +327,12 @@ enum nw_db_rc internal_db_remove_fib_entry(struct nw_db_fib_entry *fib_entry)
 	int rc;
 	char sql[256];
 	char *zErrMsg = NULL;
+	char dest_ip6[INET6_ADDRSTRLEN];
 
+	internal_db_fib_entry_ip6_to_str(fib_entry, dest_ip6, NULL);
 	sprintf(sql, "DELETE FROM fib_entries "
-		"WHERE dest_ip=%d AND mask_length=%d;",
-		fib_entry->dest_ip, fib_entry->mask_length);
+		"WHERE family=%d AND dest_ip=%d AND dest_ip6='%s' AND mask_length=%d;",
+		fib_entry->family, fib_entry->dest_ip, dest_ip6, fib_entry->mask_length);
 
 	/* Execute SQL statement */
 	rc = sqlite3_exec(nw_db, sql, NULL, NULL, &zErrMsg);
@@ -259,10 +359,12 @@ enum nw_db_rc internal_db_get_fib_entry(struct nw_db_fib_entry *fib_entry)
 	int rc;
 	char sql[256];
 	sqlite3_stmt *statement;
+	char dest_ip6[INET6_ADDRSTRLEN];
 
+	internal_db_fib_entry_ip6_to_str(fib_entry, dest_ip6, NULL);
 	sprintf(sql, "SELECT * FROM fib_entries "
-		"WHERE dest_ip=%d AND mask_length=%d;",
-		fib_entry->dest_ip, fib_entry->mask_length);
+		"WHERE family=%d AND dest_ip=%d AND dest_ip6='%s' AND mask_length=%d;",
+		fib_entry->family, fib_entry->dest_ip, dest_ip6, fib_entry->mask_length);
 
 	/* Prepare SQL statement */
 	rc = sqlite3_prepare_v2(nw_db, sql, -1, &statement, NULL);
@@ -291,9 +393,7 @@ enum nw_db_rc internal_db_get_fib_entry(struct nw_db_fib_entry *fib_entry)
 	/* retrieve fib entry from result,
 	 * finalize SQL statement and return
 	 */
-	fib_entry->result_type = (enum nw_fib_type)sqlite3_column_int(statement, 2);
-	fib_entry->next_hop = sqlite3_column_int(statement, 3);
-	fib_entry->nps_index = sqlite3_column_int(statement, 4);
+	internal_db_read_fib_entry(statement, fib_entry);
 
 	sqlite3_finalize(statement);
 
@@ -338,6 +438,123 @@ void build_nps_fib_result(struct nw_db_fib_entry *cp_fib_entry,
 	nps_fib_result->result_type = cp_fib_entry->result_type;
 }
 
+/**************************************************************************//**
+ * \brief       build fib6 key and mask for NPS according to cp_fib_entry
+ *
+ * \param[in]   cp_fib_entry  - reference to cp fib entry
+ *              nps_fib6_key  - reference to nps fib6 key
+ *              nps_fib6_mask - reference to nps fib6 mask
+ *
+ * \return      none
+ */
+void build_nps_fib6_key_and_mask(struct nw_db_fib_entry *cp_fib_entry,
+				 struct nw_fib6_key *nps_fib6_key,
+				 struct nw_fib6_key *nps_fib6_mask)
+{
+	uint32_t i;
+
+	/* Mask for TCAM entry */
+	for (i = 0; i < cp_fib_entry->mask_length; i++) {
+		nps_fib6_mask->dest_ip.s6_addr[i / 8] |= 0x80 >> (i % 8);
+	}
+
+	nps_fib6_key->dest_ip = cp_fib_entry->dest_ip6;
+}
+
+/**************************************************************************//**
+ * \brief       build fib6 result for NPS according to cp_fib_entry.
+ *              gateway is kept in FIB6 GW entry with the index of the TCAM entry.
+ *
+ * \param[in]   cp_fib_entry    - reference to cp fib entry
+ *              nps_fib6_result - reference to nps fib6 result
+ *
+ * \return      none
+ */
+void build_nps_fib6_result(struct nw_db_fib_entry *cp_fib_entry,
+			   struct nw_fib6_result *nps_fib6_result)
+{
+	nps_fib6_result->gw_index = bswap_32(cp_fib_entry->nps_index);
+	nps_fib6_result->result_type = cp_fib_entry->result_type;
+}
+
+/**************************************************************************//**
+ * \brief       Add fib6 entry to NPS. gateway entry is written before the TCAM
+ *              entry which points to it.
+ *
+ * \param[in]   cp_fib_entry   - reference to fib entry
+ *
+ * \return      true  - success
+ *              false - fail
+ */
+bool add_fib6_entry_to_nps(struct nw_db_fib_entry *cp_fib_entry)
+{
+	struct nw_fib6_key nps_fib6_key;
+	struct nw_fib6_key nps_fib6_mask;
+	struct nw_fib6_result nps_fib6_result;
+	struct nw_fib6_gw_key nps_fib6_gw_key;
+	struct nw_fib6_gw_result nps_fib6_gw_result;
+
+	memset(&nps_fib6_key, 0, sizeof(nps_fib6_key));
+	memset(&nps_fib6_mask, 0, sizeof(nps_fib6_mask));
+	memset(&nps_fib6_result, 0, sizeof(nps_fib6_result));
+
+	if (cp_fib_entry->result_type == NW_FIB_GW) {
+		memset(&nps_fib6_gw_result, 0, sizeof(nps_fib6_gw_result));
+		nps_fib6_gw_key.gw_index = bswap_32(cp_fib_entry->nps_index);
+		nps_fib6_gw_result.gw_ip = cp_fib_entry->next_hop6;
+		if (infra_add_entry(STRUCT_ID_NW_FIB6_GW,
+				    &nps_fib6_gw_key,
+				    sizeof(struct nw_fib6_gw_key),
+				    &nps_fib6_gw_result,
+				    sizeof(struct nw_fib6_gw_result)) == false) {
+			return false;
+		}
+	}
+
+	/* Add entry to FIB6 TCAM table based on CP FIB entry */
+	build_nps_fib6_key_and_mask(cp_fib_entry, &nps_fib6_key, &nps_fib6_mask);
+	build_nps_fib6_result(cp_fib_entry, &nps_fib6_result);
+	return infra_add_tcam_entry(NW_FIB6_TCAM_SIDE,
+				    NW_FIB6_TCAM_TABLE,
+				    &nps_fib6_key,
+				    sizeof(struct nw_fib6_key),
+				    &nps_fib6_mask,
+				    cp_fib_entry->nps_index,
+				    &nps_fib6_result,
+				    sizeof(struct nw_fib6_result));
+}
+
+/**************************************************************************//**
+ * \brief       Delete fib6 entry from NPS. gateway entry is left as is, it is
+ *              overwritten by the next GW entry in the same index.
+ *
+ * \param[in]   cp_fib_entry   - reference to fib entry
+ *
+ * \return      true  - success
+ *              false - fail
+ */
+bool delete_fib6_entry_from_nps(struct nw_db_fib_entry *cp_fib_entry)
+{
+	struct nw_fib6_key nps_fib6_key;
+	struct nw_fib6_key nps_fib6_mask;
+	struct nw_fib6_result nps_fib6_result;
+
+	memset(&nps_fib6_key, 0, sizeof(nps_fib6_key));
+	memset(&nps_fib6_mask, 0, sizeof(nps_fib6_mask));
+	memset(&nps_fib6_result, 0, sizeof(nps_fib6_result));
+
+	build_nps_fib6_key_and_mask(cp_fib_entry, &nps_fib6_key, &nps_fib6_mask);
+	build_nps_fib6_result(cp_fib_entry, &nps_fib6_result);
+	return infra_delete_tcam_entry(NW_FIB6_TCAM_SIDE,
+				       NW_FIB6_TCAM_TABLE,
+				       &nps_fib6_key,
+				       sizeof(struct nw_fib6_key),
+				       &nps_fib6_mask,
+				       cp_fib_entry->nps_index,
+				       &nps_fib6_result,
+				       sizeof(struct nw_fib6_result));
+}
+
 /**************************************************************************//**
  * \brief       Add fib entry to NPS
  *
@@ -352,6 +569,10 @@ bool add_fib_entry_to_nps(struct nw_db_fib_entry *cp_fib_entry)
 	struct nw_fib_key nps_fib_mask;
 	struct nw_fib_result nps_fib_result;
 
+	if (cp_fib_entry->family == AF_INET6) {
+		return add_fib6_entry_to_nps(cp_fib_entry);
+	}
+
 	memset(&nps_fib_key, 0, sizeof(nps_fib_key));
 	memset(&nps_fib_mask, 0, sizeof(nps_fib_mask));
 	memset(&nps_fib_result, 0, sizeof(nps_fib_result));
@@ -383,6 +604,10 @@ bool delete_fib_entry_from_nps(struct nw_db_fib_entry *cp_fib_entry)
 	struct nw_fib_key nps_fib_mask;
 	struct nw_fib_result nps_fib_result;
 
+	if (cp_fib_entry->family == AF_INET6) {
+		return delete_fib6_entry_from_nps(cp_fib_entry);
+	}
+
 	memset(&nps_fib_key, 0, sizeof(nps_fib_key));
 	memset(&nps_fib_mask, 0, sizeof(nps_fib_mask));
 	memset(&nps_fib_result, 0, sizeof(nps_fib_result));
@@ -423,9 +648,9 @@ enum nw_db_rc fib_reorder_push_entries_up(struct nw_db_fib_entry *new_fib_entry)
 	write_log(LOG_DEBUG, "Reorder FIB table - push entries up.");
 
 	sprintf(sql, "SELECT * FROM fib_entries "
-		"WHERE mask_length < %d "
+		"WHERE family=%d AND mask_length < %d "
 		"ORDER BY nps_index DESC;",
-		new_fib_entry->mask_length);
+		new_fib_entry->family, new_fib_entry->mask_length);
 
 	/* Prepare SQL statement */
 	rc = sqlite3_prepare_v2(nw_db, sql, -1, &statement, NULL);
@@ -448,30 +673,26 @@ enum nw_db_rc fib_reorder_push_entries_up(struct nw_db_fib_entry *new_fib_entry)
 	if (rc == SQLITE_DONE) {
 		/* No entries were found - put new entry at the end */
 		write_log(LOG_DEBUG, "Reorder FIB table - no entries were found. put new entry at the end.");
-		new_fib_entry->nps_index = fib_entry_count;
+		new_fib_entry->nps_index = *nw_fib_entry_count(new_fib_entry);
 	} else {
 		/* Go over all FIB entries and move them one index up */
 		while (rc == SQLITE_ROW) {
-			tmp_fib_entry.dest_ip = sqlite3_column_int(statement, 0);
-			tmp_fib_entry.mask_length = sqlite3_column_int(statement, 1);
-			tmp_fib_entry.result_type = (enum nw_fib_type)sqlite3_column_int(statement, 2);
-			tmp_fib_entry.next_hop = sqlite3_column_int(statement, 3);
-			tmp_fib_entry.nps_index = sqlite3_column_int(statement, 4);
+			internal_db_read_fib_entry(statement, &tmp_fib_entry);
 			tmp_fib_entry.nps_index++;
 			write_log(LOG_DEBUG, "Reorder FIB table - move entry (%s:%d) to index %d.",
-				  nw_inet_ntoa(tmp_fib_entry.dest_ip), tmp_fib_entry.mask_length, tmp_fib_entry.nps_index);
+				  nw_fib_entry_ntoa(&tmp_fib_entry), tmp_fib_entry.mask_length, tmp_fib_entry.nps_index);
 
 			/* Update DBs */
 			if (internal_db_modify_fib_entry(&tmp_fib_entry) == NW_DB_INTERNAL_ERROR) {
 				/* Internal error */
 				write_log(LOG_CRIT, "Failed to update FIB entry (IP=%s, mask length=%d) (internal error).",
-					  nw_inet_ntoa(tmp_fib_entry.dest_ip), tmp_fib_entry.mask_length);
+					  nw_fib_entry_ntoa(&tmp_fib_entry), tmp_fib_entry.mask_length);
 				return NW_DB_INTERNAL_ERROR;
 
 			}
 			if (add_fib_entry_to_nps(&tmp_fib_entry) == false) {
 				write_log(LOG_CRIT, "Failed to update FIB entry (IP=%s, mask length=%d) in NPS.",
-					  nw_inet_ntoa(tmp_fib_entry.dest_ip), tmp_fib_entry.mask_length);
+					  nw_fib_entry_ntoa(&tmp_fib_entry), tmp_fib_entry.mask_length);
 				return NW_DB_NPS_ERROR;
 			}
 			rc = sqlite3_step(statement);
@@ -512,9 +733,9 @@ enum nw_db_rc fib_reorder_push_entries_down(struct nw_db_fib_entry *fib_entry)
 	write_log(LOG_DEBUG, "Reorder FIB table - push entries down.");
 
 	sprintf(sql, "SELECT * FROM fib_entries "
-		"WHERE nps_index > %d "
+		"WHERE family=%d AND nps_index > %d "
 		"ORDER BY nps_index ASC;",
-		fib_entry->nps_index);
+		fib_entry->family, fib_entry->nps_index);
 
 	/* Prepare SQL statement */
 	rc = sqlite3_prepare_v2(nw_db, sql, -1, &statement, NULL);
@@ -536,25 +757,21 @@ enum nw_db_rc fib_reorder_push_entries_down(struct nw_db_fib_entry *fib_entry)
 
 	/* Go over all FIB entries and move them one index down */
 	while (rc == SQLITE_ROW) {
-		tmp_fib_entry.dest_ip = sqlite3_column_int(statement, 0);
-		tmp_fib_entry.mask_length = sqlite3_column_int(statement, 1);
-		tmp_fib_entry.result_type = (enum nw_fib_type)sqlite3_column_int(statement, 2);
-		tmp_fib_entry.next_hop = sqlite3_column_int(statement, 3);
-		tmp_fib_entry.nps_index = sqlite3_column_int(statement, 4);
+		internal_db_read_fib_entry(statement, &tmp_fib_entry);
 		tmp_fib_entry.nps_index--;
 		write_log(LOG_DEBUG, "Reorder FIB table - move entry (%s:%d) to index %d.",
-			nw_inet_ntoa(tmp_fib_entry.dest_ip), tmp_fib_entry.mask_length, tmp_fib_entry.nps_index);
+			nw_fib_entry_ntoa(&tmp_fib_entry), tmp_fib_entry.mask_length, tmp_fib_entry.nps_index);
 		/* Update DBs */
 		if (internal_db_modify_fib_entry(&tmp_fib_entry) == NW_DB_INTERNAL_ERROR) {
 			/* Internal error */
 			write_log(LOG_CRIT, "Failed to update FIB entry (IP=%s, mask length=%d) (internal error).",
-				  nw_inet_ntoa(tmp_fib_entry.dest_ip), tmp_fib_entry.mask_length);
+				  nw_fib_entry_ntoa(&tmp_fib_entry), tmp_fib_entry.mask_length);
 			return NW_DB_INTERNAL_ERROR;
 
 		}
 		if (add_fib_entry_to_nps(&tmp_fib_entry) == false) {
 			write_log(LOG_CRIT, "Failed to update FIB entry (IP=%s, mask length=%d) in NPS.",
-				  nw_inet_ntoa(tmp_fib_entry.dest_ip), tmp_fib_entry.mask_length);
+				  nw_fib_entry_ntoa(&tmp_fib_entry), tmp_fib_entry.mask_length);
 			return NW_DB_NPS_ERROR;
 		}
 		rc = sqlite3_step(statement);
@@ -568,7 +785,7 @@ enum nw_db_rc fib_reorder_push_entries_down(struct nw_db_fib_entry *fib_entry)
 	sqlite3_finalize(statement);
 
 	/* Update index of current entry to last index for deletion */
-	fib_entry->nps_index = fib_entry_count - 1;
+	fib_entry->nps_index = *nw_fib_entry_count(fib_entry) - 1;
 
 	return NW_DB_OK;
 }
@@ -595,12 +812,17 @@ void set_fib_params(struct rtnl_route *route_entry, struct nw_db_fib_entry *fib_
 				/* Drop packet - DP will handle only single hop entries */
 				fib_entry->result_type = NW_FIB_DROP;
 				write_log(LOG_WARNING, "FIB entry (IP=%s, mask length=%d) has multiple hops - marked for drop.",
-					  nw_inet_ntoa(fib_entry->dest_ip), fib_entry->mask_length);
+					  nw_fib_entry_ntoa(fib_entry), fib_entry->mask_length);
 			} else {
 				/* Take next hop */
-				fib_entry->next_hop = *(uint32_t *)nl_addr_get_binary_addr(next_hop_addr);
 				fib_entry->result_type = NW_FIB_GW;
-				write_log(LOG_DEBUG, "FIB Entry is GW. next hop is %s", nw_inet_ntoa(fib_entry->next_hop));
+				if (fib_entry->family == AF_INET6) {
+					memcpy(&fib_entry->next_hop6, nl_addr_get_binary_addr(next_hop_addr), sizeof(struct in6_addr));
+					write_log(LOG_DEBUG, "FIB Entry is GW (IPv6).");
+				} else {
+					fib_entry->next_hop = *(uint32_t *)nl_addr_get_binary_addr(next_hop_addr);
+					write_log(LOG_DEBUG, "FIB Entry is GW. next hop is %s", nw_inet_ntoa(fib_entry->next_hop));
+				}
 			}
 		}
 	} else {
@@ -611,6 +833,28 @@ void set_fib_params(struct rtnl_route *route_entry, struct nw_db_fib_entry *fib_
 
 }
 
+/**************************************************************************//**
+ * \brief       Set fib entry key (family, destination and mask length)
+ *              according to route entry
+ *
+ * \param[in]   route_entry   - reference to route entry
+ *              fib_entry     - reference to fib entry
+ *
+ * \return      none
+ */
+void set_fib_key(struct rtnl_route *route_entry, struct nw_db_fib_entry *fib_entry)
+{
+	struct nl_addr *dst = rtnl_route_get_dst(route_entry);
+
+	fib_entry->family = rtnl_route_get_family(route_entry);
+	fib_entry->mask_length = (uint32_t)nl_addr_get_prefixlen(dst);
+	if (fib_entry->family == AF_INET6) {
+		memcpy(&fib_entry->dest_ip6, nl_addr_get_binary_addr(dst), sizeof(struct in6_addr));
+	} else {
+		fib_entry->dest_ip = *(uint32_t *)nl_addr_get_binary_addr(dst);
+	}
+}
+
 /**************************************************************************//**
  * \brief       Add a fib_entry to NW DB
  *
@@ -624,21 +868,18 @@ void set_fib_params(struct rtnl_route *route_entry, struct nw_db_fib_entry *fib_
 enum nw_db_rc nw_db_add_fib_entry(struct rtnl_route *route_entry, bool reorder)
 {
 	struct nw_db_fib_entry cp_fib_entry;
-	struct nl_addr *dst;
 
 	memset(&cp_fib_entry, 0, sizeof(cp_fib_entry));
 
-	dst = rtnl_route_get_dst(route_entry);
-	cp_fib_entry.mask_length = (uint32_t)nl_addr_get_prefixlen(dst);
-	cp_fib_entry.dest_ip = *(uint32_t *)nl_addr_get_binary_addr(dst);
+	set_fib_key(route_entry, &cp_fib_entry);
 	write_log(LOG_DEBUG, "Adding FIB entry. (IP=%s, mask length=%d) ",
-		  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+		  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 
 	switch (internal_db_get_fib_entry(&cp_fib_entry)) {
 	case NW_DB_OK:
 		/* FIB entry already exists */
 		write_log(LOG_NOTICE, "Can't add FIB entry. Entry (IP=%s, mask length=%d) already exists.",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		return NW_DB_FAILURE;
 	case NW_DB_INTERNAL_ERROR:
 		/* Internal error */
@@ -647,15 +888,16 @@ enum nw_db_rc nw_db_add_fib_entry(struct rtnl_route *route_entry, bool reorder)
 	case NW_DB_FAILURE:
 		/* FIB entry doesn't exist in NW DB */
 		write_log(LOG_DEBUG, "FIB entry (IP=%s, mask length=%d) doesn't exist in DB",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		break;
 	default:
 		return NW_DB_INTERNAL_ERROR;
 	}
 	/* Check we do not pass the TCAM limit size */
-	if (fib_entry_count == NW_FIB_TCAM_MAX_SIZE) {
+	if (*nw_fib_entry_count(&cp_fib_entry) ==
+	    ((cp_fib_entry.family == AF_INET6) ? NW_FIB6_TCAM_MAX_SIZE : NW_FIB_TCAM_MAX_SIZE)) {
 		write_log(LOG_ERR, "Can't add FIB entry (IP=%s, mask length=%d). out of memory.",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		return NW_DB_INTERNAL_ERROR;
 	}
 
@@ -667,30 +909,30 @@ enum nw_db_rc nw_db_add_fib_entry(struct rtnl_route *route_entry, bool reorder)
 
 		if (rc != NW_DB_OK) {
 			write_log(LOG_CRIT, "Failed to add FIB entry (IP=%s, mask length=%d).",
-				  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+				  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 			return rc;
 		}
 	} else {
 		/* Insert entry at the end (next free entry) */
-		cp_fib_entry.nps_index = fib_entry_count;
+		cp_fib_entry.nps_index = *nw_fib_entry_count(&cp_fib_entry);
 	}
 	/* Add new entry to DBs */
 	if (internal_db_add_fib_entry(&cp_fib_entry) == NW_DB_INTERNAL_ERROR) {
 		/* Internal error */
 		write_log(LOG_CRIT, "Failed to add FIB entry (IP=%s, mask length=%d) (internal error).",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		return NW_DB_INTERNAL_ERROR;
 
 	}
 	if (add_fib_entry_to_nps(&cp_fib_entry) == false) {
 		write_log(LOG_CRIT, "Failed to add FIB entry (IP=%s, mask length=%d) to NPS.",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		return NW_DB_NPS_ERROR;
 	}
-	fib_entry_count++;
+	(*nw_fib_entry_count(&cp_fib_entry))++;
 
 	write_log(LOG_DEBUG, "FIB entry Added successfully. (IP=%s, mask length=%d, nps_index=%d, result_type=%d) ",
-		  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length, cp_fib_entry.nps_index, cp_fib_entry.result_type);
+		  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length, cp_fib_entry.nps_index, cp_fib_entry.result_type);
 
 	return NW_DB_OK;
 }
@@ -708,18 +950,15 @@ enum nw_db_rc nw_db_add_fib_entry(struct rtnl_route *route_entry, bool reorder)
 enum nw_db_rc nw_db_delete_fib_entry(struct rtnl_route *route_entry)
 {
 	struct nw_db_fib_entry cp_fib_entry;
-	struct nl_addr *dst;
 
 	memset(&cp_fib_entry, 0, sizeof(cp_fib_entry));
-	dst = rtnl_route_get_dst(route_entry);
-	cp_fib_entry.mask_length = (uint32_t)nl_addr_get_prefixlen(dst);
-	cp_fib_entry.dest_ip = *(uint32_t *)nl_addr_get_binary_addr(dst);
+	set_fib_key(route_entry, &cp_fib_entry);
 
 	switch (internal_db_get_fib_entry(&cp_fib_entry)) {
 	case NW_DB_OK:
 		/* FIB entry exists */
 		write_log(LOG_DEBUG, "FIB entry (IP=%s, mask length=%d, index=%d) found in internal DB",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length, cp_fib_entry.nps_index);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length, cp_fib_entry.nps_index);
 		break;
 	case NW_DB_INTERNAL_ERROR:
 		/* Internal error */
@@ -728,45 +967,45 @@ enum nw_db_rc nw_db_delete_fib_entry(struct rtnl_route *route_entry)
 	case NW_DB_FAILURE:
 		/* FIB entry doesn't exist in NW DB */
 		write_log(LOG_NOTICE, "Can't delete FIB entry. Entry (IP=%s, mask length=%d) doesn't exist.",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		return NW_DB_FAILURE;
 	default:
 		return NW_DB_INTERNAL_ERROR;
 	}
 
 	/* move entries if needed */
-	if (cp_fib_entry.nps_index != fib_entry_count - 1) {
+	if (cp_fib_entry.nps_index != *nw_fib_entry_count(&cp_fib_entry) - 1) {
 		/* not last entry - need to move entries down */
 		enum nw_db_rc rc = fib_reorder_push_entries_down(&cp_fib_entry);
 
 		if (rc != NW_DB_OK) {
 			write_log(LOG_CRIT, "Failed to delete FIB entry (IP=%s, mask length=%d).",
-				  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+				  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 			return rc;
 		}
 	}
 
-	fib_entry_count--;
+	(*nw_fib_entry_count(&cp_fib_entry))--;
 
 	write_log(LOG_DEBUG, "Remove FIB entry (IP=%s, mask length=%d) from index %d",
-		  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length, cp_fib_entry.nps_index);
+		  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length, cp_fib_entry.nps_index);
 
 	/* Delete last entry from DBs */
 	if (internal_db_remove_fib_entry(&cp_fib_entry) == NW_DB_INTERNAL_ERROR) {
 		/* Internal error */
 		write_log(LOG_CRIT, "Failed to delete FIB entry (IP=%s, mask length=%d) (internal error).",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		return NW_DB_INTERNAL_ERROR;
 
 	}
 	if (delete_fib_entry_from_nps(&cp_fib_entry) == false) {
 		write_log(LOG_CRIT, "Failed to delete FIB entry (IP=%s, mask length=%d) from NPS.",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		return NW_DB_NPS_ERROR;
 	}
 
 	write_log(LOG_DEBUG, "FIB entry (IP=%s, mask length=%d) deleted successfully.",
-		  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+		  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 	return NW_DB_OK;
 }
 
@@ -783,18 +1022,15 @@ enum nw_db_rc nw_db_delete_fib_entry(struct rtnl_route *route_entry)
 enum nw_db_rc nw_db_modify_fib_entry(struct rtnl_route *route_entry)
 {
 	struct nw_db_fib_entry cp_fib_entry;
-	struct nl_addr *dst;
 
 	memset(&cp_fib_entry, 0, sizeof(cp_fib_entry));
-	dst = rtnl_route_get_dst(route_entry);
-	cp_fib_entry.mask_length = (uint32_t)nl_addr_get_prefixlen(dst);
-	cp_fib_entry.dest_ip = *(uint32_t *)nl_addr_get_binary_addr(dst);
+	set_fib_key(route_entry, &cp_fib_entry);
 
 	switch (internal_db_get_fib_entry(&cp_fib_entry)) {
 	case NW_DB_OK:
 		/* FIB entry exists */
 		write_log(LOG_DEBUG, "FIB entry (IP=%s, mask length=%d, index=%d) found in internal DB",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length, cp_fib_entry.nps_index);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length, cp_fib_entry.nps_index);
 		break;
 	case NW_DB_INTERNAL_ERROR:
 		/* Internal error */
@@ -803,7 +1039,7 @@ enum nw_db_rc nw_db_modify_fib_entry(struct rtnl_route *route_entry)
 	case NW_DB_FAILURE:
 		/* FIB entry doesn't exist in NW DB */
 		write_log(LOG_NOTICE, "Can't modify FIB entry. Entry (IP=%s, mask length=%d) doesn't exist.",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		return NW_DB_FAILURE;
 	default:
 		return NW_DB_INTERNAL_ERROR;
@@ -815,18 +1051,18 @@ enum nw_db_rc nw_db_modify_fib_entry(struct rtnl_route *route_entry)
 	if (internal_db_modify_fib_entry(&cp_fib_entry) == NW_DB_INTERNAL_ERROR) {
 		/* Internal error */
 		write_log(LOG_CRIT, "Failed to modify FIB entry (IP=%s, mask length=%d) (internal error).",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		return NW_DB_INTERNAL_ERROR;
 
 	}
 	if (add_fib_entry_to_nps(&cp_fib_entry) == false) {
 		write_log(LOG_CRIT, "Failed to modify FIB entry (IP=%s, mask length=%d) in NPS.",
-			  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+			  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 		return NW_DB_NPS_ERROR;
 	}
 
 	write_log(LOG_DEBUG, "FIB entry (IP=%s, mask length=%d) modified successfully.",
-		  nw_inet_ntoa(cp_fib_entry.dest_ip), cp_fib_entry.mask_length);
+		  nw_fib_entry_ntoa(&cp_fib_entry), cp_fib_entry.mask_length);
 	return NW_DB_OK;
 }
 
@@ -52,6 +52,9 @@
 #include <netlink/fib_lookup/request.h>
 #include <netlink/fib_lookup/lookup.h>
 
+/* EZchip includes */
+#include <EZapiPrm.h>
+
 /* Project includes */
 #include "log.h"
 #include "defs.h"
@@ -75,16 +78,21 @@ void nw_db_manager_fib_cb(struct nl_cache *cache, struct nl_object *obj,
 
 void neighbor_to_arp_entry(struct rtnl_neigh *neighbor, struct nw_arp_key *key,
 			   struct nw_arp_result *result);
+void neighbor_to_arp6_entry(struct rtnl_neigh *neighbor, struct nw_arp6_key *key,
+			    struct nw_arp_result *result);
+bool valid_family(int family);
 char *addr_to_str(struct nl_addr *addr);
 void add_entry_to_arp_table(struct rtnl_neigh *neighbor);
 void remove_entry_from_arp_table(struct rtnl_neigh *neighbor);
 bool valid_neighbor(struct rtnl_neigh *neighbor);
 bool valid_route_entry(struct rtnl_route *route_entry);
+void nw_db_manager_bump_route_gen(void);
 
 /* Globals Definition */
 struct nl_cache_mngr *network_cache_mngr;
 
 bool *nw_db_manager_cancel_application_flag;
+uint32_t nw_db_manager_route_gen;
 
 #define NW_DB_MANAGER_NEIGHBOR_FILTERED_STATE \
 	(NUD_INCOMPLETE | NUD_FAILED | NUD_NOARP)
@@ -155,6 +163,8 @@ void nw_db_manager_delete(void)
  */
 void nw_db_manager_table_init(void)
 {
+	nw_db_manager_route_gen = 0;
+	nw_db_manager_bump_route_gen();
 	nw_db_manager_if_table_init();
 	nw_db_manager_fib_table_init();
 	nw_db_manager_arp_table_init();
@@ -228,10 +238,11 @@ void nw_db_manager_if_table_init(void)
  */
 void nw_db_manager_fib_table_init(void)
 {
-	int ret;
+	int ret, i;
 	struct nl_cache *filtered_route_cache;
 	struct nl_cache *route_cache;
-	struct rtnl_route *route_entry = rtnl_route_alloc();
+	struct rtnl_route *route_entry;
+	int families[] = {AF_INET, AF_INET6};
 
 	ret = nl_cache_mngr_add(network_cache_mngr, "route/route", &nw_db_manager_fib_cb, NULL, &route_cache);
 	if (ret < 0) {
@@ -239,31 +250,32 @@ void nw_db_manager_fib_table_init(void)
 		nw_db_manager_exit_with_error();
 	}
 
-	/* Take only IPv4 entries.
-	 * TODO: when adding IPv6 capabilities, this should be revisited.
-	 */
-	rtnl_route_set_family(route_entry, AF_INET);
-	filtered_route_cache = nl_cache_subset(route_cache, (struct nl_object *)route_entry);
-
-	/* Iterate on route cache */
-	route_entry = (struct rtnl_route *)nl_cache_get_first(filtered_route_cache);
-	while (route_entry != NULL) {
-		if (valid_route_entry(route_entry)) {
-			/* Add route to FIB table */
-			switch (nw_db_add_fib_entry(route_entry, true)) {
-			case NW_DB_OK:
-				break;
-			case NW_DB_INTERNAL_ERROR:
-			case NW_DB_NPS_ERROR:
-				write_log(LOG_CRIT, "Received fatal error from DBs when adding FIB entry: addr = %s .exiting.", addr_to_str(rtnl_route_get_dst(route_entry)));
-				nw_db_manager_exit_with_error();
-				break;
-			default:
-				write_log(LOG_NOTICE, "Problem adding FIB entry: addr = %s", addr_to_str(rtnl_route_get_dst(route_entry)));
+	/* Take IPv4 entries and then IPv6 entries, each family has its own FIB */
+	for (i = 0; i < (int)(sizeof(families) / sizeof(families[0])); i++) {
+		route_entry = rtnl_route_alloc();
+		rtnl_route_set_family(route_entry, families[i]);
+		filtered_route_cache = nl_cache_subset(route_cache, (struct nl_object *)route_entry);
+
+		/* Iterate on route cache */
+		route_entry = (struct rtnl_route *)nl_cache_get_first(filtered_route_cache);
+		while (route_entry != NULL) {
+			if (valid_route_entry(route_entry)) {
+				/* Add route to FIB table */
+				switch (nw_db_add_fib_entry(route_entry, true)) {
+				case NW_DB_OK:
+					break;
+				case NW_DB_INTERNAL_ERROR:
+				case NW_DB_NPS_ERROR:
+					write_log(LOG_CRIT, "Received fatal error from DBs when adding FIB entry: addr = %s .exiting.", addr_to_str(rtnl_route_get_dst(route_entry)));
+					nw_db_manager_exit_with_error();
+					break;
+				default:
+					write_log(LOG_NOTICE, "Problem adding FIB entry: addr = %s", addr_to_str(rtnl_route_get_dst(route_entry)));
+				}
 			}
+			/* Next route */
+			route_entry = (struct rtnl_route *)nl_cache_get_next((struct nl_object *)route_entry);
 		}
-		/* Next route */
-		route_entry = (struct rtnl_route *)nl_cache_get_next((struct nl_object *)route_entry);
 	}
 }
 /******************************************************************************
@@ -277,8 +289,9 @@ void nw_db_manager_arp_table_init(void)
 {
 	int ret, i;
 	struct nl_cache *neighbor_cache;
-	struct rtnl_neigh *neighbor = rtnl_neigh_alloc();
+	struct rtnl_neigh *neighbor;
 	struct nl_cache *filtered_neighbor_cache;
+	int families[] = {AF_INET, AF_INET6};
 
 	/* Allocate neighbor (ARP) cache */
 	ret = nl_cache_mngr_add(network_cache_mngr, "route/neigh", &nw_db_manager_arp_cb, NULL, &neighbor_cache);
@@ -286,21 +299,22 @@ void nw_db_manager_arp_table_init(void)
 		write_log(LOG_CRIT, "Unable to add cache route/neigh: %s", nl_geterror(ret));
 		nw_db_manager_exit_with_error();
 	}
-	/* Take only IPv4 entries.
-	 * TODO: when adding IPv6 capabilities, this should be revisited.
-	 */
-	rtnl_neigh_set_family(neighbor, AF_INET);
-	filtered_neighbor_cache = nl_cache_subset(neighbor_cache, (struct nl_object *)neighbor);
-
-	/* Iterate on neighbor cache */
-	neighbor = (struct rtnl_neigh *)nl_cache_get_first(filtered_neighbor_cache);
-	for (i = 0; neighbor != NULL; i++) {
-		if (valid_neighbor(neighbor)) {
-			/* Add neighbor to table */
-			add_entry_to_arp_table(neighbor);
+	/* Take IPv4 entries (ARP) and IPv6 entries (ND) */
+	for (i = 0; i < (int)(sizeof(families) / sizeof(families[0])); i++) {
+		neighbor = rtnl_neigh_alloc();
+		rtnl_neigh_set_family(neighbor, families[i]);
+		filtered_neighbor_cache = nl_cache_subset(neighbor_cache, (struct nl_object *)neighbor);
+
+		/* Iterate on neighbor cache */
+		neighbor = (struct rtnl_neigh *)nl_cache_get_first(filtered_neighbor_cache);
+		while (neighbor != NULL) {
+			if (valid_neighbor(neighbor)) {
+				/* Add neighbor to table */
+				add_entry_to_arp_table(neighbor);
+			}
+			/* Next neighbor */
+			neighbor = (struct rtnl_neigh *)nl_cache_get_next((struct nl_object *)neighbor);
 		}
-		/* Next neighbor */
-		neighbor = (struct rtnl_neigh *)nl_cache_get_next((struct nl_object *)neighbor);
 	}
 }
 
@@ -314,10 +328,8 @@ void nw_db_manager_fib_cb(struct nl_cache __attribute__((__unused__))*cache, str
 {
 	struct rtnl_route *route_entry = (struct rtnl_route *)obj;
 	enum nw_db_rc nw_ret = NW_DB_OK;
-	/* Take only IPv4 entries.
-	 * TODO: when adding IPv6 capabilities, this should be revisited.
-	 */
-	if (rtnl_route_get_family(route_entry) == AF_INET) {
+	/* Take only IPv4 & IPv6 entries */
+	if (valid_family(rtnl_route_get_family(route_entry))) {
 		switch (action) {
 		case NL_ACT_NEW:
 			write_log(LOG_DEBUG, "FIB ADD entry: %s", addr_to_str(rtnl_route_get_dst(route_entry)));
@@ -352,6 +364,7 @@ void nw_db_manager_fib_cb(struct nl_cache __attribute__((__unused__))*cache, str
 			write_log(LOG_CRIT, "Received fatal error from NW DBs. exiting.");
 			nw_db_manager_exit_with_error();
 		}
+		nw_db_manager_bump_route_gen();
 
 	} else {
 		switch (action) {
@@ -376,10 +389,8 @@ void nw_db_manager_fib_cb(struct nl_cache __attribute__((__unused__))*cache, str
 void nw_db_manager_arp_cb(struct nl_cache __attribute__((__unused__))*cache, struct nl_object *obj, int action, void __attribute__((__unused__))*data)
 {
 	struct rtnl_neigh *neighbor = (struct rtnl_neigh *)obj;
-	/* Take only IPv4 entries.
-	 * TODO: when adding IPv6 capabilities, this should be revisited.
-	 */
-	if (rtnl_neigh_get_family(neighbor) == AF_INET) {
+	/* Take only IPv4 & IPv6 entries */
+	if (valid_family(rtnl_neigh_get_family(neighbor))) {
 		switch (action) {
 		case NL_ACT_NEW:
 			if (valid_neighbor(neighbor)) {
@@ -397,6 +408,7 @@ void nw_db_manager_arp_cb(struct nl_cache __attribute__((__unused__))*cache, str
 			}
 			break;
 		}
+		nw_db_manager_bump_route_gen();
 
 	} else {
 		switch (action) {
@@ -430,6 +442,21 @@ void neighbor_to_arp_entry(struct rtnl_neigh *neighbor, struct nw_arp_key *key,
 	}
 }
 
+/******************************************************************************
+ * \brief    translate Linux IPv6 neighbor entry to ARP6 table key & result
+ *
+ * \return   void
+ */
+void neighbor_to_arp6_entry(struct rtnl_neigh *neighbor, struct nw_arp6_key *key, struct nw_arp_result *result)
+{
+	if (key) {
+		memcpy(&key->real_server_address, nl_addr_get_binary_addr(rtnl_neigh_get_dst(neighbor)), sizeof(struct in6_addr));
+	}
+	if (result) {
+		neighbor_to_arp_entry(neighbor, NULL, result);
+	}
+}
+
 /******************************************************************************
  * \brief    a helper function for nl address print
  *
@@ -457,8 +484,17 @@ void add_entry_to_arp_table(struct rtnl_neigh *neighbor)
 {
 	struct nw_arp_result result;
 	struct nw_arp_key key;
+	struct nw_arp6_key key6;
 
 	write_log(LOG_DEBUG, "Add neighbor to table    IP = %s MAC = %s", addr_to_str(rtnl_neigh_get_dst(neighbor)), addr_to_str(rtnl_neigh_get_lladdr(neighbor)));
+	if (rtnl_neigh_get_family(neighbor) == AF_INET6) {
+		neighbor_to_arp6_entry(neighbor, &key6, &result);
+		if (!infra_add_entry(STRUCT_ID_NW_ARP6, &key6, sizeof(key6), &result, sizeof(result))) {
+			write_log(LOG_ERR, "Cannot add entry to ARP6 table key= %s", addr_to_str(rtnl_neigh_get_dst(neighbor)));
+			nw_db_manager_exit_with_error();
+		}
+		return;
+	}
 	neighbor_to_arp_entry(neighbor, &key, &result);
 	if (!infra_add_entry(STRUCT_ID_NW_ARP, &key, sizeof(key), &result, sizeof(result))) {
 		write_log(LOG_ERR, "Cannot add entry to ARP table key= 0x%X08 result= %02x:%02x:%02x:%02x:%02x:%02x", key.real_server_address,  result.dest_mac_addr.ether_addr_octet[0], result.dest_mac_addr.ether_addr_octet[1], result.dest_mac_addr.ether_addr_octet[2], result.dest_mac_addr.ether_addr_octet[3], result.dest_mac_addr.ether_addr_octet[4], result.dest_mac_addr.ether_addr_octet[5]);
@@ -476,8 +512,17 @@ void add_entry_to_arp_table(struct rtnl_neigh *neighbor)
 void remove_entry_from_arp_table(struct rtnl_neigh *neighbor)
 {
 	struct nw_arp_key key;
+	struct nw_arp6_key key6;
 
 	write_log(LOG_DEBUG, "Delete neighbor from table IP = %s MAC = %s", addr_to_str(rtnl_neigh_get_dst(neighbor)), addr_to_str(rtnl_neigh_get_lladdr(neighbor)));
+	if (rtnl_neigh_get_family(neighbor) == AF_INET6) {
+		neighbor_to_arp6_entry(neighbor, &key6, NULL);
+		if (!infra_delete_entry(STRUCT_ID_NW_ARP6, &key6, sizeof(key6))) {
+			write_log(LOG_ERR, "Cannot remove entry from ARP6 table key= %s", addr_to_str(rtnl_neigh_get_dst(neighbor)));
+			nw_db_manager_exit_with_error();
+		}
+		return;
+	}
 	neighbor_to_arp_entry(neighbor, &key, NULL);
 	if (!infra_delete_entry(STRUCT_ID_NW_ARP, &key, sizeof(key))) {
 		write_log(LOG_ERR, "Cannot remove entry from ARP table key= 0x%X08", key.real_server_address);
@@ -485,6 +530,49 @@ void remove_entry_from_arp_table(struct rtnl_neigh *neighbor)
 	}
 }
 
+/******************************************************************************
+ * \brief    Increments route generation and writes it to NPS memory.
+ *           DP next hop entries which were resolved in previous generation
+ *           are treated as invalid and resolved again by FIB & ARP lookups.
+ *           If an error is received from CP, exits the application.
+ *
+ * \return   void
+ */
+void nw_db_manager_bump_route_gen(void)
+{
+	EZstatus ret_val;
+	uint32_t nps_route_gen;
+
+	nw_db_manager_route_gen++;
+	nps_route_gen = bswap_32(nw_db_manager_route_gen);
+	write_log(LOG_DEBUG, "Route generation changed to %d", nw_db_manager_route_gen);
+
+	ret_val = EZapiPrm_WriteMem(0, /*uiChannelId*/
+				    EZapiPrm_MemId_EXT_MEM, /*eMemId*/
+				    infra_from_msid_to_index(1, EMEM_NW_ROUTE_GEN_MSID),
+				    EMEM_NW_ROUTE_GEN_OFFSET_CP,
+				    0, /* uiMSBAddress */
+				    0, /* bRange */
+				    0, /* uiRangeSize */
+				    0, /* uiRangeStep */
+				    0, /* bSingleCopy */
+				    0, /* bGCICopy */
+				    0, /* uiCopyIndex */
+				    sizeof(nps_route_gen),
+				    (EZuc8 *)&nps_route_gen, /*pucData*/
+				    0 /* pSpecialParams */);
+
+	if (EZrc_IS_ERROR(ret_val)) {
+		write_log(LOG_CRIT, "nw_db_manager_bump_route_gen: EZapiPrm_WriteMem failed.");
+		nw_db_manager_exit_with_error();
+	}
+}
+
+bool valid_family(int family)
+{
+	return (family == AF_INET || family == AF_INET6);
+}
+
 bool valid_route_entry(struct rtnl_route *route_entry)
 {
 	return (rtnl_route_get_table(route_entry) == RT_TABLE_MAIN);
@@ -514,7 +602,7 @@ bool nw_db_constructor(void)
 
 	hash_params.key_size = sizeof(struct nw_arp_key);
 	hash_params.result_size = sizeof(struct nw_arp_result);
-	hash_params.max_num_of_entries = 65536;  /* TODO - define? */
+	hash_params.max_num_of_entries = NW_ARP_MAX_ENTRIES;
 	hash_params.hash_size = 0;
 	hash_params.updated_from_dp = false;
 	hash_params.main_table_search_mem_heap = INFRA_EMEM_SEARCH_HASH_HEAP;
@@ -541,6 +629,63 @@ bool nw_db_constructor(void)
 		return false;
 	}
 
+	write_log(LOG_DEBUG, "Creating ARP6 table.");
+
+	hash_params.key_size = sizeof(struct nw_arp6_key);
+	hash_params.result_size = sizeof(struct nw_arp_result);
+	hash_params.max_num_of_entries = NW_ARP6_MAX_ENTRIES;
+	hash_params.hash_size = 0;
+	hash_params.updated_from_dp = false;
+	hash_params.main_table_search_mem_heap = INFRA_EMEM_SEARCH_HASH_HEAP;
+	hash_params.sig_table_search_mem_heap = INFRA_EMEM_SEARCH_HASH_HEAP;
+	hash_params.res_table_search_mem_heap = INFRA_EMEM_SEARCH_1_TABLE_HEAP;
+	if (infra_create_hash(STRUCT_ID_NW_ARP6,
+			      &hash_params) == false) {
+		write_log(LOG_CRIT, "Error - Failed creating ARP6 table.");
+		return false;
+	}
+
+	write_log(LOG_DEBUG, "Creating FIB6 table.");
+
+	tcam_params.key_size = sizeof(struct nw_fib6_key);
+	tcam_params.max_num_of_entries = NW_FIB6_TCAM_MAX_SIZE;
+	tcam_params.profile = NW_FIB6_TCAM_PROFILE;
+	tcam_params.result_size = sizeof(struct nw_fib6_result);
+	tcam_params.side = NW_FIB6_TCAM_SIDE;
+	tcam_params.lookup_table_count = NW_FIB6_TCAM_LOOKUP_TABLE_COUNT;
+	tcam_params.table = NW_FIB6_TCAM_TABLE;
+
+	if (infra_create_tcam(&tcam_params) == false) {
+		write_log(LOG_CRIT, "Error - Failed creating FIB6 TCAM.");
+		return false;
+	}
+
+	write_log(LOG_DEBUG, "Creating FIB6 gateway table.");
+
+	table_params.key_size = sizeof(struct nw_fib6_gw_key);
+	table_params.result_size = sizeof(struct nw_fib6_gw_result);
+	table_params.max_num_of_entries = NW_FIB6_GW_MAX_ENTRIES;
+	table_params.updated_from_dp = false;
+	table_params.search_mem_heap = INFRA_EMEM_SEARCH_1_TABLE_HEAP;
+	if (infra_create_table(STRUCT_ID_NW_FIB6_GW,
+			       &table_params) == false) {
+		write_log(LOG_CRIT, "Error - Failed creating FIB6 gateway table.");
+		return false;
+	}
+
+	write_log(LOG_DEBUG, "Creating next hop table.");
+
+	table_params.key_size = sizeof(struct nw_next_hop_key);
+	table_params.result_size = sizeof(struct nw_next_hop_result);
+	table_params.max_num_of_entries = NW_NEXT_HOP_MAX_ENTRIES;
+	table_params.updated_from_dp = true;
+	table_params.search_mem_heap = INFRA_EMEM_SEARCH_2_TABLE_HEAP;
+	if (infra_create_table(STRUCT_ID_NW_NEXT_HOP,
+			       &table_params) == false) {
+		write_log(LOG_CRIT, "Error - Failed creating next hop table.");
+		return false;
+	}
+
 	write_log(LOG_DEBUG, "Creating interface table.");
 
 	table_params.key_size = sizeof(struct nw_if_key);
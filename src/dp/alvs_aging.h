@@ -38,6 +38,7 @@
 #define ALVS_AGING_H_
 
 #include "alvs_conn.h"
+#include "alvs_sched.h"
 
 /******************************************************************************
  * \brief         perform aging on connection entries
@@ -51,6 +52,7 @@ void alvs_handle_aging_event(uint32_t event_id)
 	uint8_t iteration_num = event_id / ALVS_AGING_TIMER_EVENTS_PER_ITERATION;
 	in_addr_t source_ip = 0;
 	uint8_t sync_id = 0;
+	bool refreshed;
 
 
 	/*discard timer job now, to be able to send sync state frame during this part*/
@@ -78,7 +80,12 @@ void alvs_handle_aging_event(uint32_t event_id)
 		conn_index < last_conn_index;
 		conn_index++) {
 		if (alvs_conn_info_lookup(conn_index) == 0) {
-			if (cmem_alvs.conn_info_result.delete_bit == 1) {
+#ifdef ALVS_CONN_COMPACT
+			alvs_conn_resolve_class_key();
+#endif
+			refreshed = (cmem_alvs.conn_info_result.aging_bit == 0 && alvs_conn_is_refreshed(conn_index));
+
+			if (cmem_alvs.conn_info_result.delete_bit == 1 && !refreshed) {
 				alvs_write_log(LOG_DEBUG, "(Aging delete_bit) deleting connection  = %d (0x%x:%d --> 0x%x:%d, protocol=%d)...",
 					       conn_index,
 					       cmem_alvs.conn_info_result.conn_class_key.client_ip,
@@ -91,7 +98,7 @@ void alvs_handle_aging_event(uint32_t event_id)
 				continue;
 			}
 
-			if (cmem_alvs.conn_info_result.aging_bit == 1) {
+			if (cmem_alvs.conn_info_result.aging_bit == 1 || refreshed) {
 				alvs_write_log(LOG_DEBUG, "(Aging aging_bit=1) aging connection = %d (0x%x:%d --> 0x%x:%d, protocol=%d)...",
 					       conn_index,
 					       cmem_alvs.conn_info_result.conn_class_key.client_ip,
@@ -101,15 +108,16 @@ void alvs_handle_aging_event(uint32_t event_id)
 					       cmem_alvs.conn_info_result.conn_class_key.protocol);
 				ezdp_mem_copy(&cmem_alvs.conn_class_key, &cmem_alvs.conn_info_result.conn_class_key, sizeof(struct alvs_conn_classification_key));
 				if (alvs_conn_age_out(conn_index, iteration_num) == 0) {
-					/*aggregate active connection into current state sync frame*/
-					if (unlikely(cmem_alvs.conn_sync_state.conn_sync_status == ALVS_CONN_SYNC_NEED)) {
+					/*aggregate active connection into current state sync frame - full NAT local port is not synced*/
+					if (unlikely(cmem_alvs.conn_sync_state.conn_sync_status == ALVS_CONN_SYNC_NEED) &&
+					    !alvs_conn_is_fullnat()) {
 						alvs_state_sync_aggr(source_ip, sync_id);
 					}
 				}
 				continue;
 			}
 
-			if (cmem_alvs.conn_info_result.age_iteration == ezdp_mod(iteration_num, alvs_util_get_conn_iterations(cmem_alvs.conn_info_result.conn_state), 0, 0) &&
+			if (cmem_alvs.conn_info_result.age_iteration == ezdp_mod(iteration_num, alvs_conn_get_iterations(), 0, 0) &&
 				cmem_alvs.conn_info_result.aging_bit == 0) {
 				alvs_write_log(LOG_DEBUG, "(Aging aging_bit=0) deleting connection = %d (0x%x:%d --> 0x%x:%d, protocol=%d)...",
 					       conn_index,
@@ -128,6 +136,10 @@ void alvs_handle_aging_event(uint32_t event_id)
 	if (unlikely(cmem_alvs.conn_sync_state.amount_buffers > 0)) {
 		alvs_state_sync_send_aggr();
 	}
+	/*age LBLC destination entry of the job*/
+	if (event_id < ALVS_LBLC_MAX_ENTRIES) {
+		alvs_sched_lblc_age(event_id);
+	}
 	/*finish aging, reset sync status*/
 	cmem_alvs.conn_sync_state.conn_sync_status = ALVS_CONN_SYNC_NO_NEED;
 }
@@ -36,12 +36,106 @@
 #ifndef ALVS_CONN_H_
 #define ALVS_CONN_H_
 
+#include <linux/icmp.h>
 #include "defs.h"
 #include "alvs_server.h"
 #include "alvs_utils.h"
 #include "alvs_state_sync_master.h"
 #include "nw_routing.h"
 
+#ifdef ALVS_CONN_COMPACT
+/******************************************************************************
+ * \brief       expand compact connection info entry into
+ *              cmem_alvs.conn_info_result. virtual address, port and protocol
+ *              of the classification key are taken from cmem_alvs.conn_class_key
+ *              which holds the key the connection was found by.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_info_unpack(void)
+{
+	struct alvs_conn_compact_info_result *compact = &cmem_alvs.conn_compact_info_result;
+
+	cmem_alvs.conn_info_result.reset_bit = compact->reset_bit;
+	cmem_alvs.conn_info_result.delete_bit = compact->delete_bit;
+	cmem_alvs.conn_info_result.aging_bit = compact->aging_bit;
+	cmem_alvs.conn_info_result.bound = compact->bound;
+	cmem_alvs.conn_info_result.conn_state = compact->conn_state;
+	cmem_alvs.conn_info_result.service_index = compact->service_index;
+	cmem_alvs.conn_info_result.age_iteration = compact->age_iteration;
+	cmem_alvs.conn_info_result.bind_gen = 0;
+	cmem_alvs.conn_info_result.server_index = compact->server_index;
+	if (compact->bound) {
+		cmem_alvs.conn_info_result.conn_flags = compact->conn_flags;
+	} else {
+		cmem_alvs.conn_info_result.server_port = compact->server_port;
+		cmem_alvs.conn_info_result.conn_flags = compact->fwd_method;
+	}
+	if (compact->inactive) {
+		cmem_alvs.conn_info_result.conn_flags |= IP_VS_CONN_F_INACTIVE;
+	}
+	cmem_alvs.conn_info_result.conn_class_key.client_ip = compact->client_ip;
+	cmem_alvs.conn_info_result.conn_class_key.client_port = compact->client_port;
+	cmem_alvs.conn_info_result.conn_class_key.virtual_ip = cmem_alvs.conn_class_key.virtual_ip;
+	cmem_alvs.conn_info_result.conn_class_key.virtual_port = cmem_alvs.conn_class_key.virtual_port;
+	cmem_alvs.conn_info_result.conn_class_key.protocol = cmem_alvs.conn_class_key.protocol;
+}
+
+/******************************************************************************
+ * \brief       build compact connection info entry from
+ *              cmem_alvs.conn_info_result
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_info_pack(void)
+{
+	struct alvs_conn_compact_info_result *compact = &cmem_alvs.conn_compact_info_result;
+
+	compact->reset_bit = cmem_alvs.conn_info_result.reset_bit;
+	compact->delete_bit = cmem_alvs.conn_info_result.delete_bit;
+	compact->aging_bit = cmem_alvs.conn_info_result.aging_bit;
+	compact->inactive = (cmem_alvs.conn_info_result.conn_flags & IP_VS_CONN_F_INACTIVE) ? 1 : 0;
+	compact->bound = cmem_alvs.conn_info_result.bound;
+	compact->conn_state = cmem_alvs.conn_info_result.conn_state;
+	compact->fwd_method = cmem_alvs.conn_info_result.conn_flags & IP_VS_CONN_F_FWD_MASK;
+	compact->service_index = cmem_alvs.conn_info_result.service_index;
+	compact->age_iteration = cmem_alvs.conn_info_result.age_iteration;
+	compact->server_index = cmem_alvs.conn_info_result.server_index;
+	if (cmem_alvs.conn_info_result.bound) {
+		compact->conn_flags = cmem_alvs.conn_info_result.conn_flags;
+	} else {
+		compact->server_port = cmem_alvs.conn_info_result.server_port;
+	}
+	compact->client_port = cmem_alvs.conn_info_result.conn_class_key.client_port;
+	compact->client_ip = cmem_alvs.conn_info_result.conn_class_key.client_ip;
+}
+
+/******************************************************************************
+ * \brief       rebuild virtual address, port and protocol of the connection
+ *              classification key from the service index of the connection.
+ *              used when connection is not reached by its key (aging).
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_resolve_class_key(void)
+{
+	ezdp_sum_addr_t service_key_addr;
+	uint32_t *service_key = (uint32_t *)&cmem_alvs.service_class_key;
+
+	service_key_addr = BUILD_SUM_ADDR(EZDP_EXTERNAL_MS, EMEM_SERVICE_KEY_MSID,
+					  EMEM_SERVICE_KEY_OFFSET + cmem_alvs.conn_info_result.service_index * EMEM_SERVICE_KEY_ELEMENTS);
+	service_key[0] = ezdp_atomic_read32_sum_addr(service_key_addr);
+	service_key[1] = ezdp_atomic_read32_sum_addr(service_key_addr + 1);
+
+	cmem_alvs.conn_info_result.conn_class_key.virtual_ip = cmem_alvs.service_class_key.service_address;
+	cmem_alvs.conn_info_result.conn_class_key.virtual_port = cmem_alvs.service_class_key.service_port;
+	cmem_alvs.conn_info_result.conn_class_key.protocol = cmem_alvs.service_class_key.service_protocol;
+}
+#endif
+
 /******************************************************************************
  * \brief         perform lookup on connection info DB
  *
@@ -50,15 +144,372 @@
 static __always_inline
 uint32_t alvs_conn_info_lookup(uint32_t conn_index)
 {
+#ifdef ALVS_CONN_COMPACT
+	uint32_t rc;
+
+	rc = ezdp_lookup_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
+				     conn_index, &cmem_alvs.conn_compact_info_result,
+				     sizeof(struct alvs_conn_compact_info_result), 0);
+	if (rc == 0) {
+		alvs_conn_info_unpack();
+	}
+	return rc;
+#else
 	/*get index from entry and perform lookup in conn info DB*/
 	return ezdp_lookup_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
 				       conn_index, &cmem_alvs.conn_info_result,
 				       sizeof(struct alvs_conn_info_result), 0);
+#endif
+}
+
+/******************************************************************************
+ * \brief       get connection info entry to be written to connection info DB.
+ *              entry size is ALVS_CONN_INFO_ENTRY_SIZE.
+ *
+ * \return      pointer to connection info entry
+ */
+static __always_inline
+void *alvs_conn_info_entry(void)
+{
+#ifdef ALVS_CONN_COMPACT
+	alvs_conn_info_pack();
+	return &cmem_alvs.conn_compact_info_result;
+#else
+	return &cmem_alvs.conn_info_result;
+#endif
+}
+
+#ifdef ALVS_CONN_INLINE_INFO
+/******************************************************************************
+ * \brief       build connection classification result from the hot fields of
+ *              cmem_alvs.conn_info_result
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_build_class_result(uint32_t conn_index)
+{
+	cmem_alvs.conn_result.conn_index = conn_index;
+	cmem_alvs.conn_result.reset_bit = cmem_alvs.conn_info_result.reset_bit;
+	cmem_alvs.conn_result.bound = cmem_alvs.conn_info_result.bound;
+	cmem_alvs.conn_result.server_port = cmem_alvs.conn_info_result.server_port;
+	cmem_alvs.conn_result.server_index = cmem_alvs.conn_info_result.server_index;
+	cmem_alvs.conn_result.conn_state = cmem_alvs.conn_info_result.conn_state;
+	cmem_alvs.conn_result.bind_gen = cmem_alvs.conn_info_result.bind_gen;
+	cmem_alvs.conn_result.fwd_method = cmem_alvs.conn_info_result.conn_flags & IP_VS_CONN_F_FWD_MASK;
+}
+#endif
+
+/******************************************************************************
+ * \brief       get connection info of the fast path. when connection info is
+ *              inlined in connection classification result the hot fields are
+ *              taken from it and no lookup is done.
+ *
+ * \return      0=lkp success, otherwise fail
+ */
+static __always_inline
+uint32_t alvs_conn_fast_info_lookup(struct alvs_conn_classification_result *conn_class_res)
+{
+#ifdef ALVS_CONN_INLINE_INFO
+	cmem_alvs.conn_info_result.reset_bit = conn_class_res->reset_bit;
+	cmem_alvs.conn_info_result.delete_bit = 0;
+	/* aging bit is not inlined - refresh is a single posted atomic so do it on every frame */
+	cmem_alvs.conn_info_result.aging_bit = 0;
+	cmem_alvs.conn_info_result.bound = conn_class_res->bound;
+	cmem_alvs.conn_info_result.server_port = conn_class_res->server_port;
+	cmem_alvs.conn_info_result.server_index = conn_class_res->server_index;
+	cmem_alvs.conn_info_result.conn_state = conn_class_res->conn_state;
+	cmem_alvs.conn_info_result.bind_gen = conn_class_res->bind_gen;
+	/*only forwarding method is inlined - full flags are read under connection lock*/
+	cmem_alvs.conn_info_result.conn_flags = conn_class_res->fwd_method;
+	return 0;
+#else
+	return alvs_conn_info_lookup(conn_class_res->conn_index);
+#endif
+}
+
+/******************************************************************************
+ * \brief       write cmem_alvs.conn_info_result to connection info DB. when
+ *              connection info is inlined in connection classification result,
+ *              the classification entry is rewritten as well.
+ *              the connection lock should be taken before running this function.
+ *
+ * \return      0 = modify success, otherwise fail
+ */
+static __always_inline
+uint32_t alvs_conn_info_modify(uint32_t conn_index)
+{
+	uint32_t rc;
+
+	rc = ezdp_modify_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
+				     conn_index,
+				     alvs_conn_info_entry(),
+				     ALVS_CONN_INFO_ENTRY_SIZE,
+				     EZDP_UNCONDITIONAL,
+				     cmem_wa.alvs_wa.conn_info_table_wa,
+				     sizeof(cmem_wa.alvs_wa.conn_info_table_wa));
+#ifdef ALVS_CONN_INLINE_INFO
+	if (rc == 0) {
+		alvs_conn_build_class_result(conn_index);
+		rc = ezdp_add_hash_entry(&shared_cmem_alvs.conn_class_struct_desc,
+					 &cmem_alvs.conn_info_result.conn_class_key,
+					 sizeof(struct alvs_conn_classification_key),
+					 &cmem_alvs.conn_result,
+					 sizeof(struct alvs_conn_classification_result),
+					 EZDP_UNCONDITIONAL,
+					 cmem_wa.alvs_wa.conn_hash_wa,
+					 sizeof(cmem_wa.alvs_wa.conn_hash_wa));
+	}
+#endif
+	return rc;
+}
+
+/******************************************************************************
+ * \brief       get the address of the EMEM word holding the refresh bit of a
+ *              connection index.
+ *
+ * \return      sum address of the refresh flags word
+ */
+static __always_inline
+ezdp_sum_addr_t alvs_conn_refresh_flags_addr(uint32_t conn_index)
+{
+	return BUILD_SUM_ADDR(EZDP_EXTERNAL_MS, EMEM_CONN_REFRESH_FLAGS_MSID, EMEM_CONN_REFRESH_FLAGS_OFFSET + (conn_index >> 5));
+}
+
+/******************************************************************************
+ * \brief       check if a frame refreshed the connection since the last time
+ *              the refresh bit was cleared.
+ *
+ * \return      true if connection was refreshed, otherwise false
+ */
+static __always_inline
+bool alvs_conn_is_refreshed(uint32_t conn_index)
+{
+	return (ezdp_atomic_read32_sum_addr(alvs_conn_refresh_flags_addr(conn_index)) & (1 << (conn_index & 0x1f))) != 0;
+}
+
+/******************************************************************************
+ * \brief       clear connection refresh bit. called on connection creation and
+ *              from aging mechanism while holding the connection lock.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_clear_refresh(uint32_t conn_index)
+{
+	ezdp_atomic_and32_sum_addr(alvs_conn_refresh_flags_addr(conn_index), ~(1 << (conn_index & 0x1f)));
+}
+
+/******************************************************************************
+ * \brief       mark connection as refreshed whenever its aging bit is 0 and a
+ *              new frame arrives to the NPS which belongs to this connection.
+ *              the connection lock is not taken - only the refresh bit is set
+ *              atomically. aging mechanism folds it back into the aging and
+ *              delete bits of the connection info entry on its next pass.
+ *              the bit stays set until that pass, so it is tested first and
+ *              only the first frame after each pass pays the atomic update.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_refresh(uint32_t conn_index)
+{
+	ezdp_sum_addr_t flags_addr = alvs_conn_refresh_flags_addr(conn_index);
+	uint32_t refresh_bit = 1 << (conn_index & 0x1f);
+
+	if ((ezdp_atomic_read32_sum_addr(flags_addr) & refresh_bit) == 0) {
+		ezdp_atomic_or32_sum_addr(flags_addr, refresh_bit);
+	}
+}
+
+/******************************************************************************
+ * \brief       check if connection in cmem_alvs.conn_info_result is a
+ *              persistence template - entry of (client address, service) with
+ *              client port 0, which keeps the server chosen for the client.
+ *
+ * \return      true if connection is a template, otherwise false
+ */
+static __always_inline
+bool alvs_conn_is_template(void)
+{
+	return (cmem_alvs.conn_info_result.conn_flags & IP_VS_CONN_F_TEMPLATE) != 0;
+}
+
+/******************************************************************************
+ * \brief       check if connection in cmem_alvs.conn_info_result is forwarded
+ *              by full NAT. compact connection entry has no room for the
+ *              local port so full NAT is not supported with it.
+ *
+ * \return      true if connection is full NAT, otherwise false
+ */
+static __always_inline
+bool alvs_conn_is_fullnat(void)
+{
+#ifdef ALVS_CONN_COMPACT
+	return false;
+#else
+	return (cmem_alvs.conn_info_result.conn_flags & (IP_VS_CONN_F_FWD_MASK | IP_VS_CONN_F_TEMPLATE)) == ALVS_CONN_F_FULLNAT;
+#endif
+}
+
+/******************************************************************************
+ * \brief       check if connection in cmem_alvs.conn_info_result is forwarded
+ *              by NAT (masquerade) or by full NAT - server replies are
+ *              translated back by the NAT classification DB.
+ *
+ * \return      true if connection is NAT, otherwise false
+ */
+static __always_inline
+bool alvs_conn_is_nat(void)
+{
+#ifdef ALVS_CONN_COMPACT
+	return false;
+#else
+	return (cmem_alvs.conn_info_result.conn_flags & (IP_VS_CONN_F_FWD_MASK | IP_VS_CONN_F_TEMPLATE)) == IP_VS_CONN_F_MASQ ||
+	       alvs_conn_is_fullnat();
+#endif
+}
+
+/******************************************************************************
+ * \brief       get full NAT local address, written by CP on init.
+ *
+ * \return      local address, 0 if not configured
+ */
+static __always_inline
+in_addr_t alvs_conn_fullnat_local_ip(void)
+{
+	return ezdp_atomic_read32_sum_addr(BUILD_SUM_ADDR(EZDP_EXTERNAL_MS, EMEM_FULLNAT_LOCAL_IP_MSID, EMEM_FULLNAT_LOCAL_IP_OFFSET));
+}
+
+/******************************************************************************
+ * \brief       return local port of a full NAT connection to the port pool.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_fullnat_free_port(uint16_t local_port)
+{
+	ezdp_free_index(ALVS_FULLNAT_PORT_POOL_ID, local_port - ALVS_FULLNAT_MIN_PORT);
+}
+
+/******************************************************************************
+ * \brief       keep server address and port of a bound NAT connection in
+ *              cmem_alvs.conn_info_result, taken from cmem_alvs.server_info_result.
+ *              NAT classification entry is deleted by them even when server
+ *              info was deleted or its index reused.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_nat_set_server(void)
+{
+	cmem_alvs.conn_info_result.nat_server_ip = cmem_alvs.server_info_result.server_ip;
+	cmem_alvs.conn_info_result.nat_server_port = cmem_alvs.server_info_result.server_port;
+}
+
+/******************************************************************************
+ * \brief       build NAT classification key (server to client direction) of
+ *              connection in cmem_alvs.conn_info_result. server address and
+ *              port are kept in the connection entry.
+ *              full NAT server replies to the local address and port.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_nat_build_key(void)
+{
+	if (cmem_alvs.conn_info_result.bound) {
+		cmem_alvs.nat_class_key.server_ip = cmem_alvs.conn_info_result.nat_server_ip;
+		cmem_alvs.nat_class_key.server_port = cmem_alvs.conn_info_result.nat_server_port;
+	} else {
+		cmem_alvs.nat_class_key.server_ip = cmem_alvs.conn_info_result.server_addr;
+		cmem_alvs.nat_class_key.server_port = cmem_alvs.conn_info_result.server_port;
+	}
+	if (alvs_conn_is_fullnat()) {
+		cmem_alvs.nat_class_key.client_ip = alvs_conn_fullnat_local_ip();
+		cmem_alvs.nat_class_key.client_port = cmem_alvs.conn_info_result.local_port;
+	} else {
+		cmem_alvs.nat_class_key.client_ip = cmem_alvs.conn_info_result.conn_class_key.client_ip;
+		cmem_alvs.nat_class_key.client_port = cmem_alvs.conn_info_result.conn_class_key.client_port;
+	}
+	cmem_alvs.nat_class_key.protocol = cmem_alvs.conn_info_result.conn_class_key.protocol;
+}
+
+/******************************************************************************
+ * \brief       add NAT classification entry of a new NAT connection, so frames
+ *              of the server can be translated back to the virtual service.
+ *              the connection lock should be taken before running this function,
+ *              unless built with ALVS_CONN_LOCKLESS_CREATE - then the entry is
+ *              added only if absent.
+ *
+ * \return      0 = add success, otherwise fail
+ */
+static __always_inline
+uint32_t alvs_conn_nat_add(uint32_t conn_index)
+{
+	alvs_conn_nat_build_key();
+
+	cmem_alvs.nat_result.fullnat = alvs_conn_is_fullnat();
+	cmem_alvs.nat_result.conn_index = conn_index;
+	cmem_alvs.nat_result.virtual_ip = cmem_alvs.conn_info_result.conn_class_key.virtual_ip;
+	cmem_alvs.nat_result.virtual_port = cmem_alvs.conn_info_result.conn_class_key.virtual_port;
+
+	return ezdp_add_hash_entry(&shared_cmem_alvs.nat_class_struct_desc,
+				   &cmem_alvs.nat_class_key,
+				   sizeof(struct alvs_nat_classification_key),
+				   &cmem_alvs.nat_result,
+				   sizeof(struct alvs_nat_classification_result),
+				   ALVS_CONN_CLASS_ADD_FLAGS,
+				   cmem_wa.alvs_wa.nat_hash_wa,
+				   sizeof(cmem_wa.alvs_wa.nat_hash_wa));
+}
+
+/******************************************************************************
+ * \brief       remove NAT classification entry of a NAT connection. entry is
+ *              removed only if it still belongs to the connection.
+ *              the connection lock should be taken before running this function.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_nat_delete(uint32_t conn_index)
+{
+	uint32_t found_result_size;
+	struct alvs_nat_classification_result *nat_class_res_ptr;
+
+	alvs_conn_nat_build_key();
+
+	if (ezdp_lookup_hash_entry(&shared_cmem_alvs.nat_class_struct_desc,
+				   &cmem_alvs.nat_class_key,
+				   sizeof(struct alvs_nat_classification_key),
+				   (void **)&nat_class_res_ptr,
+				   &found_result_size, 0,
+				   cmem_wa.alvs_wa.nat_hash_wa,
+				   sizeof(cmem_wa.alvs_wa.nat_hash_wa)) != 0 ||
+	    nat_class_res_ptr->conn_index != conn_index) {
+		alvs_write_log(LOG_DEBUG, "nat_class_key of conn_idx = %d not found or reused", conn_index);
+		return;
+	}
+
+	if (ezdp_delete_hash_entry(&shared_cmem_alvs.nat_class_struct_desc,
+				   &cmem_alvs.nat_class_key,
+				   sizeof(struct alvs_nat_classification_key),
+				   0,
+				   cmem_wa.alvs_wa.nat_hash_wa,
+				   sizeof(cmem_wa.alvs_wa.nat_hash_wa)) != 0) {
+		alvs_write_log(LOG_CRIT, "unable to delete nat_class_key conn_idx = %d", conn_index);
+	}
 }
 
 /******************************************************************************
  * \brief       create a new entry in connection info and connection classification
- *              DBs. the connection lock should be taken before running this function.
+ *              DBs. the connection lock should be taken before running this function,
+ *              unless built with ALVS_CONN_LOCKLESS_CREATE - then the classification
+ *              entry is added only if absent and ALVS_SERVICE_DATA_PATH_RETRY is returned
+ *              when other thread created the same connection first.
+ *              NAT entry of a NAT connection is added before the classification
+ *              entry, so a published connection always has its NAT entry and a
+ *              failed create only removes entries not yet reachable by other threads.
  *              new index from connection index pool is being allocated. this index is used
  *              as the key to the connection info DB and as the result to the connection
  *              info DB.
@@ -75,12 +526,19 @@ uint32_t alvs_conn_info_lookup(uint32_t conn_index)
  *
  */
 static __always_inline
-enum alvs_service_output_result alvs_conn_create_new_entry(bool bound, uint32_t server, uint16_t port,
+enum alvs_service_output_result alvs_conn_create_new_entry(uint8_t service_index,
+							   bool bound, uint32_t server, uint16_t port,
 							   enum alvs_tcp_conn_state conn_state,
 							   uint32_t flags, bool reset)
 {
 	uint32_t conn_index;
+	uint32_t port_index;
 	uint32_t rc;
+	enum alvs_error_stats_offsets error_id;
+#ifdef ALVS_CONN_LOCKLESS_CREATE
+	uint32_t found_result_size;
+	struct alvs_conn_classification_result *conn_class_res_ptr;
+#endif
 
 	/*allocate new index*/
 	conn_index = ezdp_alloc_index(ALVS_CONN_INDEX_POOL_ID);
@@ -94,6 +552,9 @@ enum alvs_service_output_result alvs_conn_create_new_entry(bool bound, uint32_t
 	}
 	alvs_write_log(LOG_DEBUG, "Index %d allocated for connection", conn_index);
 
+	/*index may be reused - clear refresh bit left by previous connection*/
+	alvs_conn_clear_refresh(conn_index);
+
 	cmem_alvs.conn_info_result.aging_bit = 1;
 	cmem_alvs.conn_info_result.bound = bound;
 	cmem_alvs.conn_info_result.reset_bit = reset;
@@ -102,8 +563,29 @@ enum alvs_service_output_result alvs_conn_create_new_entry(bool bound, uint32_t
 	cmem_alvs.conn_info_result.server_index = server;
 	cmem_alvs.conn_info_result.server_port = port;
 	cmem_alvs.conn_info_result.conn_state = conn_state;
+	cmem_alvs.conn_info_result.service_index = service_index;
+	cmem_alvs.conn_info_result.bind_gen = 0;
 	cmem_alvs.conn_info_result.age_iteration = 0;
+	cmem_alvs.conn_info_result.nat_server_ip = 0;
 	ezdp_mem_copy(&cmem_alvs.conn_info_result.conn_class_key, &cmem_alvs.conn_class_key, sizeof(struct alvs_conn_classification_key));
+	if (bound && alvs_conn_is_nat()) {
+		alvs_conn_nat_set_server();
+	}
+
+	/*full NAT connection - allocate local port the server replies to*/
+	if (alvs_conn_is_fullnat()) {
+		port_index = ezdp_alloc_index(ALVS_FULLNAT_PORT_POOL_ID);
+		if (port_index == EZDP_NULL_INDEX) {
+			alvs_write_log(LOG_DEBUG, "error alloc full NAT local port server_index = %d, free ports = %d", server, ezdp_read_free_indexes(ALVS_FULLNAT_PORT_POOL_ID));
+			alvs_server_overload_on_delete_conn(server);
+			ezdp_free_index(ALVS_CONN_INDEX_POOL_ID, conn_index);
+
+			/*drop frame*/
+			alvs_discard_and_stats(ALVS_ERROR_FULLNAT_PORT_ALLOC_FAIL);
+			return ALVS_SERVICE_DATA_PATH_IGNORE;
+		}
+		cmem_alvs.conn_info_result.local_port = ALVS_FULLNAT_MIN_PORT + port_index;
+	}
 
 	if (conn_state == IP_VS_TCP_S_ESTABLISHED) {
 		cmem_alvs.conn_info_result.conn_flags &= ~IP_VS_CONN_F_INACTIVE;
@@ -114,31 +596,55 @@ enum alvs_service_output_result alvs_conn_create_new_entry(bool bound, uint32_t
 	/*first create connection info entry*/
 	(void)ezdp_add_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
 			     conn_index,
-			     &cmem_alvs.conn_info_result,
-			     sizeof(struct alvs_conn_info_result),
+			     alvs_conn_info_entry(),
+			     ALVS_CONN_INFO_ENTRY_SIZE,
 			     EZDP_UNCONDITIONAL,
 			     cmem_wa.alvs_wa.conn_info_table_wa,
 			     sizeof(cmem_wa.alvs_wa.conn_info_table_wa));
 
+#ifdef ALVS_CONN_INLINE_INFO
+	alvs_conn_build_class_result(conn_index);
+#else
 	cmem_alvs.conn_result.conn_index = conn_index;
-
-	rc = ezdp_add_hash_entry(&shared_cmem_alvs.conn_class_struct_desc,
-				 &cmem_alvs.conn_class_key,
-				 sizeof(struct alvs_conn_classification_key),
-				 &cmem_alvs.conn_result,
-				 sizeof(struct alvs_conn_classification_result),
-				 EZDP_UNCONDITIONAL,
-				 cmem_wa.alvs_wa.conn_hash_wa,
-				 sizeof(cmem_wa.alvs_wa.conn_hash_wa));
+#endif
+
+	/*NAT and full NAT connection - add server to client direction before the
+	 *connection is published by its classification entry
+	 */
+	if (alvs_conn_is_nat() && alvs_conn_nat_add(conn_index) != 0) {
+		alvs_write_log(LOG_DEBUG, "ezdp_add_hash_entry: NAT connection (0x%x:%d <-- 0x%x:%d, protocol=%d)...failed",
+			       cmem_alvs.nat_class_key.client_ip,
+			       cmem_alvs.nat_class_key.client_port,
+			       cmem_alvs.nat_class_key.server_ip,
+			       cmem_alvs.nat_class_key.server_port,
+			       cmem_alvs.nat_class_key.protocol);
+		error_id = ALVS_ERROR_NAT_CLASS_ALLOC_FAIL;
+		rc = 1;
+	} else {
+		rc = ezdp_add_hash_entry(&shared_cmem_alvs.conn_class_struct_desc,
+					 &cmem_alvs.conn_class_key,
+					 sizeof(struct alvs_conn_classification_key),
+					 &cmem_alvs.conn_result,
+					 sizeof(struct alvs_conn_classification_result),
+					 ALVS_CONN_CLASS_ADD_FLAGS,
+					 cmem_wa.alvs_wa.conn_hash_wa,
+					 sizeof(cmem_wa.alvs_wa.conn_hash_wa));
+		if (rc != 0) {
+			alvs_write_log(LOG_DEBUG, "ezdp_add_hash_entry: connection (0x%x:%d --> 0x%x:%d, protocol=%d)...failed",
+				       cmem_alvs.conn_class_key.client_ip,
+				       cmem_alvs.conn_class_key.client_port,
+				       cmem_alvs.conn_class_key.virtual_ip,
+				       cmem_alvs.conn_class_key.virtual_port,
+				       cmem_alvs.conn_class_key.protocol);
+			/*connection was not published - NAT entry is not used by other thread*/
+			if (alvs_conn_is_nat()) {
+				alvs_conn_nat_delete(conn_index);
+			}
+			error_id = ALVS_ERROR_CONN_CLASS_ALLOC_FAIL;
+		}
+	}
 
 	if (rc != 0) {
-		alvs_write_log(LOG_DEBUG, "ezdp_add_hash_entry: connection (0x%x:%d --> 0x%x:%d, protocol=%d)...failed",
-		       cmem_alvs.conn_class_key.client_ip,
-		       cmem_alvs.conn_class_key.client_port,
-		       cmem_alvs.conn_class_key.virtual_ip,
-		       cmem_alvs.conn_class_key.virtual_port,
-		       cmem_alvs.conn_class_key.protocol);
-
 		(void)ezdp_delete_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
 					    conn_index,
 					    0,
@@ -147,16 +653,35 @@ enum alvs_service_output_result alvs_conn_create_new_entry(bool bound, uint32_t
 
 		alvs_server_overload_on_delete_conn(server);
 		ezdp_free_index(ALVS_CONN_INDEX_POOL_ID, conn_index);
-		alvs_discard_and_stats(ALVS_ERROR_CONN_CLASS_ALLOC_FAIL);
+		if (alvs_conn_is_fullnat()) {
+			alvs_conn_fullnat_free_port(cmem_alvs.conn_info_result.local_port);
+		}
+
+#ifdef ALVS_CONN_LOCKLESS_CREATE
+		/*check if other thread created the connection first*/
+		if (ezdp_lookup_hash_entry(&shared_cmem_alvs.conn_class_struct_desc,
+					   (void *)&cmem_alvs.conn_class_key,
+					   sizeof(struct alvs_conn_classification_key),
+					   (void **)&conn_class_res_ptr,
+					   &found_result_size, 0,
+					   cmem_wa.alvs_wa.conn_hash_wa,
+					   sizeof(cmem_wa.alvs_wa.conn_hash_wa)) == 0) {
+			ezdp_mem_copy(&cmem_alvs.conn_result, conn_class_res_ptr, sizeof(struct alvs_conn_classification_result));
+			alvs_write_log(LOG_DEBUG, "connection was already created by other thread, conn_index = %d", cmem_alvs.conn_result.conn_index);
+			return ALVS_SERVICE_DATA_PATH_RETRY;
+		}
+#endif
+		alvs_discard_and_stats(error_id);
 		return ALVS_SERVICE_DATA_PATH_IGNORE;
 	}
 
-	if (conn_state == IP_VS_TCP_S_ESTABLISHED) {
-		if (bound) {
+	alvs_update_half_open_statistics(IP_VS_TCP_S_NONE, conn_state);
+
+	/*template synced by master is not a connection*/
+	if (bound && !alvs_conn_is_template()) {
+		if (conn_state == IP_VS_TCP_S_ESTABLISHED) {
 			alvs_update_connection_statistics(1, 1, 0);
-		}
-	} else {
-		if (bound) {
+		} else {
 			alvs_update_connection_statistics(1, 0, 1);
 		}
 	}
@@ -172,10 +697,189 @@ enum alvs_service_output_result alvs_conn_create_new_entry(bool bound, uint32_t
 }
 
 /******************************************************************************
- * \brief       update the connection entry state. currently only support 2
- *              states for connection:
- *                      ESTABLISHED
- *                      CLOSE WAIT
+ * \brief       turn cmem_alvs.conn_class_key to the key of the persistence template
+ *              of the client - client port 0, and virtual port 0 as well for a
+ *              wildcard port service (classified with service port 0) so the client
+ *              is persistent on all ports of the service.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_template_key(void)
+{
+	cmem_alvs.conn_class_key.client_port = 0;
+	if (cmem_alvs.service_class_key.service_port == 0) {
+		cmem_alvs.conn_class_key.virtual_port = 0;
+	}
+}
+
+/******************************************************************************
+ * \brief       lookup persistence template of the client of cmem_alvs.conn_class_key.
+ *              template key is built by alvs_conn_template_key. a found
+ *              template is refreshed so it lives persistence timeout from the
+ *              last connection of the client.
+ *
+ * \return      true if template was found, otherwise false.
+ */
+static __always_inline
+bool alvs_conn_template_lookup(uint32_t *template_index, uint32_t *server_index)
+{
+	uint16_t client_port = cmem_alvs.conn_class_key.client_port;
+	uint16_t virtual_port = cmem_alvs.conn_class_key.virtual_port;
+	uint32_t found_result_size;
+	struct alvs_conn_classification_result *conn_class_res_ptr;
+	uint32_t rc;
+
+	alvs_conn_template_key();
+	rc = ezdp_lookup_hash_entry(&shared_cmem_alvs.conn_class_struct_desc,
+				    (void *)&cmem_alvs.conn_class_key,
+				    sizeof(struct alvs_conn_classification_key),
+				    (void **)&conn_class_res_ptr,
+				    &found_result_size, 0,
+				    cmem_wa.alvs_wa.conn_hash_wa,
+				    sizeof(cmem_wa.alvs_wa.conn_hash_wa));
+	if (rc != 0) {
+		cmem_alvs.conn_class_key.client_port = client_port;
+		cmem_alvs.conn_class_key.virtual_port = virtual_port;
+		return false;
+	}
+	*template_index = conn_class_res_ptr->conn_index;
+
+#ifdef ALVS_CONN_INLINE_INFO
+	*server_index = conn_class_res_ptr->server_index;
+#else
+	rc = alvs_conn_info_lookup(*template_index);
+	*server_index = cmem_alvs.conn_info_result.server_index;
+#endif
+	cmem_alvs.conn_class_key.client_port = client_port;
+	cmem_alvs.conn_class_key.virtual_port = virtual_port;
+	if (rc != 0) {
+		return false;
+	}
+
+	alvs_conn_refresh(*template_index);
+	alvs_write_log(LOG_DEBUG, "persistence template found (template_idx = %d server_idx = %d)", *template_index, *server_index);
+	return true;
+}
+
+/******************************************************************************
+ * \brief       create persistence template for the client of cmem_alvs.conn_class_key,
+ *              bound to the server in cmem_alvs.server_info_result. called while
+ *              scheduling a connection - the template lock is not taken (the
+ *              connection lock, if any, is of the connection) so the template
+ *              is added only if absent. template is not counted in statistics
+ *              and failure to create it is not an error - next connection of the
+ *              client will try again.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_template_create(uint8_t service_index, uint32_t server_index)
+{
+	uint16_t client_port = cmem_alvs.conn_class_key.client_port;
+	uint16_t virtual_port = cmem_alvs.conn_class_key.virtual_port;
+	uint32_t conn_index;
+	uint32_t rc;
+
+	conn_index = ezdp_alloc_index(ALVS_CONN_INDEX_POOL_ID);
+	if (conn_index == EZDP_NULL_INDEX) {
+		alvs_write_log(LOG_DEBUG, "error alloc index for persistence template server_index = %d", server_index);
+		return;
+	}
+
+	/*index may be reused - clear refresh bit left by previous connection*/
+	alvs_conn_clear_refresh(conn_index);
+
+	alvs_conn_template_key();
+	cmem_alvs.conn_info_result.aging_bit = 1;
+	cmem_alvs.conn_info_result.bound = true;
+	cmem_alvs.conn_info_result.reset_bit = 0;
+	cmem_alvs.conn_info_result.delete_bit = 0;
+	cmem_alvs.conn_info_result.conn_flags = cmem_alvs.server_info_result.conn_flags | IP_VS_CONN_F_TEMPLATE | IP_VS_CONN_F_INACTIVE;
+	cmem_alvs.conn_info_result.server_index = server_index;
+	cmem_alvs.conn_info_result.local_port = 0;
+	cmem_alvs.conn_info_result.conn_state = IP_VS_TCP_S_NONE;
+	cmem_alvs.conn_info_result.service_index = service_index;
+	cmem_alvs.conn_info_result.bind_gen = 0;
+	cmem_alvs.conn_info_result.age_iteration = 0;
+	ezdp_mem_copy(&cmem_alvs.conn_info_result.conn_class_key, &cmem_alvs.conn_class_key, sizeof(struct alvs_conn_classification_key));
+
+	(void)ezdp_add_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
+			     conn_index,
+			     alvs_conn_info_entry(),
+			     ALVS_CONN_INFO_ENTRY_SIZE,
+			     EZDP_UNCONDITIONAL,
+			     cmem_wa.alvs_wa.conn_info_table_wa,
+			     sizeof(cmem_wa.alvs_wa.conn_info_table_wa));
+
+#ifdef ALVS_CONN_INLINE_INFO
+	alvs_conn_build_class_result(conn_index);
+#else
+	cmem_alvs.conn_result.conn_index = conn_index;
+#endif
+
+	/*other connection of the client may create the template first*/
+	rc = ezdp_add_hash_entry(&shared_cmem_alvs.conn_class_struct_desc,
+				 &cmem_alvs.conn_class_key,
+				 sizeof(struct alvs_conn_classification_key),
+				 &cmem_alvs.conn_result,
+				 sizeof(struct alvs_conn_classification_result),
+				 0,
+				 cmem_wa.alvs_wa.conn_hash_wa,
+				 sizeof(cmem_wa.alvs_wa.conn_hash_wa));
+	cmem_alvs.conn_class_key.client_port = client_port;
+	cmem_alvs.conn_class_key.virtual_port = virtual_port;
+
+	if (rc != 0) {
+		alvs_write_log(LOG_DEBUG, "persistence template of client 0x%x was not created", cmem_alvs.conn_class_key.client_ip);
+		(void)ezdp_delete_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
+					    conn_index,
+					    0,
+					    cmem_wa.alvs_wa.conn_info_table_wa,
+					    sizeof(cmem_wa.alvs_wa.conn_info_table_wa));
+		ezdp_free_index(ALVS_CONN_INDEX_POOL_ID, conn_index);
+		return;
+	}
+
+	alvs_write_log(LOG_DEBUG, "Persistence template created (template_idx = %d server_idx = %d) successfully", conn_index, server_index);
+}
+
+/******************************************************************************
+ * \brief       bind persistence template to a new server, when the server of the
+ *              template is unavailable. called while scheduling a connection,
+ *              which may hold the connection lock (not with
+ *              ALVS_CONN_LOCKLESS_CREATE), so the template lock is only tried -
+ *              if it is busy (or shared with the connection lock) the template
+ *              is left as is and next connection of the client will rebind it.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_template_rebind(uint32_t template_index, uint32_t server_index)
+{
+	uint16_t client_port = cmem_alvs.conn_class_key.client_port;
+	uint16_t virtual_port = cmem_alvs.conn_class_key.virtual_port;
+	ezdp_hashed_key_t hash_value;
+
+	alvs_conn_template_key();
+	if (alvs_try_lock_connection(&hash_value) == 0) {
+		/*perform another lookup - template may be deleted by aging and its index reused*/
+		if (alvs_conn_info_lookup(template_index) == 0 && alvs_conn_is_template() &&
+		    cmem_alvs.conn_info_result.conn_class_key.client_ip == cmem_alvs.conn_class_key.client_ip) {
+			cmem_alvs.conn_info_result.server_index = server_index;
+			cmem_alvs.conn_info_result.conn_flags = cmem_alvs.server_info_result.conn_flags | IP_VS_CONN_F_TEMPLATE | IP_VS_CONN_F_INACTIVE;
+			(void)alvs_conn_info_modify(template_index);
+			alvs_write_log(LOG_DEBUG, "Persistence template rebound (template_idx = %d server_idx = %d)", template_index, server_index);
+		}
+		alvs_unlock_connection(hash_value);
+	}
+	cmem_alvs.conn_class_key.client_port = client_port;
+	cmem_alvs.conn_class_key.virtual_port = virtual_port;
+}
+
+/******************************************************************************
+ * \brief       update the connection entry state. connection is counted as
+ *              active only in ESTABLISHED state and as inactive otherwise.
  *
  * \return      0 = modify success, otherwise fail
  */
@@ -202,20 +906,25 @@ uint32_t alvs_conn_update_state(uint32_t conn_index, enum alvs_tcp_conn_state ne
 		return rc;
 	}
 
-	alvs_update_connection_statistics(0, -1, 1);
+	if (cmem_alvs.conn_info_result.conn_state == IP_VS_TCP_S_ESTABLISHED) {
+		if (cmem_alvs.conn_info_result.bound) {
+			alvs_update_connection_statistics(0, -1, 1);
+		}
+		cmem_alvs.conn_info_result.conn_flags |= IP_VS_CONN_F_INACTIVE;
+	} else if (new_state == IP_VS_TCP_S_ESTABLISHED) {
+		if (cmem_alvs.conn_info_result.bound) {
+			alvs_update_connection_statistics(0, 1, -1);
+		}
+		cmem_alvs.conn_info_result.conn_flags &= ~IP_VS_CONN_F_INACTIVE;
+	}
+
+	alvs_update_half_open_statistics(cmem_alvs.conn_info_result.conn_state, new_state);
 
 	cmem_alvs.conn_info_result.delete_bit = 0;
 	cmem_alvs.conn_info_result.aging_bit = 1;
 	cmem_alvs.conn_info_result.conn_state = new_state;
-	cmem_alvs.conn_info_result.conn_flags |= IP_VS_CONN_F_INACTIVE;
 
-	rc = ezdp_modify_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
-			conn_index,
-			&cmem_alvs.conn_info_result,
-			sizeof(struct alvs_conn_info_result),
-			EZDP_UNCONDITIONAL,
-			cmem_wa.alvs_wa.conn_info_table_wa,
-			sizeof(cmem_wa.alvs_wa.conn_info_table_wa));
+	rc = alvs_conn_info_modify(conn_index);
 
 	/*mark connection for state sync*/
 	cmem_alvs.conn_sync_state.conn_sync_status = ALVS_CONN_SYNC_NEED;
@@ -259,22 +968,22 @@ uint32_t alvs_conn_mark_to_delete(uint32_t conn_index, uint8_t reset)
 	}
 
 	/* need to modify connection entry - change state for close and set aging bit on. */
+	alvs_conn_clear_refresh(conn_index);
 	cmem_alvs.conn_info_result.aging_bit = 0;
 	cmem_alvs.conn_info_result.delete_bit = 1;
 	cmem_alvs.conn_info_result.reset_bit = reset;
-	if (reset && cmem_alvs.conn_info_result.conn_state == IP_VS_TCP_S_ESTABLISHED) {
-		cmem_alvs.conn_info_result.conn_state = IP_VS_TCP_S_CLOSE_WAIT;
-		alvs_update_connection_statistics(0, -1, 1);
-		cmem_alvs.conn_info_result.conn_flags |= IP_VS_CONN_F_INACTIVE;
+	if (reset) {
+		if (cmem_alvs.conn_info_result.conn_state == IP_VS_TCP_S_ESTABLISHED) {
+			if (cmem_alvs.conn_info_result.bound) {
+				alvs_update_connection_statistics(0, -1, 1);
+			}
+			cmem_alvs.conn_info_result.conn_flags |= IP_VS_CONN_F_INACTIVE;
+		}
+		alvs_update_half_open_statistics(cmem_alvs.conn_info_result.conn_state, IP_VS_TCP_S_CLOSE);
+		cmem_alvs.conn_info_result.conn_state = IP_VS_TCP_S_CLOSE;
 	}
 
-	rc = ezdp_modify_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
-			conn_index,
-			&cmem_alvs.conn_info_result,
-			sizeof(struct alvs_conn_info_result),
-			EZDP_UNCONDITIONAL,
-			cmem_wa.alvs_wa.conn_info_table_wa,
-			sizeof(cmem_wa.alvs_wa.conn_info_table_wa));
+	rc = alvs_conn_info_modify(conn_index);
 
 	/*unlock connection*/
 	alvs_unlock_connection(hash_value);
@@ -291,6 +1000,25 @@ uint32_t alvs_conn_mark_to_delete(uint32_t conn_index, uint8_t reset)
 static __always_inline
 void alvs_conn_delete_without_lock(uint32_t conn_index)
 {
+#ifdef ALVS_CONN_COMPACT
+	uint32_t found_result_size;
+	struct alvs_conn_classification_result *conn_class_res_ptr;
+
+	/*key of compact entry is rebuilt from service index. CP reuses the index of a deleted service only
+	 *after its connections aged out, so a mismatch is a corrupted entry which can't be reached by its key
+	 */
+	if (ezdp_lookup_hash_entry(&shared_cmem_alvs.conn_class_struct_desc,
+				   &cmem_alvs.conn_info_result.conn_class_key,
+				   sizeof(struct alvs_conn_classification_key),
+				   (void **)&conn_class_res_ptr,
+				   &found_result_size, 0,
+				   cmem_wa.alvs_wa.conn_hash_wa,
+				   sizeof(cmem_wa.alvs_wa.conn_hash_wa)) != 0 ||
+	    conn_class_res_ptr->conn_index != conn_index) {
+		alvs_write_log(LOG_CRIT, "conn_class_key does not match conn_idx = %d alvs_conn_delete", conn_index);
+		return;
+	}
+#endif
 
 	/*1st remove the classification entry*/
 	if (ezdp_delete_hash_entry(&shared_cmem_alvs.conn_class_struct_desc,
@@ -303,6 +1031,11 @@ void alvs_conn_delete_without_lock(uint32_t conn_index)
 		return;
 	}
 
+	/*remove server to client direction of NAT and full NAT connection*/
+	if (alvs_conn_is_nat()) {
+		alvs_conn_nat_delete(conn_index);
+	}
+
 	/*now remove the connection info entry*/
 	if (ezdp_delete_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
 				conn_index,
@@ -313,7 +1046,9 @@ void alvs_conn_delete_without_lock(uint32_t conn_index)
 		return;
 	}
 
-	if (alvs_server_info_lookup(cmem_alvs.conn_info_result.server_index) == 0) {
+	/*template and unbound connection are not counted as a server connection*/
+	if (!alvs_conn_is_template() && cmem_alvs.conn_info_result.bound &&
+	    alvs_server_info_lookup(cmem_alvs.conn_info_result.server_index) == 0) {
 		if (cmem_alvs.conn_info_result.conn_state == IP_VS_TCP_S_ESTABLISHED) {
 			alvs_update_connection_statistics(0, -1, 0);
 		} else {
@@ -321,7 +1056,11 @@ void alvs_conn_delete_without_lock(uint32_t conn_index)
 		}
 		alvs_server_overload_on_delete_conn(cmem_alvs.conn_info_result.server_index);
 	}
+	alvs_update_half_open_statistics(cmem_alvs.conn_info_result.conn_state, IP_VS_TCP_S_NONE);
 
+	if (alvs_conn_is_fullnat()) {
+		alvs_conn_fullnat_free_port(cmem_alvs.conn_info_result.local_port);
+	}
 	ezdp_free_index(ALVS_CONN_INDEX_POOL_ID, conn_index);
 }
 
@@ -349,13 +1088,14 @@ void alvs_conn_delete(uint32_t conn_index)
 }
 
 /******************************************************************************
- * \brief       set connection entry aging bit back to 1 after whenever it is set to 0 and a
+ * \brief       set connection to be bound to a server.
  *              a new frame arrives to the NPS which belongs to this connection.
  *
  * \return      0 in case of success, otherwise failure.
  */
 static __always_inline
-uint32_t alvs_conn_refresh(uint32_t conn_index)
+uint32_t alvs_conn_bind(uint32_t conn_index,
+			uint32_t server_index)
 {
 	uint32_t rc;
 	ezdp_hashed_key_t hash_value;
@@ -367,80 +1107,124 @@ uint32_t alvs_conn_refresh(uint32_t conn_index)
 	rc = alvs_conn_info_lookup(conn_index);
 
 	if (rc != 0) {
-		alvs_write_log(LOG_DEBUG, "fail in conn_idx = %d conn_info lookup alvs_conn_refresh", conn_index);
+		alvs_write_log(LOG_DEBUG, "fail in conn_idx = %d conn_info lookup alvs_conn_bind", conn_index);
 		alvs_unlock_connection(hash_value);
 		return rc;
 	}
 
-	/* turn on the aging bit */
-	cmem_alvs.conn_info_result.aging_bit = 1;
-	cmem_alvs.conn_info_result.delete_bit = 0;
+	if (cmem_alvs.conn_info_result.bound == true) {
+		alvs_write_log(LOG_DEBUG, "connection %d is already bound (other thread performed the bind before)", conn_index);
+		alvs_unlock_connection(hash_value);
+		return 0;
+	}
 
-	rc =  ezdp_modify_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
-			conn_index,
-			&cmem_alvs.conn_info_result,
-			sizeof(struct alvs_conn_info_result),
-			EZDP_UNCONDITIONAL,
-			cmem_wa.alvs_wa.conn_info_table_wa,
-			sizeof(cmem_wa.alvs_wa.conn_info_table_wa));
+	rc = alvs_server_info_lookup(server_index);
+	if (rc != 0) {
+		alvs_write_log(LOG_DEBUG, "fail in server_idx = %d server_info lookup alvs_conn_bind", server_index);
+		alvs_unlock_connection(hash_value);
+		return rc;
+	}
+
+	cmem_alvs.conn_info_result.server_index = server_index;
+	cmem_alvs.conn_info_result.bound = true;
+	/*NAT entry was added with address and port of the unbound connection - same server*/
+	if (alvs_conn_is_nat()) {
+		alvs_conn_nat_set_server();
+	}
+
+	rc = alvs_conn_info_modify(conn_index);
+	if (rc == 0) {
+		/*account connection on the server as creation of a bound connection
+		 *does - delete of a bound connection releases it
+		 */
+		if (cmem_alvs.conn_info_result.conn_state == IP_VS_TCP_S_ESTABLISHED) {
+			alvs_update_connection_statistics(0, 1, 0);
+		} else {
+			alvs_update_connection_statistics(0, 0, 1);
+		}
+		ezdp_inc_single_ctr(cmem_alvs.server_info_result.server_on_demand_stats_base + ALVS_SERVER_STATS_CONNECTION_TOTAL_OFFSET,
+				    1);
+	}
 
 	/*unlock*/
 	alvs_unlock_connection(hash_value);
 	return rc;
 }
 
+/******************************************************************************
+ * \brief       check if an unbound connection should try to bind to a server.
+ *              a failed bind attempt is not repeated until server config
+ *              generation changes.
+ *
+ * \return      true if server lookup should be done, otherwise false.
+ */
+static __always_inline
+bool alvs_conn_bind_needed(uint16_t server_config_gen)
+{
+#ifdef ALVS_CONN_COMPACT
+	/*compact connection entry has no room for bind generation*/
+	return true;
+#else
+	return cmem_alvs.conn_info_result.bind_gen != server_config_gen;
+#endif
+}
 
 /******************************************************************************
- * \brief       set connection to be bound to a server.
- *              a new frame arrives to the NPS which belongs to this connection.
+ * \brief       record server config generation of a failed bind attempt, so
+ *              next frames of the connection skip server lookup.
  *
- * \return      0 in case of success, otherwise failure.
+ * \return      void
  */
 static __always_inline
-uint32_t alvs_conn_bind(uint32_t conn_index,
-			uint32_t server_index)
+void alvs_conn_bind_failed(uint32_t conn_index, uint16_t server_config_gen)
 {
-	uint32_t rc;
+#ifndef ALVS_CONN_COMPACT
 	ezdp_hashed_key_t hash_value;
 
 	/*lock connection*/
 	alvs_lock_connection(&hash_value);
 
 	/*perform another lookup to prevent race conditions*/
-	rc = alvs_conn_info_lookup(conn_index);
-
-	if (rc != 0) {
-		alvs_write_log(LOG_DEBUG, "fail in conn_idx = %d conn_info lookup alvs_conn_bind", conn_index);
-		alvs_unlock_connection(hash_value);
-		return rc;
-	}
-
-	if (cmem_alvs.conn_info_result.bound == true) {
-		alvs_write_log(LOG_DEBUG, "connection %d is already bound (other thread performed the bind before)", conn_index);
-		return 0;
+	if (alvs_conn_info_lookup(conn_index) == 0 && cmem_alvs.conn_info_result.bound == false) {
+		cmem_alvs.conn_info_result.bind_gen = server_config_gen;
+		(void)alvs_conn_info_modify(conn_index);
 	}
 
-	/* turn on the aging bit */
-	cmem_alvs.conn_info_result.server_index = server_index;
-	cmem_alvs.conn_info_result.bound = true;
-
-	rc =  ezdp_modify_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
-			conn_index,
-			&cmem_alvs.conn_info_result,
-			sizeof(struct alvs_conn_info_result),
-			EZDP_UNCONDITIONAL,
-			cmem_wa.alvs_wa.conn_info_table_wa,
-			sizeof(cmem_wa.alvs_wa.conn_info_table_wa));
-
 	/*unlock*/
 	alvs_unlock_connection(hash_value);
-	return rc;
+#endif
 }
 
 
+/******************************************************************************
+ * \brief       get the amount of aging iterations of connection in
+ *              cmem_alvs.conn_info_result. template lives persistence timeout
+ *              of its service, taken from service info DB.
+ *
+ * \return      amount of aging iterations
+ */
+static __always_inline
+int alvs_conn_get_iterations(void)
+{
+	if (alvs_conn_is_template()) {
+		if (ezdp_lookup_table_entry(&shared_cmem_alvs.service_info_struct_desc,
+					    cmem_alvs.conn_info_result.service_index,
+					    &cmem_alvs.service_info_result,
+					    sizeof(struct alvs_service_info_result), 0) == 0 &&
+		    cmem_alvs.service_info_result.persist_iterations != 0) {
+			return cmem_alvs.service_info_result.persist_iterations;
+		}
+		/*service is gone or not persistent anymore - expire template*/
+		return ALVS_TCP_CONN_ITER_NONE;
+	}
+	return alvs_util_get_conn_iterations(cmem_alvs.conn_info_result.conn_class_key.protocol,
+					     cmem_alvs.conn_info_result.conn_state);
+}
+
 /******************************************************************************
  * \brief       set connection entry aging bit to 0. this function is called only
- *              from aging mechanism.
+ *              from aging mechanism. a pending refresh bit is consumed here and
+ *              revives a connection which was marked to delete.
  *
  * \return      0 in case of success, otherwise failure.
  */
@@ -462,16 +1246,20 @@ uint32_t alvs_conn_age_out(uint32_t conn_index, uint8_t iteration_num)
 		return rc;
 	}
 
+	/* consume refresh done by data path since last aging pass */
+	if (alvs_conn_is_refreshed(conn_index)) {
+		alvs_conn_clear_refresh(conn_index);
+		cmem_alvs.conn_info_result.delete_bit = 0;
+	}
+
 	/* turn off the aging bit */
 	cmem_alvs.conn_info_result.aging_bit = 0;
-	cmem_alvs.conn_info_result.age_iteration = ezdp_mod(iteration_num,
-							    alvs_util_get_conn_iterations(cmem_alvs.conn_info_result.conn_state),
-							    0, 0);
+	cmem_alvs.conn_info_result.age_iteration = ezdp_mod(iteration_num, alvs_conn_get_iterations(), 0, 0);
 
 	rc = ezdp_modify_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
 			conn_index,
-			&cmem_alvs.conn_info_result,
-			sizeof(struct alvs_conn_info_result),
+			alvs_conn_info_entry(),
+			ALVS_CONN_INFO_ENTRY_SIZE,
 			EZDP_UNCONDITIONAL,
 			cmem_wa.alvs_wa.conn_info_table_wa,
 			sizeof(cmem_wa.alvs_wa.conn_info_table_wa));
@@ -482,40 +1270,209 @@ uint32_t alvs_conn_age_out(uint32_t conn_index, uint8_t iteration_num)
 }
 
 /******************************************************************************
- * \brief       perform routing of incoming packet that belongs to an existing
- *              connection/new connection according to the configured routing
- *              algorithm of the server. currently support only direct routing.
+ * \brief       reply to the client with ICMP fragmentation needed instead of
+ *              tunneling a frame with DF set which exceeds the tunnel MTU.
+ *              the ICMP header and its IP header are built in the headroom in
+ *              front of the inner IP header which is quoted with 8 bytes of
+ *              its payload. original frame is freed.
  *
  * \return      void
  */
 static __always_inline
-void alvs_conn_do_route(uint8_t *frame_base)
+void alvs_conn_tunnel_frag_needed(uint8_t *frame_base, in_addr_t source_ip, uint16_t mtu)
 {
-	/*transmit packet according to routing method*/
-	if (likely((cmem_alvs.server_info_result.conn_flags & IP_VS_CONN_F_FWD_MASK) == IP_VS_CONN_F_DROUTE)) {
-		if (cmem_alvs.conn_info_result.bound == true) {
-			nw_do_route(&frame,
-				    frame_base,
-				    cmem_alvs.server_info_result.server_ip,
-				    ezframe_get_buf_len(&frame));
+	uint32_t l2_size = cmem_nw.mac_decode_result.layer2_size;
+	struct iphdr *inner_ip_hdr = (struct iphdr *)(frame_base + l2_size);
+	uint32_t icmp_len = sizeof(struct icmphdr) + (inner_ip_hdr->ihl << 2) + 8;
+	uint8_t *icmp_base = frame_base - sizeof(struct iphdr) - sizeof(struct icmphdr);
+	struct iphdr *ip_hdr = (struct iphdr *)(icmp_base + l2_size);
+	struct icmphdr *icmp_hdr = (struct icmphdr *)((uint8_t *)ip_hdr + sizeof(struct iphdr));
+	in_addr_t client_ip = inner_ip_hdr->saddr;
+
+	alvs_write_log(LOG_DEBUG, "tunnel MTU %d exceeded (len = %d) - sending fragmentation needed to 0x%08x", mtu, inner_ip_hdr->tot_len, client_ip);
+	alvs_update_discard_statistics(ALVS_ERROR_TUNNEL_FRAG_NEEDED);
+
+	/*move L2 header in front of the new headers*/
+	ezdp_mem_copy(icmp_base, frame_base, l2_size);
+
+	icmp_hdr->type = ICMP_DEST_UNREACH;
+	icmp_hdr->code = ICMP_FRAG_NEEDED;
+	icmp_hdr->checksum = 0;
+	icmp_hdr->un.frag.__unused = 0;
+	icmp_hdr->un.frag.mtu = mtu - sizeof(struct iphdr);
+	icmp_hdr->checksum = alvs_util_csum((uint16_t *)icmp_hdr, icmp_len);
+
+	ip_hdr->version = 4;
+	ip_hdr->ihl = sizeof(struct iphdr) >> 2;
+	ip_hdr->tos = 0;
+	ip_hdr->tot_len = sizeof(struct iphdr) + icmp_len;
+	ip_hdr->id = 0;
+	ip_hdr->frag_off = 0;
+	ip_hdr->ttl = 64;
+	ip_hdr->protocol = IPPROTO_ICMP;
+	ip_hdr->saddr = source_ip;
+	ip_hdr->daddr = client_ip;
+	ezframe_update_ipv4_checksum(ip_hdr);
+
+	/*replace the frame with the ICMP message*/
+	ezframe_free(&frame, 0);
+	if (unlikely(ezframe_new(&frame, icmp_base, l2_size + sizeof(struct iphdr) + icmp_len, 0, EZFRAME_MOVE_BUF_TO_EMEM) != 0)) {
+		alvs_write_log(LOG_ERR, "failed to create ICMP frame: %s", ezdp_get_err_msg());
+		return;
+	}
+
+	nw_do_route(&frame,
+		    icmp_base,
+		    client_ip,
+		    l2_size + sizeof(struct iphdr) + icmp_len);
+}
+
+/******************************************************************************
+ * \brief       encapsulate frame in an outer IPv4 header (IP-in-IP) towards
+ *              the server. outer header is added in the buffer headroom, source
+ *              address is the configured tunnel source address or the state
+ *              sync source address. DF is copied from the inner header.
+ *              frames which exceed the tunnel MTU are not sent oversized: with DF
+ *              they are answered with ICMP fragmentation needed, without DF they
+ *              are counted (TUNNEL_MTU_EXCEEDED) and sent to host, which
+ *              fragments the outer packet - NPS does not fragment.
+ *
+ * \return      true if frame should be routed from *route_base, otherwise
+ *              frame was already handled.
+ */
+static __always_inline
+bool alvs_conn_tunnel_encap(uint8_t **route_base, uint32_t *route_len, in_addr_t server_ip)
+{
+	uint8_t *frame_base = *route_base;
+	uint32_t l2_size = cmem_nw.mac_decode_result.layer2_size;
+	struct iphdr *inner_ip_hdr = (struct iphdr *)(frame_base + l2_size);
+	struct iphdr *outer_ip_hdr;
+	uint8_t *tunnel_base;
+	in_addr_t source_ip = 0;
+	uint16_t mtu = ALVS_TUNNEL_DEFAULT_MTU;
+
+	if (likely(alvs_util_app_info_lookup() == 0)) {
+		source_ip = cmem_wa.alvs_wa.alvs_app_info_result.tunnel_source_ip;
+		if (source_ip == 0) {
+			source_ip = cmem_wa.alvs_wa.alvs_app_info_result.source_ip;
+		}
+		mtu = cmem_wa.alvs_wa.alvs_app_info_result.tunnel_mtu;
+	}
+	if (unlikely(source_ip == 0)) {
+		alvs_write_log(LOG_ERR, "no tunnel source IP configured");
+		alvs_discard_and_stats(ALVS_ERROR_TUNNEL_NO_SOURCE_IP);
+		return false;
+	}
+
+	/*ICMP reply is built in the headroom as well and is longer than outer header*/
+	if (unlikely(ezframe_get_buf_headroom(&frame) < sizeof(struct iphdr) + sizeof(struct icmphdr))) {
+		alvs_write_log(LOG_ERR, "no headroom for tunnel header");
+		alvs_discard_and_stats(ALVS_ERROR_TUNNEL_NO_HEADROOM);
+		return false;
+	}
+
+	if (unlikely(inner_ip_hdr->tot_len + sizeof(struct iphdr) > mtu)) {
+		if (inner_ip_hdr->frag_off & IP_DF) {
+			alvs_conn_tunnel_frag_needed(frame_base, source_ip, mtu);
 		} else {
-			nw_do_route(&frame,
-				    frame_base,
-				    cmem_alvs.conn_info_result.server_addr,
-				    ezframe_get_buf_len(&frame));
+			alvs_write_log(LOG_DEBUG, "tunnel MTU %d exceeded (len = %d) - frame sent to host", mtu, inner_ip_hdr->tot_len);
+			alvs_update_discard_statistics(ALVS_ERROR_TUNNEL_MTU_EXCEEDED);
+			nw_host_do_route(&frame);
 		}
+		return false;
+	}
+
+	tunnel_base = frame_base - sizeof(struct iphdr);
+	outer_ip_hdr = (struct iphdr *)(tunnel_base + l2_size);
+
+	/*move L2 header in front of the outer header*/
+	ezdp_mem_copy(tunnel_base, frame_base, l2_size);
+
+	outer_ip_hdr->version = 4;
+	outer_ip_hdr->ihl = sizeof(struct iphdr) >> 2;
+	outer_ip_hdr->tos = inner_ip_hdr->tos;
+	outer_ip_hdr->tot_len = inner_ip_hdr->tot_len + sizeof(struct iphdr);
+	outer_ip_hdr->id = inner_ip_hdr->id;
+	outer_ip_hdr->frag_off = inner_ip_hdr->frag_off & IP_DF;
+	outer_ip_hdr->ttl = 64;
+	outer_ip_hdr->protocol = IPPROTO_IPIP;
+	outer_ip_hdr->saddr = source_ip;
+	outer_ip_hdr->daddr = server_ip;
+	ezframe_update_ipv4_checksum(outer_ip_hdr);
+
+	*route_base = tunnel_base;
+	*route_len += sizeof(struct iphdr);
+	return true;
+}
+
+/******************************************************************************
+ * \brief       perform routing of incoming packet that belongs to an existing
+ *              connection/new connection according to the routing algorithm
+ *              of the connection. support direct routing, NAT - destination
+ *              address and port of NAT frames are rewritten to the server,
+ *              IP-in-IP tunneling and full NAT - source address and port are
+ *              rewritten to the local address and port as well.
+ *              full NAT connections are not state synced - local port is
+ *              allocated by this NPS only.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_do_route(uint8_t *frame_base)
+{
+	uint32_t fwd_method = cmem_alvs.conn_info_result.conn_flags & IP_VS_CONN_F_FWD_MASK;
+	uint8_t *route_base = frame_base;
+	uint32_t route_len = ezframe_get_buf_len(&frame);
+	in_addr_t server_ip;
+	uint16_t server_port;
+
+	if (cmem_alvs.conn_info_result.bound == true) {
+		server_ip = cmem_alvs.server_info_result.server_ip;
+		server_port = cmem_alvs.server_info_result.server_port;
 	} else {
-		alvs_write_log(LOG_ERR, "got unsupported routing algo = %d alvs_conn_do_route", cmem_alvs.server_info_result.conn_flags & IP_VS_CONN_F_FWD_MASK);
+		server_ip = cmem_alvs.conn_info_result.server_addr;
+		server_port = cmem_alvs.conn_info_result.server_port;
+	}
+
+	if (fwd_method == IP_VS_CONN_F_MASQ) {
+		alvs_util_nat_rewrite((struct iphdr *)(frame_base + cmem_nw.mac_decode_result.layer2_size), true,
+				      server_ip, server_port);
+	} else if (fwd_method == IP_VS_CONN_F_TUNNEL) {
+		if (alvs_conn_tunnel_encap(&route_base, &route_len, server_ip) == false) {
+			return;
+		}
+	} else if (fwd_method == ALVS_CONN_F_FULLNAT) {
+		alvs_util_nat_rewrite((struct iphdr *)(frame_base + cmem_nw.mac_decode_result.layer2_size), false,
+				      alvs_conn_fullnat_local_ip(), cmem_alvs.conn_info_result.local_port);
+		alvs_util_nat_rewrite((struct iphdr *)(frame_base + cmem_nw.mac_decode_result.layer2_size), true,
+				      server_ip, server_port);
+	} else if (unlikely(fwd_method != IP_VS_CONN_F_DROUTE)) {
+		alvs_write_log(LOG_ERR, "got unsupported routing algo = %d alvs_conn_do_route", fwd_method);
 		/*drop frame*/
 		alvs_discard_and_stats(ALVS_ERROR_UNSUPPORTED_ROUTING_ALGO);
 		return;
 	}
 
+	/*transmit packet to the server*/
+	if (cmem_alvs.conn_info_result.bound == true) {
+		nw_do_route_cached(&frame,
+				   route_base,
+				   server_ip,
+				   route_len,
+				   cmem_alvs.conn_info_result.server_index);
+	} else {
+		nw_do_route(&frame,
+			    route_base,
+			    server_ip,
+			    route_len);
+	}
+
 	/*update statistics*/
 	alvs_update_incoming_traffic_stats();
 
 	/*send connection state sync*/
-	if (unlikely(cmem_alvs.conn_sync_state.conn_sync_status == ALVS_CONN_SYNC_NEED)) {
+	if (unlikely(cmem_alvs.conn_sync_state.conn_sync_status == ALVS_CONN_SYNC_NEED) &&
+	    fwd_method != ALVS_CONN_F_FULLNAT) {
 		/*check application info if state sync is active*/
 		if (unlikely(alvs_util_app_info_lookup() == 0 && cmem_wa.alvs_wa.alvs_app_info_result.master_bit)) {
 			alvs_state_sync_send_single(cmem_wa.alvs_wa.alvs_app_info_result.source_ip,
@@ -534,29 +1491,40 @@ void alvs_conn_do_route(uint8_t *frame_base)
  *              5. perform routing
  *              in case of failure in any of the stages the packet will be either dropped
  *              or sent to further processing by the host.
+ *              tcp_hdr is NULL for UDP frames.
  *
  * \return        void
  */
 static __always_inline
-void alvs_conn_data_path(uint8_t *frame_base, struct tcphdr *tcp_hdr, uint32_t conn_index)
+void alvs_conn_data_path(uint8_t *frame_base, struct tcphdr *tcp_hdr, struct alvs_conn_classification_result *conn_class_res)
 {
 	uint32_t rc;
 	uint32_t server_index;
+	uint16_t server_config_gen;
+	enum alvs_tcp_conn_state new_state;
+	uint32_t conn_index = conn_class_res->conn_index;
 
 	alvs_write_log(LOG_DEBUG, "conn_idx  = %d exists (fast path)", conn_index);
 
-	/*perform lookup in conn info DB*/
-	rc = alvs_conn_info_lookup(conn_index);
+	/*get conn info*/
+	rc = alvs_conn_fast_info_lookup(conn_class_res);
 
 	if (likely(rc == 0)) {
 		if (cmem_alvs.conn_info_result.bound == false) {
-			if (alvs_find_server_index(cmem_alvs.conn_info_result.server_addr, cmem_alvs.conn_class_key.virtual_ip,
-						   cmem_alvs.conn_info_result.server_port, cmem_alvs.conn_class_key.virtual_port,
-						   cmem_alvs.conn_class_key.protocol, &server_index) == true) {
-				/* store server index in connection info */
-				alvs_write_log(LOG_DEBUG, "Server index found for conn_idx = %d, trying to bind.", conn_index);
-				if (alvs_conn_bind(conn_index, server_index) != 0) {
-					alvs_write_log(LOG_WARNING, "conn_idx  = %d,  binding server FAILED, continue as unbound.", conn_index);
+			/*read generation before lookup, a server added meanwhile changes it*/
+			server_config_gen = alvs_server_get_config_gen();
+			if (alvs_conn_bind_needed(server_config_gen)) {
+				if (alvs_find_server_index(cmem_alvs.conn_info_result.server_addr, cmem_alvs.conn_class_key.virtual_ip,
+							   cmem_alvs.conn_info_result.server_port, cmem_alvs.conn_class_key.virtual_port,
+							   cmem_alvs.conn_class_key.protocol, &server_index) == true) {
+					/* store server index in connection info */
+					alvs_write_log(LOG_DEBUG, "Server index found for conn_idx = %d, trying to bind.", conn_index);
+					if (alvs_conn_bind(conn_index, server_index) != 0) {
+						alvs_write_log(LOG_WARNING, "conn_idx  = %d,  binding server FAILED, continue as unbound.", conn_index);
+					}
+				} else {
+					alvs_write_log(LOG_DEBUG, "Server not found for conn_idx = %d, next bind attempt on server config change.", conn_index);
+					alvs_conn_bind_failed(conn_index, server_config_gen);
 				}
 			}
 		}
@@ -599,14 +1567,20 @@ void alvs_conn_data_path(uint8_t *frame_base, struct tcphdr *tcp_hdr, uint32_t c
 			}
 		}
 
-		/*check if state changed*/
-		if (tcp_hdr->rst) {
+		/*check if state changed - UDP connection has a single state*/
+		if (tcp_hdr && tcp_hdr->rst) {
 			alvs_write_log(LOG_DEBUG, "conn_idx  = %d, got RST = 1 go conn_mark_to_delete", conn_index);
 			(void)alvs_conn_mark_to_delete(conn_index, 1);
 		} else {
-			if (cmem_alvs.conn_info_result.conn_state == IP_VS_TCP_S_ESTABLISHED && tcp_hdr->fin) {
-				alvs_write_log(LOG_DEBUG, "conn_idx  = %d,  IP_VS_TCP_S_ESTABLISHED got FIN = 1 ", conn_index);
-				if (alvs_conn_update_state(conn_index, IP_VS_TCP_S_CLOSE_WAIT) != 0) {
+			if (tcp_hdr) {
+				new_state = alvs_util_get_tcp_next_state((enum alvs_tcp_conn_state)cmem_alvs.conn_info_result.conn_state, tcp_hdr);
+			} else {
+				new_state = (enum alvs_tcp_conn_state)cmem_alvs.conn_info_result.conn_state;
+			}
+
+			if (new_state != cmem_alvs.conn_info_result.conn_state) {
+				alvs_write_log(LOG_DEBUG, "conn_idx  = %d,  state %d --> %d", conn_index, cmem_alvs.conn_info_result.conn_state, new_state);
+				if (alvs_conn_update_state(conn_index, new_state) != 0) {
 					alvs_write_log(LOG_DEBUG, "conn_idx  = %d, update connection state to close FAIL", conn_index);
 					/*drop frame*/
 					alvs_discard_and_stats(ALVS_ERROR_CANT_UPDATE_CONNECTION_STATE);
@@ -615,12 +1589,7 @@ void alvs_conn_data_path(uint8_t *frame_base, struct tcphdr *tcp_hdr, uint32_t c
 			} else if (cmem_alvs.conn_info_result.aging_bit == 0) { /*check if we need to update the aging bit*/
 				/*set connection aging bit back to 1*/
 				alvs_write_log(LOG_DEBUG, "conn_idx  = %d,  Refreshing aging bit", conn_index);
-				if (alvs_conn_refresh(conn_index) != 0) {
-					alvs_write_log(LOG_DEBUG, "conn_idx  = %d,  Refreshing aging bit FAILED", conn_index);
-					/*drop frame*/
-					alvs_discard_and_stats(ALVS_ERROR_CANT_UPDATE_CONNECTION_STATE);
-					return;
-				}
+				alvs_conn_refresh(conn_index);
 			}
 		}
 
@@ -69,9 +69,17 @@ enum alvs_service_output_result {
  * ALVS definitions
  ***************************************************************/
 
-#define ALVS_TIMER_INTERVAL_SEC 16
-
 #define ALVS_SCHED_RR_RETRIES 10
+#define ALVS_SCHED_TWOS_PROBES 4
+
+/* connection classification entry is added only if absent when connection
+ * creation is not serialized by connection lock
+ */
+#ifdef ALVS_CONN_LOCKLESS_CREATE
+#define ALVS_CONN_CLASS_ADD_FLAGS 0
+#else
+#define ALVS_CONN_CLASS_ADD_FLAGS EZDP_UNCONDITIONAL
+#endif
 
 #define ALVS_STATE_SYNC_PROTO_VER        1
 #define ALVS_STATE_SYNC_HEADROOM         64
@@ -127,22 +135,39 @@ enum alvs_sched_server_result {
 struct alvs_cmem {
 	struct alvs_conn_classification_key             conn_class_key;
 	/**< conn class key */
-	struct alvs_service_classification_key          service_class_key;
-	/**< service class key */
+	/* IPv4 and IPv6 frames are not classified at the same time - saving CMEM */
+	union {
+		struct alvs_service_classification_key  service_class_key;
+		/**< service class key */
+		struct alvs_service6_classification_key service6_class_key;
+		/**< IPv6 service class key */
+	};
 	struct alvs_server_classification_key           server_class_key;
 	/**< server class key */
 	struct alvs_conn_info_result                    conn_info_result;
 	/**< connection info result */
+#ifdef ALVS_CONN_COMPACT
+	struct alvs_conn_compact_info_result            conn_compact_info_result;
+	/**< compact connection info entry */
+#endif
 	struct alvs_server_info_result                  server_info_result;
 	/**< server info result */
+	struct alvs_server6_info_result                 server6_info_result;
+	/**< IPv6 server info result */
 	struct alvs_service_info_result                 service_info_result;
 	/**< server info result */
 	struct alvs_sched_info_result                   sched_info_result;
 	/**< scheduling info result */
+	struct alvs_lblc_info_result                    lblc_info_result;
+	/**< LBLC info result */
 	ezdp_spinlock_t                                 conn_spinlock;
 	/**< connection spinlock */
 	struct alvs_conn_classification_result          conn_result;
 	/**< connection class result */
+	struct alvs_nat_classification_key              nat_class_key;
+	/**< NAT class key */
+	struct alvs_nat_classification_result           nat_result;
+	/**< NAT class result */
 	struct alvs_conn_sync_state                     conn_sync_state;
 	/**< connection state synchronization */
 } __packed;
@@ -154,13 +179,19 @@ struct alvs_cmem {
  **************************************************************************/
 union alvs_workarea {
 	char conn_hash_wa[EZDP_HASH_WORK_AREA_SIZE(sizeof(struct alvs_conn_classification_result), sizeof(struct alvs_conn_classification_key))];
+	char nat_hash_wa[EZDP_HASH_WORK_AREA_SIZE(sizeof(struct alvs_nat_classification_result), sizeof(struct alvs_nat_classification_key))];
 	char server_hash_wa[EZDP_HASH_WORK_AREA_SIZE(sizeof(struct alvs_server_classification_result), sizeof(struct alvs_server_classification_key))];
 	char service_hash_wa[EZDP_HASH_WORK_AREA_SIZE(sizeof(struct alvs_service_classification_result), sizeof(struct alvs_service_classification_key))];
+	char service6_hash_wa[EZDP_HASH_WORK_AREA_SIZE(sizeof(struct alvs_service_classification_result), sizeof(struct alvs_service6_classification_key))];
 	char conn_info_table_wa[EZDP_TABLE_WORK_AREA_SIZE(sizeof(struct alvs_conn_info_result))];
+	char lblc_info_table_wa[EZDP_TABLE_WORK_AREA_SIZE(sizeof(struct alvs_lblc_info_result))];
 	char table_struct_work_area[EZDP_TABLE_WORK_AREA_SIZE(sizeof(ezdp_table_struct_desc_t))];
 	uint64_t counter_work_area;
+	struct ezdp_tb_ctr_result tb_ctr_result;
 	struct alvs_app_info_result alvs_app_info_result;
 	/**< application info class result */
+	struct alvs_vip_filter_result vip_filter_result;
+	/**< VIP filter result */
 };
 
 /***********************************************************************//**
@@ -176,6 +207,11 @@ struct alvs_shared_cmem {
 	ezdp_hash_struct_desc_t     server_class_struct_desc;
 	ezdp_table_struct_desc_t    service_info_struct_desc;
 	ezdp_table_struct_desc_t    sched_info_struct_desc;
+	ezdp_hash_struct_desc_t     service6_class_struct_desc;
+	ezdp_table_struct_desc_t    server6_info_struct_desc;
+	ezdp_hash_struct_desc_t     nat_class_struct_desc;
+	ezdp_table_struct_desc_t    vip_filter_struct_desc;
+	ezdp_table_struct_desc_t    lblc_info_struct_desc;
 } __packed;
 
 /*************************************************************
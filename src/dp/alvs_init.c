@@ -69,6 +69,65 @@ bool init_alvs_shared_cmem(void)
 		return false;
 	}
 
+	/*Init NAT classification DB*/
+	result = ezdp_init_hash_struct_desc(STRUCT_ID_ALVS_NAT_CLASSIFICATION,
+					    &shared_cmem_alvs.nat_class_struct_desc,
+					    cmem_wa.alvs_wa.nat_hash_wa,
+					    sizeof(cmem_wa.alvs_wa.nat_hash_wa));
+	if (result != 0) {
+		printf("ezdp_init_hash_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+				STRUCT_ID_ALVS_NAT_CLASSIFICATION, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	result = ezdp_validate_hash_struct_desc(&shared_cmem_alvs.nat_class_struct_desc,
+						true,
+						sizeof(struct alvs_nat_classification_key),
+						sizeof(struct alvs_nat_classification_result));
+	if (result != 0) {
+		printf("ezdp_validate_hash_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+				STRUCT_ID_ALVS_NAT_CLASSIFICATION, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	/*Init VIP filter DB*/
+	result = ezdp_init_table_struct_desc(STRUCT_ID_ALVS_VIP_FILTER,
+					     &shared_cmem_alvs.vip_filter_struct_desc,
+					     cmem_wa.alvs_wa.table_struct_work_area,
+					     sizeof(cmem_wa.alvs_wa.table_struct_work_area));
+	if (result != 0) {
+		printf("ezdp_init_table_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+				STRUCT_ID_ALVS_VIP_FILTER, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	result = ezdp_validate_table_struct_desc(&shared_cmem_alvs.vip_filter_struct_desc,
+						 sizeof(struct alvs_vip_filter_result));
+	if (result != 0) {
+		printf("ezdp_validate_table_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+				STRUCT_ID_ALVS_VIP_FILTER, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	/*Init LBLC info DB*/
+	result = ezdp_init_table_struct_desc(STRUCT_ID_ALVS_LBLC_INFO,
+					     &shared_cmem_alvs.lblc_info_struct_desc,
+					     cmem_wa.alvs_wa.table_struct_work_area,
+					     sizeof(cmem_wa.alvs_wa.table_struct_work_area));
+	if (result != 0) {
+		printf("ezdp_init_table_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+				STRUCT_ID_ALVS_LBLC_INFO, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	result = ezdp_validate_table_struct_desc(&shared_cmem_alvs.lblc_info_struct_desc,
+						 sizeof(struct alvs_lblc_info_result));
+	if (result != 0) {
+		printf("ezdp_validate_table_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+				STRUCT_ID_ALVS_LBLC_INFO, result, ezdp_get_err_msg());
+		return false;
+	}
+
 	/*Init connection info DB*/
 	result = ezdp_init_table_struct_desc(STRUCT_ID_ALVS_CONN_INFO,
 					     &shared_cmem_alvs.conn_info_struct_desc,
@@ -187,6 +246,46 @@ bool init_alvs_shared_cmem(void)
 		return false;
 	}
 
+	/*Init IPv6 service class DB*/
+	result = ezdp_init_hash_struct_desc(STRUCT_ID_ALVS_SERVICE6_CLASSIFICATION,
+					    &shared_cmem_alvs.service6_class_struct_desc,
+					    cmem_wa.alvs_wa.service6_hash_wa,
+					    sizeof(cmem_wa.alvs_wa.service6_hash_wa));
+	if (result != 0) {
+		printf("ezdp_init_hash_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+				STRUCT_ID_ALVS_SERVICE6_CLASSIFICATION, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	result = ezdp_validate_hash_struct_desc(&shared_cmem_alvs.service6_class_struct_desc,
+						true,
+						sizeof(struct alvs_service6_classification_key),
+						sizeof(struct alvs_service_classification_result));
+	if (result != 0) {
+		printf("ezdp_validate_hash_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+				STRUCT_ID_ALVS_SERVICE6_CLASSIFICATION, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	/*Init IPv6 server info DB*/
+	result = ezdp_init_table_struct_desc(STRUCT_ID_ALVS_SERVER6_INFO,
+					     &shared_cmem_alvs.server6_info_struct_desc,
+					     cmem_wa.alvs_wa.table_struct_work_area,
+					     sizeof(cmem_wa.alvs_wa.table_struct_work_area));
+	if (result != 0) {
+		printf("ezdp_init_hash_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+				STRUCT_ID_ALVS_SERVER6_INFO, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	result = ezdp_validate_table_struct_desc(&shared_cmem_alvs.server6_info_struct_desc,
+						 sizeof(struct alvs_server6_info_result));
+	if (result != 0) {
+		printf("ezdp_validate_table_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+				STRUCT_ID_ALVS_SERVER6_INFO, result, ezdp_get_err_msg());
+		return false;
+	}
+
 	return true;
 }
 
@@ -39,19 +39,134 @@
 
 #define UDP_DEST 8848
 
-void alvs_tcp_processing(uint8_t *frame_base, struct iphdr *ip_hdr)
+/******************************************************************************
+ * \brief       check destination address in VIP filter. a miss means no IPv4
+ *              service classification entry has the address, a hit may be false
+ *              positive of another address in the same bucket.
+ *
+ * \return      true if address may be a virtual address, otherwise false
+ */
+static __always_inline
+bool alvs_vip_filter_lookup(in_addr_t daddr)
+{
+	return ezdp_lookup_table_entry(&shared_cmem_alvs.vip_filter_struct_desc,
+				       ALVS_VIP_FILTER_INDEX(daddr),
+				       &cmem_wa.alvs_wa.vip_filter_result,
+				       sizeof(struct alvs_vip_filter_result), 0) == 0 &&
+	       cmem_wa.alvs_wa.vip_filter_result.vip;
+}
+
+/******************************************************************************
+ * \brief       check source address in VIP filter. a miss means no NAT or full
+ *              NAT server has the address, so the frame can't be a reply of a
+ *              NAT connection. a hit may be false positive.
+ *
+ * \return      true if address may be a NAT server, otherwise false
+ */
+static __always_inline
+bool alvs_nat_server_filter_lookup(in_addr_t saddr)
+{
+	return ezdp_lookup_table_entry(&shared_cmem_alvs.vip_filter_struct_desc,
+				       ALVS_VIP_FILTER_INDEX(saddr),
+				       &cmem_wa.alvs_wa.vip_filter_result,
+				       sizeof(struct alvs_vip_filter_result), 0) == 0 &&
+	       cmem_wa.alvs_wa.vip_filter_result.nat_server;
+}
+
+/******************************************************************************
+ * \brief       perform NAT classification of a frame which missed connection
+ *              classification. a frame sent by the server of a NAT connection
+ *              gets the virtual address and port as its source and is routed
+ *              to the client. source port is taken from cmem_alvs.conn_class_key.
+ *              destination of a full NAT frame is the local address and port,
+ *              it is rewritten to the client taken from the connection info.
+ *
+ * \return      true if frame belongs to a NAT connection, otherwise false
+ */
+static __always_inline
+bool alvs_nat_processing(uint8_t *frame_base, struct iphdr *ip_hdr)
+{
+	uint32_t found_result_size;
+	struct alvs_nat_classification_result *nat_class_res_ptr;
+	uint32_t conn_index;
+	in_addr_t virtual_ip;
+	uint16_t virtual_port;
+	bool fullnat;
+
+	cmem_alvs.nat_class_key.server_ip = ip_hdr->saddr;
+	cmem_alvs.nat_class_key.client_ip = ip_hdr->daddr;
+	cmem_alvs.nat_class_key.server_port = cmem_alvs.conn_class_key.client_port;
+	cmem_alvs.nat_class_key.client_port = cmem_alvs.conn_class_key.virtual_port;
+	cmem_alvs.nat_class_key.protocol = ip_hdr->protocol;
+
+	if (ezdp_lookup_hash_entry(&shared_cmem_alvs.nat_class_struct_desc,
+				   (void *)&cmem_alvs.nat_class_key,
+				   sizeof(struct alvs_nat_classification_key),
+				   (void **)&nat_class_res_ptr,
+				   &found_result_size, 0,
+				   cmem_wa.alvs_wa.nat_hash_wa,
+				   sizeof(cmem_wa.alvs_wa.nat_hash_wa)) != 0) {
+		return false;
+	}
+
+	/*result resides in the work area - keep it before connection info lookup*/
+	conn_index = nat_class_res_ptr->conn_index;
+	virtual_ip = nat_class_res_ptr->virtual_ip;
+	virtual_port = nat_class_res_ptr->virtual_port;
+	fullnat = nat_class_res_ptr->fullnat;
+
+	alvs_write_log(LOG_DEBUG, "NAT connection conn_idx = %d (0x%x:%d <-- 0x%x:%d, protocol=%d)",
+		       conn_index,
+		       cmem_alvs.nat_class_key.client_ip,
+		       cmem_alvs.nat_class_key.client_port,
+		       cmem_alvs.nat_class_key.server_ip,
+		       cmem_alvs.nat_class_key.server_port,
+		       cmem_alvs.nat_class_key.protocol);
+
+	if (fullnat && alvs_conn_info_lookup(conn_index) != 0) {
+		alvs_write_log(LOG_DEBUG, "full NAT conn_idx = %d info lookup failed", conn_index);
+		return false;
+	}
+
+	/*server traffic keeps the connection alive*/
+	alvs_conn_refresh(conn_index);
+
+	alvs_util_nat_rewrite(ip_hdr, false, virtual_ip, virtual_port);
+	if (fullnat) {
+		alvs_util_nat_rewrite(ip_hdr, true,
+				      cmem_alvs.conn_info_result.conn_class_key.client_ip,
+				      cmem_alvs.conn_info_result.conn_class_key.client_port);
+	}
+
+	nw_do_route(&frame,
+		    frame_base,
+		    ip_hdr->daddr,
+		    ezframe_get_buf_len(&frame));
+	return true;
+}
+
+/******************************************************************************
+ * \brief       perform connection classification of a TCP or UDP frame and
+ *              continue to fast path or to new connection path. frames which
+ *              are not to a virtual address skip connection and service
+ *              classification.
+ *              tcp_hdr is NULL for UDP frames.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_conn_processing(uint8_t *frame_base, struct iphdr *ip_hdr,
+			  uint16_t source_port, uint16_t dest_port,
+			  struct tcphdr *tcp_hdr)
 {
 	uint32_t rc;
 	uint32_t found_result_size;
 	struct  alvs_conn_classification_result *conn_class_res_ptr;
-	struct tcphdr *tcp_hdr = (struct tcphdr *)((uint8_t *)ip_hdr + (ip_hdr->ihl << 2));
-
-	/* check if need to check validity of TCP */
 
 	cmem_alvs.conn_class_key.virtual_ip = ip_hdr->daddr;
-	cmem_alvs.conn_class_key.virtual_port = tcp_hdr->dest;
+	cmem_alvs.conn_class_key.virtual_port = dest_port;
 	cmem_alvs.conn_class_key.client_ip = ip_hdr->saddr;
-	cmem_alvs.conn_class_key.client_port = tcp_hdr->source;
+	cmem_alvs.conn_class_key.client_port = source_port;
 	cmem_alvs.conn_class_key.protocol = ip_hdr->protocol;
 
 	alvs_write_log(LOG_DEBUG, "Connection (0x%x:%d --> 0x%x:%d, protocol=%d)...",
@@ -61,6 +176,17 @@ void alvs_tcp_processing(uint8_t *frame_base, struct iphdr *ip_hdr)
 		       cmem_alvs.conn_class_key.virtual_port,
 		       cmem_alvs.conn_class_key.protocol);
 
+	if (alvs_vip_filter_lookup(ip_hdr->daddr) == false) {
+		/*not a virtual address - only frames of NAT servers are handled*/
+		if (!alvs_nat_server_filter_lookup(ip_hdr->saddr) ||
+		    !alvs_nat_processing(frame_base, ip_hdr)) {
+			alvs_write_log(LOG_DEBUG, "not a virtual address");
+			alvs_update_discard_statistics(ALVS_ERROR_SERVICE_CLASS_LOOKUP);
+			nw_host_do_route(&frame);
+		}
+		return;
+	}
+
 	rc = ezdp_lookup_hash_entry(&shared_cmem_alvs.conn_class_struct_desc,
 				    (void *)&cmem_alvs.conn_class_key,
 				    sizeof(struct alvs_conn_classification_key),
@@ -71,13 +197,32 @@ void alvs_tcp_processing(uint8_t *frame_base, struct iphdr *ip_hdr)
 
 	if (rc == 0) {
 		/*handle fast path - connection exists*/
-		alvs_conn_data_path(frame_base, tcp_hdr, conn_class_res_ptr->conn_index);
-	} else {
-		/*handle slow path  - opening new connection*/
+		alvs_conn_data_path(frame_base, tcp_hdr, conn_class_res_ptr);
+	} else if (!alvs_nat_server_filter_lookup(ip_hdr->saddr) ||
+		   !alvs_nat_processing(frame_base, ip_hdr)) {
+		/*handle slow path  - opening new connection. a frame of a NAT server to a
+		 *VIP bucket (full NAT local address, or false positive) may still be a reply
+		 */
 		alvs_unknown_packet_processing(frame_base, ip_hdr, tcp_hdr);
 	}
 }
 
+void alvs_tcp_processing(uint8_t *frame_base, struct iphdr *ip_hdr)
+{
+	struct tcphdr *tcp_hdr = (struct tcphdr *)((uint8_t *)ip_hdr + (ip_hdr->ihl << 2));
+
+	/* check if need to check validity of TCP */
+
+	alvs_conn_processing(frame_base, ip_hdr, tcp_hdr->source, tcp_hdr->dest, tcp_hdr);
+}
+
+void alvs_udp_processing(uint8_t *frame_base, struct iphdr *ip_hdr)
+{
+	struct udphdr *udp_hdr = (struct udphdr *)((uint8_t *)ip_hdr + (ip_hdr->ihl << 2));
+
+	alvs_conn_processing(frame_base, ip_hdr, udp_hdr->source, udp_hdr->dest, NULL);
+}
+
 
 /******************************************************************************
  * \brief       alvs packet processing function
@@ -104,10 +249,7 @@ void alvs_packet_processing(ezframe_t __cmem * frame, uint8_t *frame_base, uint3
 		}
 	} else if (cmem_nw.ipv4_decode_result.next_protocol.udp) {
 		if (my_mac) {
-			/* TODO - handle UDP, currently sending to host */
-			alvs_write_log(LOG_DEBUG, "UDP - NOT supported protocol");
-			nw_interface_inc_counter(NW_IF_STATS_NOT_TCP);
-			nw_host_do_route(frame);
+			alvs_udp_processing(frame_base, ip_hdr);
 		} else {
 			/* TODO - should we check that DIP is multicast? */
 			/* TODO - should we check TTL? */
@@ -131,3 +273,75 @@ void alvs_packet_processing(ezframe_t __cmem * frame, uint8_t *frame_base, uint3
 
 
 }
+
+/******************************************************************************
+ * \brief       alvs IPv6 packet processing function
+ *              perform service classification - 3 tuple - DIP, dest port, IP protocol
+ *              (or wildcard port service of the DIP) and schedule the frame. frames with extension headers, of other
+ *              protocols or of unknown services are sent to host.
+ *
+ * \return        void
+ */
+void alvs_packet6_processing(ezframe_t __cmem * frame, uint8_t *frame_base,
+			     struct ipv6hdr *ip6_hdr, bool my_mac)
+{
+	uint32_t rc;
+	uint32_t found_result_size;
+	struct alvs_service_classification_result *service_class_res_ptr;
+	struct tcphdr *tcp_hdr = NULL;
+	struct udphdr *udp_hdr;
+	uint16_t source_port;
+
+	if (!my_mac) {
+		/* Send to host */
+		alvs_write_log(LOG_DEBUG, "IPv6 - NOT supported with multicast");
+		nw_interface_inc_counter(NW_IF_STATS_NOT_MY_MAC);
+		nw_host_do_route(frame);
+		return;
+	}
+
+	if (ip6_hdr->nexthdr == IPPROTO_TCP) {
+		tcp_hdr = (struct tcphdr *)((uint8_t *)ip6_hdr + sizeof(struct ipv6hdr));
+		source_port = tcp_hdr->source;
+		cmem_alvs.service6_class_key.service_port = tcp_hdr->dest;
+	} else if (ip6_hdr->nexthdr == IPPROTO_UDP) {
+		udp_hdr = (struct udphdr *)((uint8_t *)ip6_hdr + sizeof(struct ipv6hdr));
+		source_port = udp_hdr->source;
+		cmem_alvs.service6_class_key.service_port = udp_hdr->dest;
+	} else {
+		/* Send to host */
+		alvs_write_log(LOG_DEBUG, "IPv6 - NOT supported next header %d", ip6_hdr->nexthdr);
+		nw_interface_inc_counter(NW_IF_STATS_NOT_TCP);
+		nw_host_do_route(frame);
+		return;
+	}
+
+	ezdp_mem_copy(&cmem_alvs.service6_class_key.service_address, &ip6_hdr->daddr, sizeof(struct in6_addr));
+	cmem_alvs.service6_class_key.service_protocol = ip6_hdr->nexthdr;
+
+	rc = ezdp_lookup_hash_entry(&shared_cmem_alvs.service6_class_struct_desc,
+				    (void *)&cmem_alvs.service6_class_key,
+				    sizeof(struct alvs_service6_classification_key),
+				    (void **)&service_class_res_ptr,
+				    &found_result_size, 0,
+				    cmem_wa.alvs_wa.service6_hash_wa,
+				    sizeof(cmem_wa.alvs_wa.service6_hash_wa));
+	if (rc != 0 && cmem_alvs.service6_class_key.service_port != 0) {
+		/*no service of the port - try wildcard port service of the address*/
+		cmem_alvs.service6_class_key.service_port = 0;
+		rc = ezdp_lookup_hash_entry(&shared_cmem_alvs.service6_class_struct_desc,
+					    (void *)&cmem_alvs.service6_class_key,
+					    sizeof(struct alvs_service6_classification_key),
+					    (void **)&service_class_res_ptr,
+					    &found_result_size, 0,
+					    cmem_wa.alvs_wa.service6_hash_wa,
+					    sizeof(cmem_wa.alvs_wa.service6_hash_wa));
+	}
+	if (likely(rc == 0)) {
+		alvs_service6_data_path(service_class_res_ptr, frame_base, ip6_hdr, source_port, tcp_hdr);
+	} else {
+		alvs_write_log(LOG_DEBUG, "fail IPv6 service classification lookup");
+		alvs_update_discard_statistics(ALVS_ERROR_SERVICE_CLASS_LOOKUP);
+		nw_host_do_route(frame);
+	}
+}
@@ -37,6 +37,7 @@
 #define ALVS_PACKET_PROCESSING_H_
 
 #include <linux/ip.h>
+#include <linux/ipv6.h>
 #include <linux/tcp.h>
 #include "defs.h"
 #include "global_defs.h"
@@ -46,12 +47,16 @@
 /*prototypes*/
 void alvs_packet_processing(ezframe_t __cmem * frame, uint8_t *frame_base, uint32_t buflen,
 			    struct iphdr *ip_hdr, bool my_mac) __fast_path_code;
+void alvs_packet6_processing(ezframe_t __cmem * frame, uint8_t *frame_base,
+			     struct ipv6hdr *ip6_hdr, bool my_mac) __fast_path_code;
 
 /******************************************************************************
  * \brief       alvs unknown packet processing
  *              perform service classification - 3 tuple - DIP, dest port, IP protocol
+ *              with fallback to wildcard port service (dest port 0) of the DIP.
  *              in case of failure in classification frame is sent to host, otherwise need
  *              to open new connection entry based on the scheduling algorithm and service type.
+ *              tcp_hdr is NULL for UDP frames.
  *
  * \return      void
  */
@@ -70,7 +75,7 @@ void alvs_unknown_packet_processing(uint8_t *frame_base, struct iphdr *ip_hdr, s
 			cmem_alvs.conn_class_key.protocol);
 
 	 cmem_alvs.service_class_key.service_address = ip_hdr->daddr;
-	 cmem_alvs.service_class_key.service_port = tcp_hdr->dest;
+	 cmem_alvs.service_class_key.service_port = cmem_alvs.conn_class_key.virtual_port;
 	 cmem_alvs.service_class_key.service_protocol = ip_hdr->protocol;
 
 	 rc = ezdp_lookup_hash_entry(&shared_cmem_alvs.service_class_struct_desc,
@@ -80,9 +85,20 @@ void alvs_unknown_packet_processing(uint8_t *frame_base, struct iphdr *ip_hdr, s
 				     &found_result_size, 0,
 				     cmem_wa.alvs_wa.service_hash_wa,
 				     sizeof(cmem_wa.alvs_wa.service_hash_wa));
+	if (rc != 0 && cmem_alvs.service_class_key.service_port != 0) {
+		/*no service of the port - try wildcard port service of the address*/
+		cmem_alvs.service_class_key.service_port = 0;
+		rc = ezdp_lookup_hash_entry(&shared_cmem_alvs.service_class_struct_desc,
+					    (void *)&cmem_alvs.service_class_key,
+					    sizeof(struct alvs_service_classification_key),
+					    (void **)&service_class_res_ptr,
+					    &found_result_size, 0,
+					    cmem_wa.alvs_wa.service_hash_wa,
+					    sizeof(cmem_wa.alvs_wa.service_hash_wa));
+	}
 
 	if (likely(rc == 0)) {
-		enum alvs_service_output_result	service_data_path_res = alvs_service_data_path(service_class_res_ptr->service_index,
+		enum alvs_service_output_result	service_data_path_res = alvs_service_data_path(service_class_res_ptr,
 											       ip_hdr,
 											       tcp_hdr);
 		if (service_data_path_res == ALVS_SERVICE_DATA_PATH_SUCCESS) {
@@ -90,7 +106,7 @@ void alvs_unknown_packet_processing(uint8_t *frame_base, struct iphdr *ip_hdr, s
 			alvs_conn_do_route(frame_base);
 		} else if (service_data_path_res == ALVS_SERVICE_DATA_PATH_RETRY) {
 			/*all other packets tried to open new connection go through regular fast path*/
-			alvs_conn_data_path(frame_base, tcp_hdr, cmem_alvs.conn_result.conn_index);
+			alvs_conn_data_path(frame_base, tcp_hdr, &cmem_alvs.conn_result);
 		} /* all other cases - drop or sent to host - packet was already processed. */
 	} else {
 		alvs_write_log(LOG_DEBUG, "fail service classification lookup");
@@ -119,6 +119,33 @@ uint32_t alvs_sched_sh_get_scheduling_index(uint32_t sip, uint16_t sport)
 	return final_hash;
 }
 
+/******************************************************************************
+ * \brief       get server info of the server in cmem_alvs.sched_info_result and
+ *              account the new connection on it (overload check).
+ *
+ * \return      return alvs_sched_server_result:
+ *                      ALVS_SCHED_SERVER_SUCCESS - successfully retrieved the server info.
+ *                      ALVS_SCHED_SERVER_FAILED - failed to get the server info. frame discarded.
+ *                      ALVS_SCHED_SERVER_UNAVAILABLE - the selected server is unavailable.
+ */
+static __always_inline
+enum alvs_sched_server_result alvs_sched_get_sched_server_info(uint8_t service_index)
+{
+	/*perform a look in the server info DB*/
+	alvs_write_log(LOG_DEBUG, "service_idx = %d, server_idx = %d", service_index, cmem_alvs.sched_info_result.server_index);
+	if (unlikely(alvs_server_info_lookup(cmem_alvs.sched_info_result.server_index))) {
+		/*server info lookup failed*/
+		alvs_write_log(LOG_ERR, "service_idx = %d, server_idx = %d server_info_lookup FAILED", service_index, cmem_alvs.sched_info_result.server_index);
+		alvs_discard_and_stats(ALVS_ERROR_SERVER_INFO_LKUP_FAIL);
+		return ALVS_SCHED_SERVER_FAILED;
+	}
+	if (alvs_server_overload_on_create_conn(cmem_alvs.sched_info_result.server_index) & IP_VS_DEST_F_OVERLOAD) {
+		alvs_write_log(LOG_DEBUG, "service_idx = %d, server_idx = %d is unavailable", service_index, cmem_alvs.sched_info_result.server_index);
+		return ALVS_SCHED_SERVER_UNAVAILABLE;
+	}
+	return ALVS_SCHED_SERVER_SUCCESS;
+}
+
 /******************************************************************************
  * \brief       use the given scheduling index to get a server info. the server
  *              index is retrieved by a scheduling index lookup and we perform
@@ -143,19 +170,7 @@ enum alvs_sched_server_result alvs_sched_get_server_info(uint8_t service_index,
 
 	/*schedule info lookup succeeded*/
 	if (likely(rc == 0)) {
-		/*perform a look in the server info DB*/
-		alvs_write_log(LOG_DEBUG, "service_idx = %d, server_idx = %d", service_index, cmem_alvs.sched_info_result.server_index);
-		if (unlikely(alvs_server_info_lookup(cmem_alvs.sched_info_result.server_index))) {
-			/*server info lookup failed*/
-			alvs_write_log(LOG_ERR, "service_idx = %d, server_idx = %d server_info_lookup FAILED", service_index, cmem_alvs.sched_info_result.server_index);
-			alvs_discard_and_stats(ALVS_ERROR_SERVER_INFO_LKUP_FAIL);
-			return ALVS_SCHED_SERVER_FAILED;
-		}
-		if (alvs_server_overload_on_create_conn(cmem_alvs.sched_info_result.server_index) & IP_VS_DEST_F_OVERLOAD) {
-			alvs_write_log(LOG_DEBUG, "service_idx = %d, server_idx = %d is unavailable", service_index, cmem_alvs.sched_info_result.server_index);
-			return ALVS_SCHED_SERVER_UNAVAILABLE;
-		}
-		return ALVS_SCHED_SERVER_SUCCESS;
+		return alvs_sched_get_sched_server_info(service_index);
 	}
 
 	/*schedule info lookup failed*/
@@ -223,6 +238,42 @@ bool alvs_sched_sh_schedule_connection(uint8_t service_index, uint32_t sip, uint
 	return false;
 }
 
+/******************************************************************************
+ * \brief       try to pick destination server for connection with destination hash
+ *              algorithm. the bucket of the service is filled as for source hash
+ *              and the scheduling index is the hash of the destination address,
+ *              so a destination always hits the same server. as in IPVS there is
+ *              no fallback for an unavailable server.
+ *
+ * \return      return true in case scheduling was successful, false otherwise
+ */
+static __always_inline
+bool alvs_sched_dh_schedule_connection(uint8_t service_index, uint32_t dip)
+{
+	enum alvs_sched_server_result sched_server_result;
+	uint32_t final_hash;
+
+	final_hash = alvs_sched_sh_get_scheduling_index(dip, 0);
+	alvs_write_log(LOG_DEBUG, "dip = 0x%x, hash_value = 0x%x", dip, final_hash);
+
+	sched_server_result = alvs_sched_get_server_info(service_index, service_index * ALVS_SIZE_OF_SCHED_BUCKET + final_hash);
+	if (likely(sched_server_result == ALVS_SCHED_SERVER_SUCCESS)) {
+		return true;
+	}
+
+	/* drop frame and update statistics for special cases */
+	if (unlikely(sched_server_result == ALVS_SCHED_SERVER_UNAVAILABLE)) {
+		alvs_discard_and_stats(ALVS_ERROR_SERVER_IS_UNAVAILABLE);
+	} else if (unlikely(sched_server_result == ALVS_SCHED_SERVER_EMPTY)) {
+		/*such case can happen only if during scheduling all the available servers were removed*/
+		alvs_sched_handle_no_active_servers();
+		return false;
+	}
+
+	alvs_write_log(LOG_ERR, "service_idx = %d dh_schedule_connection FAILED", service_index);
+	return false;
+}
+
 /******************************************************************************
  * \brief       try to pick destination server for connection with round robin algorithm.
  *              using round robin algorithm and sched info DB and a service sched
@@ -288,4 +339,455 @@ fail_out:
 	return false;
 }
 
+/******************************************************************************
+ * \brief       read a connection counter of the server of cmem_alvs.server_info_result.
+ *              a server can not hold more connections than connection DB - a
+ *              larger value is a wrapped counter and is read as 0, so the server
+ *              is not starved by schedulers.
+ *
+ * \return      number of connections
+ */
+static __always_inline
+uint64_t alvs_sched_read_server_conns(uint32_t counter_offset)
+{
+	ezdp_read_single_ctr(cmem_alvs.server_info_result.server_on_demand_stats_base + counter_offset,
+			     &cmem_wa.alvs_wa.counter_work_area);
+	if (unlikely(cmem_wa.alvs_wa.counter_work_area > ALVS_CONN_MAX_ENTRIES)) {
+		alvs_write_log(LOG_ERR, "server connection counter (offset %d) wrapped", counter_offset);
+		return 0;
+	}
+	return cmem_wa.alvs_wa.counter_work_area;
+}
+
+/******************************************************************************
+ * \brief       get the overhead of the server of cmem_alvs.server_info_result
+ *              as IPVS schedulers do:
+ *                      LC/WLC - active connections are 256 times heavier than
+ *                               inactive ones.
+ *                      SED/NQ - expected delay, active connections + 1.
+ *
+ * \return      server overhead
+ */
+static __always_inline
+uint64_t alvs_sched_lc_get_server_overhead(enum alvs_scheduler_type sched_alg)
+{
+	uint64_t active_conns;
+
+	active_conns = alvs_sched_read_server_conns(ALVS_SERVER_STATS_ACTIVE_CONN_ON_DEMAND_OFFSET);
+	if (sched_alg == ALVS_SHORTEST_EXPECTED_DELAY_SCHEDULER || sched_alg == ALVS_NEVER_QUEUE_SCHEDULER) {
+		return active_conns + 1;
+	}
+
+	return (active_conns << 8) + alvs_sched_read_server_conns(ALVS_SERVER_STATS_INACTIVE_CONN_ON_DEMAND_OFFSET);
+}
+
+/******************************************************************************
+ * \brief       scan sched info DB of the service with a least connection
+ *              algorithm (LC, WLC, SED or NQ). sched info DB of the service holds
+ *              every server once (with its weight) - the server with the minimal
+ *              overhead (overhead / weight for all but LC) is picked. NQ picks the
+ *              first server without active connections if there is one.
+ *              overloaded servers are skipped.
+ *
+ * \return      sched entry of the picked server, ALVS_SIZE_OF_SCHED_BUCKET if
+ *              all servers are overloaded.
+ */
+static __always_inline
+uint16_t alvs_sched_lc_get_min_entry(uint8_t service_index, enum alvs_scheduler_type sched_alg)
+{
+	uint64_t overhead, min_overhead = 0;
+	uint16_t weight, min_weight = 1;
+	uint16_t ind, min_ind = ALVS_SIZE_OF_SCHED_BUCKET;
+
+	for (ind = 0; ind < cmem_alvs.service_info_result.sched_entries_count; ind++) {
+		if (unlikely(alvs_server_sched_lookup(service_index * ALVS_SIZE_OF_SCHED_BUCKET + ind))) {
+			/*server was removed during scheduling*/
+			continue;
+		}
+		weight = (sched_alg == ALVS_LEAST_CONNECTION_SCHEDULER) ? 1 : cmem_alvs.sched_info_result.weight;
+		if (unlikely(weight == 0)) {
+			continue;
+		}
+		if (unlikely(alvs_server_info_lookup(cmem_alvs.sched_info_result.server_index))) {
+			continue;
+		}
+		if (ezdp_atomic_read32_sum_addr(cmem_alvs.server_info_result.server_flags_dp_base) & IP_VS_DEST_F_OVERLOAD) {
+			continue;
+		}
+		overhead = alvs_sched_lc_get_server_overhead(sched_alg);
+		if (sched_alg == ALVS_NEVER_QUEUE_SCHEDULER && overhead == 1) {
+			/*idle server - no queue*/
+			min_ind = ind;
+			break;
+		}
+		/* overhead / weight < min_overhead / min_weight */
+		if (min_ind == ALVS_SIZE_OF_SCHED_BUCKET || overhead * min_weight < min_overhead * weight) {
+			min_ind = ind;
+			min_overhead = overhead;
+			min_weight = weight;
+		}
+	}
+	alvs_write_log(LOG_DEBUG, "service_idx = %d, sched_alg = %d, entries = %d, entry_index = %d",
+		       service_index, sched_alg, cmem_alvs.service_info_result.sched_entries_count, min_ind);
+
+	return min_ind;
+}
+
+/******************************************************************************
+ * \brief       try to pick destination server for connection with a least
+ *              connection algorithm (LC, WLC, SED or NQ).
+ *
+ * \return      return true in case scheduling was successful, false otherwise
+ */
+static __always_inline
+bool alvs_sched_lc_schedule_connection(uint8_t service_index, enum alvs_scheduler_type sched_alg)
+{
+	enum alvs_sched_server_result sched_server_result;
+	uint16_t min_ind;
+
+	min_ind = alvs_sched_lc_get_min_entry(service_index, sched_alg);
+	if (unlikely(min_ind == ALVS_SIZE_OF_SCHED_BUCKET)) {
+		/*all servers are overloaded*/
+		alvs_discard_and_stats(ALVS_ERROR_SERVER_IS_UNAVAILABLE);
+		return false;
+	}
+
+	sched_server_result = alvs_sched_get_server_info(service_index, service_index * ALVS_SIZE_OF_SCHED_BUCKET + min_ind);
+	if (likely(sched_server_result == ALVS_SCHED_SERVER_SUCCESS)) {
+		return true;
+	}
+
+	/* drop frame and update statistics for special cases */
+	if (unlikely(sched_server_result == ALVS_SCHED_SERVER_UNAVAILABLE)) {
+		alvs_discard_and_stats(ALVS_ERROR_SERVER_IS_UNAVAILABLE);
+	} else if (unlikely(sched_server_result == ALVS_SCHED_SERVER_EMPTY)) {
+		alvs_discard_and_stats(ALVS_ERROR_SCHEDULING_FAIL);
+	}
+
+	alvs_write_log(LOG_ERR, "service_idx = %d lc_schedule_connection FAILED", service_index);
+	return false;
+}
+
+/******************************************************************************
+ * \brief       try to pick destination server for connection with two random
+ *              choices algorithm (IPVS twos). sched info DB of the service is
+ *              filled by weight as for source hash - two random entries are
+ *              picked and the server with the lower overhead / weight of the two
+ *              is used. random entries are a hash of the service sched counter
+ *              and the client address and port.
+ *
+ * \return      return true in case scheduling was successful, false otherwise
+ */
+static __always_inline
+bool alvs_sched_twos_schedule_connection(uint8_t service_index, uint32_t sip, uint16_t sport)
+{
+	enum alvs_sched_server_result sched_server_result = ALVS_SCHED_SERVER_UNAVAILABLE;
+	uint16_t sched_index[2];
+	uint64_t overhead[2] = {0, 0};
+	uint16_t weight[2] = {0, 0};
+	uint32_t sched_count, final_hash;
+	uint32_t server_index[2] = {ALVS_SERVERS_MAX_ENTRIES, ALVS_SERVERS_MAX_ENTRIES};
+	uint8_t i, first, probes;
+
+	sched_count = ezdp_atomic_read_and_inc32_sum_addr(cmem_alvs.service_info_result.service_sched_ctr, NULL);
+	final_hash = ezdp_hash(sched_count,
+			       sip ^ sport,
+			       2 * LOG2(ALVS_SIZE_OF_SCHED_BUCKET),
+			       sizeof(sched_count) + sizeof(sip),
+			       0,
+			       EZDP_HASH_BASE_MATRIX_HASH_BASE_MATRIX_0,
+			       EZDP_HASH_PERMUTATION_1);
+	sched_index[0] = final_hash & (ALVS_SIZE_OF_SCHED_BUCKET - 1);
+	sched_index[1] = (final_hash >> LOG2(ALVS_SIZE_OF_SCHED_BUCKET)) & (ALVS_SIZE_OF_SCHED_BUCKET - 1);
+
+	for (i = 0; i < 2; i++) {
+		if (unlikely(alvs_server_sched_lookup(service_index * ALVS_SIZE_OF_SCHED_BUCKET + sched_index[i]))) {
+			continue;
+		}
+		/* entries of a server are spread over the bucket by weight - probe next
+		 * entries so the second choice is another server
+		 */
+		for (probes = 0; i == 1 && probes < ALVS_SCHED_TWOS_PROBES &&
+		     cmem_alvs.sched_info_result.server_index == server_index[0]; probes++) {
+			sched_index[1] = (sched_index[1] + 1) & (ALVS_SIZE_OF_SCHED_BUCKET - 1);
+			if (unlikely(alvs_server_sched_lookup(service_index * ALVS_SIZE_OF_SCHED_BUCKET + sched_index[1]))) {
+				break;
+			}
+		}
+		if (i == 1 && cmem_alvs.sched_info_result.server_index == server_index[0]) {
+			/*no other server around - single choice*/
+			continue;
+		}
+		server_index[i] = cmem_alvs.sched_info_result.server_index;
+		if (unlikely(alvs_server_info_lookup(cmem_alvs.sched_info_result.server_index))) {
+			continue;
+		}
+		if (ezdp_atomic_read32_sum_addr(cmem_alvs.server_info_result.server_flags_dp_base) & IP_VS_DEST_F_OVERLOAD) {
+			continue;
+		}
+		overhead[i] = alvs_sched_lc_get_server_overhead(ALVS_WEIGHTED_LEAST_CONNECTION_SCHEDULER);
+		weight[i] = cmem_alvs.sched_info_result.weight;
+	}
+	/* weight 0 - server is not available. otherwise overhead[1] / weight[1] < overhead[0] / weight[0] */
+	first = (weight[0] == 0 || (weight[1] != 0 && overhead[1] * weight[0] < overhead[0] * weight[1])) ? 1 : 0;
+	alvs_write_log(LOG_DEBUG, "service_idx = %d, sched_count = %d, entries = %d,%d, picked = %d",
+		       service_index, sched_count, sched_index[0], sched_index[1], sched_index[first]);
+
+	for (i = 0; i < 2; i++) {
+		if (weight[first ^ i] == 0) {
+			continue;
+		}
+		sched_server_result = alvs_sched_get_server_info(service_index, service_index * ALVS_SIZE_OF_SCHED_BUCKET + sched_index[first ^ i]);
+		if (likely(sched_server_result == ALVS_SCHED_SERVER_SUCCESS)) {
+			return true;
+		}
+		/* try the other server only if the picked one got overloaded */
+		if (sched_server_result != ALVS_SCHED_SERVER_UNAVAILABLE) {
+			break;
+		}
+	}
+
+	/* drop frame and update statistics for special cases */
+	if (unlikely(sched_server_result == ALVS_SCHED_SERVER_UNAVAILABLE)) {
+		alvs_discard_and_stats(ALVS_ERROR_SERVER_IS_UNAVAILABLE);
+	} else if (unlikely(sched_server_result == ALVS_SCHED_SERVER_EMPTY)) {
+		alvs_sched_handle_no_active_servers();
+		return false;
+	}
+
+	alvs_write_log(LOG_ERR, "service_idx = %d twos_schedule_connection FAILED", service_index);
+	return false;
+}
+
+/******************************************************************************
+ * \brief       get LBLC info entry index of a destination of a service.
+ *
+ * \return      LBLC info entry index
+ */
+static __always_inline
+uint32_t alvs_sched_lblc_get_index(uint8_t service_index, in_addr_t dip)
+{
+	return ezdp_hash(dip,
+			 service_index,
+			 LOG2(ALVS_LBLC_MAX_ENTRIES),
+			 sizeof(dip) + sizeof(uint32_t),
+			 0,
+			 EZDP_HASH_BASE_MATRIX_HASH_BASE_MATRIX_0,
+			 EZDP_HASH_PERMUTATION_2);
+}
+
+/******************************************************************************
+ * \brief       lookup LBLC info entry to cmem_alvs.lblc_info_result
+ *
+ * \return      return 0 in case of success, otherwise no match.
+ */
+static __always_inline
+uint32_t alvs_sched_lblc_info_lookup(uint32_t lblc_index)
+{
+	return ezdp_lookup_table_entry(&shared_cmem_alvs.lblc_info_struct_desc,
+				       lblc_index, &cmem_alvs.lblc_info_result,
+				       sizeof(struct alvs_lblc_info_result), 0);
+}
+
+/******************************************************************************
+ * \brief       write cmem_alvs.lblc_info_result to LBLC info entry
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_sched_lblc_info_write(uint32_t lblc_index)
+{
+	(void)ezdp_add_table_entry(&shared_cmem_alvs.lblc_info_struct_desc,
+				   lblc_index,
+				   &cmem_alvs.lblc_info_result,
+				   sizeof(struct alvs_lblc_info_result),
+				   EZDP_UNCONDITIONAL,
+				   cmem_wa.alvs_wa.lblc_info_table_wa,
+				   sizeof(cmem_wa.alvs_wa.lblc_info_table_wa));
+}
+
+/******************************************************************************
+ * \brief       drop servers of cmem_alvs.lblc_info_result which are no longer
+ *              servers of the service and refresh weights of the others. called
+ *              only when server configuration changed since the entry was
+ *              validated.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_sched_lblc_validate_servers(uint8_t service_index)
+{
+	struct alvs_lblc_server *servers = cmem_alvs.lblc_info_result.servers;
+	uint16_t found = 0;
+	uint16_t ind;
+	uint8_t i, count = 0;
+
+	for (ind = 0; ind < cmem_alvs.service_info_result.sched_entries_count; ind++) {
+		if (unlikely(alvs_server_sched_lookup(service_index * ALVS_SIZE_OF_SCHED_BUCKET + ind))) {
+			continue;
+		}
+		for (i = 0; i < cmem_alvs.lblc_info_result.server_count; i++) {
+			if (servers[i].server_index == cmem_alvs.sched_info_result.server_index) {
+				servers[i].weight = cmem_alvs.sched_info_result.weight;
+				found |= 1 << i;
+			}
+		}
+	}
+
+	for (i = 0; i < cmem_alvs.lblc_info_result.server_count; i++) {
+		if ((found & (1 << i)) && servers[i].weight != 0) {
+			servers[count++] = servers[i];
+		}
+	}
+	alvs_write_log(LOG_DEBUG, "service_idx = %d, dest = 0x%x, %d of %d servers are valid",
+		       service_index, cmem_alvs.lblc_info_result.dest_ip, count, cmem_alvs.lblc_info_result.server_count);
+	cmem_alvs.lblc_info_result.server_count = count;
+}
+
+/******************************************************************************
+ * \brief       pick the least loaded (weighted) server which is not overloaded out
+ *              of the servers assigned to the destination.
+ *
+ * \return      index in cmem_alvs.lblc_info_result.servers of the picked server,
+ *              ALVS_LBLC_MAX_SERVERS if all assigned servers are overloaded.
+ */
+static __always_inline
+uint8_t alvs_sched_lblc_get_min_server(void)
+{
+	struct alvs_lblc_server *servers = cmem_alvs.lblc_info_result.servers;
+	uint64_t overhead, min_overhead = 0;
+	uint8_t i, min_i = ALVS_LBLC_MAX_SERVERS;
+
+	for (i = 0; i < cmem_alvs.lblc_info_result.server_count; i++) {
+		if (unlikely(alvs_server_info_lookup(servers[i].server_index))) {
+			continue;
+		}
+		if (ezdp_atomic_read32_sum_addr(cmem_alvs.server_info_result.server_flags_dp_base) & IP_VS_DEST_F_OVERLOAD) {
+			continue;
+		}
+		overhead = alvs_sched_lc_get_server_overhead(ALVS_WEIGHTED_LEAST_CONNECTION_SCHEDULER);
+		/* overhead / weight < min_overhead / min_weight */
+		if (min_i == ALVS_LBLC_MAX_SERVERS || overhead * servers[min_i].weight < min_overhead * servers[i].weight) {
+			min_i = i;
+			min_overhead = overhead;
+		}
+	}
+	return min_i;
+}
+
+/******************************************************************************
+ * \brief       try to pick destination server for connection with locality based
+ *              least connection algorithm. LBLC info DB keeps the servers assigned
+ *              to the destination address:
+ *                      a new destination is assigned the WLC server of the service.
+ *                      LBLC - destination is reassigned the WLC server when its
+ *                             server is overloaded.
+ *                      LBLCR - the least loaded of the assigned servers is picked.
+ *                              when all of them are overloaded the WLC server is
+ *                              added as a replica (replacing the previous one).
+ *              entry is written when servers are changed or to refresh its age.
+ *
+ * \return      return true in case scheduling was successful, false otherwise
+ */
+static __always_inline
+bool alvs_sched_lblc_schedule_connection(uint8_t service_index, in_addr_t dip, bool replication)
+{
+	enum alvs_sched_server_result sched_server_result;
+	uint32_t lblc_index = alvs_sched_lblc_get_index(service_index, dip);
+	uint16_t server_config_gen = alvs_server_get_config_gen();
+	bool modified = false;
+	uint16_t min_ind;
+	uint8_t min_i;
+
+	if (alvs_sched_lblc_info_lookup(lblc_index) != 0 ||
+	    cmem_alvs.lblc_info_result.service_index != service_index ||
+	    cmem_alvs.lblc_info_result.dest_ip != dip) {
+		/*new destination*/
+		ezdp_mem_set(&cmem_alvs.lblc_info_result, 0, sizeof(struct alvs_lblc_info_result));
+		cmem_alvs.lblc_info_result.service_index = service_index;
+		cmem_alvs.lblc_info_result.dest_ip = dip;
+		cmem_alvs.lblc_info_result.server_config_gen = server_config_gen;
+		modified = true;
+	} else if (unlikely(cmem_alvs.lblc_info_result.server_config_gen != server_config_gen)) {
+		alvs_sched_lblc_validate_servers(service_index);
+		cmem_alvs.lblc_info_result.server_config_gen = server_config_gen;
+		modified = true;
+	}
+
+	min_i = alvs_sched_lblc_get_min_server();
+	if (min_i == ALVS_LBLC_MAX_SERVERS) {
+		/*no assigned server is available - assign the WLC server*/
+		min_ind = alvs_sched_lc_get_min_entry(service_index, ALVS_WEIGHTED_LEAST_CONNECTION_SCHEDULER);
+		if (unlikely(min_ind == ALVS_SIZE_OF_SCHED_BUCKET)) {
+			/*all servers are overloaded*/
+			alvs_discard_and_stats(ALVS_ERROR_SERVER_IS_UNAVAILABLE);
+			return false;
+		}
+		if (unlikely(alvs_server_sched_lookup(service_index * ALVS_SIZE_OF_SCHED_BUCKET + min_ind))) {
+			alvs_discard_and_stats(ALVS_ERROR_SCHEDULING_FAIL);
+			return false;
+		}
+		if (replication && cmem_alvs.lblc_info_result.server_count < ALVS_LBLC_MAX_SERVERS) {
+			min_i = cmem_alvs.lblc_info_result.server_count++;
+		} else {
+			/*LBLC reassigns the server, LBLCR replaces the replica*/
+			min_i = replication ? ALVS_LBLC_MAX_SERVERS - 1 : 0;
+			cmem_alvs.lblc_info_result.server_count = min_i + 1;
+		}
+		cmem_alvs.lblc_info_result.servers[min_i].server_index = cmem_alvs.sched_info_result.server_index;
+		cmem_alvs.lblc_info_result.servers[min_i].weight = cmem_alvs.sched_info_result.weight;
+		modified = true;
+	}
+
+	if (modified || cmem_alvs.lblc_info_result.age != ALVS_LBLC_AGING_ITERATIONS) {
+		cmem_alvs.lblc_info_result.age = ALVS_LBLC_AGING_ITERATIONS;
+		alvs_sched_lblc_info_write(lblc_index);
+	}
+	alvs_write_log(LOG_DEBUG, "service_idx = %d, dest = 0x%x, lblc_idx = %d, server_idx = %d",
+		       service_index, dip, lblc_index, cmem_alvs.lblc_info_result.servers[min_i].server_index);
+
+	cmem_alvs.sched_info_result.server_index = cmem_alvs.lblc_info_result.servers[min_i].server_index;
+	sched_server_result = alvs_sched_get_sched_server_info(service_index);
+	if (likely(sched_server_result == ALVS_SCHED_SERVER_SUCCESS)) {
+		return true;
+	}
+
+	if (unlikely(sched_server_result == ALVS_SCHED_SERVER_UNAVAILABLE)) {
+		/*server got overloaded during scheduling*/
+		alvs_discard_and_stats(ALVS_ERROR_SERVER_IS_UNAVAILABLE);
+	}
+
+	alvs_write_log(LOG_ERR, "service_idx = %d lblc_schedule_connection FAILED", service_index);
+	return false;
+}
+
+/******************************************************************************
+ * \brief       age LBLC info entry - entry which was not used for
+ *              ALVS_LBLC_AGING_ITERATIONS aging iterations is deleted.
+ *              called from aging mechanism only.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_sched_lblc_age(uint32_t lblc_index)
+{
+	if (alvs_sched_lblc_info_lookup(lblc_index) != 0) {
+		return;
+	}
+
+	if (cmem_alvs.lblc_info_result.age == 0) {
+		alvs_write_log(LOG_DEBUG, "(Aging) deleting LBLC entry = %d (service_idx = %d, dest = 0x%x)",
+			       lblc_index, cmem_alvs.lblc_info_result.service_index, cmem_alvs.lblc_info_result.dest_ip);
+		(void)ezdp_delete_table_entry(&shared_cmem_alvs.lblc_info_struct_desc,
+					      lblc_index,
+					      0,
+					      cmem_wa.alvs_wa.lblc_info_table_wa,
+					      sizeof(cmem_wa.alvs_wa.lblc_info_table_wa));
+		return;
+	}
+
+	cmem_alvs.lblc_info_result.age--;
+	alvs_sched_lblc_info_write(lblc_index);
+}
+
 #endif /*ALVS_SCHED_H_*/
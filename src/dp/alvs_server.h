@@ -68,6 +68,19 @@ uint32_t alvs_server_info_lookup(uint32_t server_index)
 
 }
 
+/******************************************************************************
+ * \brief       lookup in IPv6 server info table according to a given index
+ *
+ * \return      return 0 in case of success, otherwise no match.
+ */
+static __always_inline
+uint32_t alvs_server6_info_lookup(uint32_t server_index)
+{
+	return ezdp_lookup_table_entry(&shared_cmem_alvs.server6_info_struct_desc,
+				server_index, &cmem_alvs.server6_info_result,
+				sizeof(struct alvs_server6_info_result), 0);
+}
+
 
 /******************************************************************************
  * \brief       alvs_server_overload_on_create_conn - update overloaded flag according to
@@ -179,6 +192,15 @@ void alvs_server_overload_on_delete_conn(uint16_t server_index)
 	ezdp_read_and_dec_single_ctr(cmem_alvs.server_info_result.server_on_demand_stats_base + ALVS_SERVER_STATS_CONNECTION_TOTAL_OFFSET,
 				     1, &cmem_wa.alvs_wa.counter_work_area, 0);
 
+	/* never wrap the counter - a wrapped counter keeps the server overloaded forever */
+	if (unlikely(cmem_wa.alvs_wa.counter_work_area == 0 || cmem_wa.alvs_wa.counter_work_area > ALVS_CONN_MAX_ENTRIES)) {
+		alvs_write_log(LOG_ERR, "server_index = %d connection counter underflow", server_index);
+		ezdp_inc_single_ctr(cmem_alvs.server_info_result.server_on_demand_stats_base + ALVS_SERVER_STATS_CONNECTION_TOTAL_OFFSET,
+				    1);
+		ezdp_atomic_and32_sum_addr(cmem_alvs.server_info_result.server_flags_dp_base, ~IP_VS_DEST_F_OVERLOAD);
+		return;
+	}
+
 	if (cmem_alvs.server_info_result.u_thresh == 0) {
 		alvs_write_log(LOG_DEBUG, "cmem_alvs.server_info_result.u_thresh = l_thresh = 0");
 		ezdp_atomic_and32_sum_addr(cmem_alvs.server_info_result.server_flags_dp_base, ~IP_VS_DEST_F_OVERLOAD);
@@ -215,9 +237,22 @@ void alvs_server_overload_on_delete_conn(uint16_t server_index)
 	}
 }
 
+/******************************************************************************
+ * \brief       get server config generation. it changes whenever a server is
+ *              added, so a failed server lookup can be retried only then.
+ *
+ * \return	low 16 bits of server config generation
+ */
+static __always_inline
+uint16_t alvs_server_get_config_gen(void)
+{
+	return (uint16_t)ezdp_atomic_read32_sum_addr(BUILD_SUM_ADDR(EZDP_EXTERNAL_MS, EMEM_SERVER_CONFIG_GEN_MSID, EMEM_SERVER_CONFIG_GEN_OFFSET));
+}
+
 /******************************************************************************
  * \brief       Try to find the server index from server 5-tuple.
  *              (virtual ip, virtual port, server ip, server port, protocol)
+ *              server of a wildcard port service is found with virtual port 0.
  *
  * \return	true if server exists (index stored in server_index),
  *              false if server not exists.
@@ -251,6 +286,27 @@ bool alvs_find_server_index(in_addr_t server_ip, in_addr_t virtual_ip,
 				    &found_result_size, 0,
 				    cmem_wa.alvs_wa.server_hash_wa,
 				    sizeof(cmem_wa.alvs_wa.server_hash_wa));
+	if (rc != 0 && virtual_port != 0) {
+		/*server of wildcard port service - kept with virtual port 0, and server port 0 if not NAT*/
+		cmem_alvs.server_class_key.virtual_port = 0;
+		rc = ezdp_lookup_hash_entry(&shared_cmem_alvs.server_class_struct_desc,
+					    (void *)&cmem_alvs.server_class_key,
+					    sizeof(struct alvs_server_classification_key),
+					    (void **)&server_class_res_ptr,
+					    &found_result_size, 0,
+					    cmem_wa.alvs_wa.server_hash_wa,
+					    sizeof(cmem_wa.alvs_wa.server_hash_wa));
+		if (rc != 0 && server_port == virtual_port) {
+			cmem_alvs.server_class_key.server_port = 0;
+			rc = ezdp_lookup_hash_entry(&shared_cmem_alvs.server_class_struct_desc,
+						    (void *)&cmem_alvs.server_class_key,
+						    sizeof(struct alvs_server_classification_key),
+						    (void **)&server_class_res_ptr,
+						    &found_result_size, 0,
+						    cmem_wa.alvs_wa.server_hash_wa,
+						    sizeof(cmem_wa.alvs_wa.server_hash_wa));
+		}
+	}
 
 	if (rc != 0) {
 		/* Server not found */
@@ -36,6 +36,7 @@
 #ifndef ALVS_SERVICE_H_
 #define ALVS_SERVICE_H_
 
+#include <linux/ipv6.h>
 #include "alvs_sched.h"
 #include "alvs_conn.h"
 
@@ -52,6 +53,153 @@ uint32_t alvs_service_info_lookup(uint8_t service_index)
 				sizeof(struct alvs_service_info_result), 0);
 }
 
+/******************************************************************************
+ * \brief       get service info of a classified service to cmem_alvs.service_info_result.
+ *              with inline service info the scheduling fields are taken from the
+ *              service classification result, otherwise service info is looked up.
+ *              result should be used before any other hash lookup (work area).
+ *
+ * \return      return 0 in case of success, otherwise no match.
+ */
+static __always_inline
+uint32_t alvs_service_class_info_lookup(struct alvs_service_classification_result *service_class_res)
+{
+#ifdef ALVS_SERVICE_INLINE_INFO
+	cmem_alvs.service_info_result.sched_alg = (enum alvs_scheduler_type)service_class_res->sched_alg;
+	cmem_alvs.service_info_result.persist_iterations = service_class_res->persist_iterations;
+	cmem_alvs.service_info_result.sched_entries_count = service_class_res->sched_entries_count;
+	cmem_alvs.service_info_result.service_sched_ctr = service_class_res->service_sched_ctr;
+	cmem_alvs.service_info_result.service_flags = service_class_res->service_flags;
+	return 0;
+#else
+	return alvs_service_info_lookup(service_class_res->service_index);
+#endif
+}
+
+/******************************************************************************
+ * \brief       run the scheduling algorithm of the service. on success
+ *              sched_info_result and server_info_result hold the selected server.
+ *
+ * \return      true in case scheduling was successful, false otherwise (frame
+ *              was already dropped).
+ */
+static __always_inline
+bool alvs_service_run_scheduler(uint8_t service_index, struct iphdr *ip_hdr)
+{
+	if (likely(cmem_alvs.service_info_result.sched_alg == ALVS_SOURCE_HASH_SCHEDULER)) {
+		return alvs_sched_sh_schedule_connection(service_index, ip_hdr->saddr, cmem_alvs.conn_class_key.client_port);
+	} else if (cmem_alvs.service_info_result.sched_alg == ALVS_DESTINATION_HASH_SCHEDULER) {
+		return alvs_sched_dh_schedule_connection(service_index, ip_hdr->daddr);
+	} else if (likely(cmem_alvs.service_info_result.sched_alg == ALVS_ROUND_ROBIN_SCHEDULER)) {
+		return alvs_sched_rr_schedule_connection(service_index);
+	} else if (likely(cmem_alvs.service_info_result.sched_alg == ALVS_WEIGHTED_ROUND_ROBIN_SCHEDULER)) {
+		return alvs_sched_rr_schedule_connection(service_index);
+	} else if (cmem_alvs.service_info_result.sched_alg == ALVS_LEAST_CONNECTION_SCHEDULER ||
+		   cmem_alvs.service_info_result.sched_alg == ALVS_WEIGHTED_LEAST_CONNECTION_SCHEDULER ||
+		   cmem_alvs.service_info_result.sched_alg == ALVS_SHORTEST_EXPECTED_DELAY_SCHEDULER ||
+		   cmem_alvs.service_info_result.sched_alg == ALVS_NEVER_QUEUE_SCHEDULER) {
+		return alvs_sched_lc_schedule_connection(service_index, cmem_alvs.service_info_result.sched_alg);
+	} else if (cmem_alvs.service_info_result.sched_alg == ALVS_TWO_CHOICES_SCHEDULER) {
+		return alvs_sched_twos_schedule_connection(service_index, ip_hdr->saddr, cmem_alvs.conn_class_key.client_port);
+	} else if (cmem_alvs.service_info_result.sched_alg == ALVS_LB_LEAST_CONNECTION_SCHEDULER) {
+		return alvs_sched_lblc_schedule_connection(service_index, ip_hdr->daddr, false);
+	} else if (cmem_alvs.service_info_result.sched_alg == ALVS_LB_LEAST_CONNECTION_SCHEDULER_WITH_REPLICATION) {
+		return alvs_sched_lblc_schedule_connection(service_index, ip_hdr->daddr, true);
+	}
+
+	alvs_write_log(LOG_ERR, "unsupported scheduling algorithm");
+	/*drop frame*/
+	alvs_discard_and_stats(ALVS_ERROR_UNSUPPORTED_SCHED_ALGO);
+	return false;
+}
+
+/******************************************************************************
+ * \brief       pick destination server of a new connection. persistent service
+ *              keeps the server of the client in a persistence template - the
+ *              template server is used while it is available and not overloaded,
+ *              otherwise the scheduling algorithm picks a new server and the
+ *              template is created or rebound. on success sched_info_result and
+ *              server_info_result hold the selected server.
+ *
+ * \return      true in case scheduling was successful, false otherwise (frame
+ *              was already dropped).
+ */
+static __always_inline
+bool alvs_service_schedule_server(uint8_t service_index, struct iphdr *ip_hdr)
+{
+	uint32_t template_index;
+	uint32_t server_index;
+	bool template_found;
+
+	if (likely(cmem_alvs.service_info_result.persist_iterations == 0)) {
+		return alvs_service_run_scheduler(service_index, ip_hdr);
+	}
+
+	template_found = alvs_conn_template_lookup(&template_index, &server_index);
+	if (template_found &&
+	    alvs_server_info_lookup(server_index) == 0 &&
+	    (cmem_alvs.server_info_result.server_flags & IP_VS_DEST_F_AVAILABLE) &&
+	    !(alvs_server_overload_on_create_conn(server_index) & IP_VS_DEST_F_OVERLOAD)) {
+		alvs_write_log(LOG_DEBUG, "persistent connection scheduled to server_index = %d", server_index);
+		cmem_alvs.sched_info_result.server_index = server_index;
+		return true;
+	}
+
+	if (alvs_service_run_scheduler(service_index, ip_hdr) == false) {
+		return false;
+	}
+
+	if (template_found) {
+		alvs_conn_template_rebind(template_index, cmem_alvs.sched_info_result.server_index);
+	} else {
+		alvs_conn_template_create(service_index, cmem_alvs.sched_info_result.server_index);
+	}
+	return true;
+}
+
+/******************************************************************************
+ * \brief       schedule a single datagram of a one-packet scheduling service.
+ *              a server is picked for every datagram and no connection entry is
+ *              created, so the datagram needs no aging and no state sync.
+ *
+ * \return      return alvs_service_output_result:
+ *                      ALVS_SERVICE_DATA_PATH_IGNORE - frame was dropped
+ *                      ALVS_SERVICE_DATA_PATH_SUCCESS - server was scheduled, frame should be routed.
+ */
+static __always_inline
+enum alvs_service_output_result alvs_schedule_one_packet(uint8_t service_index,
+							 struct iphdr *ip_hdr)
+{
+	/*check if there are active servers for service*/
+	if (unlikely(alvs_sched_check_active_servers() == false)) {
+		return ALVS_SERVICE_DATA_PATH_IGNORE;
+	}
+
+	if (alvs_service_schedule_server(service_index, ip_hdr) == false) {
+		return ALVS_SERVICE_DATA_PATH_IGNORE;
+	}
+
+	/*route as a bound connection which is not kept*/
+	cmem_alvs.conn_info_result.bound = true;
+	cmem_alvs.conn_info_result.server_index = cmem_alvs.sched_info_result.server_index;
+	cmem_alvs.conn_info_result.conn_flags = cmem_alvs.server_info_result.conn_flags;
+
+	/*scheduling counted the datagram as a server connection - release it*/
+	alvs_server_overload_on_delete_conn(cmem_alvs.sched_info_result.server_index);
+
+	/*full NAT needs a local port and a server to client entry - CP does not add
+	 *full NAT servers to one-packet services
+	 */
+	if (unlikely(alvs_conn_is_fullnat())) {
+		alvs_discard_and_stats(ALVS_ERROR_UNSUPPORTED_ROUTING_ALGO);
+		return ALVS_SERVICE_DATA_PATH_IGNORE;
+	}
+
+	alvs_update_connection_statistics(1, 0, 0);
+
+	alvs_write_log(LOG_DEBUG, "One packet scheduled to server_index = %d", cmem_alvs.sched_info_result.server_index);
+	return ALVS_SERVICE_DATA_PATH_SUCCESS;
+}
 
 /******************************************************************************
  * \brief       when opening a new connection entry we first need to find the
@@ -63,6 +211,10 @@ uint32_t alvs_service_info_lookup(uint8_t service_index)
  *              same connection we use a DP spinlock and busy wait of all threads which are locked.
  *              locked threads will wait until all scheduling process is done and then will continue to
  *              regular connection data path.
+ *              when built with ALVS_CONN_LOCKLESS_CREATE no lock is taken - the connection is
+ *              scheduled optimistically and the classification entry is added only if absent.
+ *              a thread which lost the race continues to regular connection data path.
+ *              tcp_hdr is NULL for UDP - UDP connection is created in IPVS UDP NORMAL state.
  *
  * \return        return alvs_service_output_result:
  *                      ALVS_SERVICE_DATA_PATH_IGNORE - frame was sent to host or drop
@@ -70,15 +222,18 @@ uint32_t alvs_service_info_lookup(uint8_t service_index)
  *                      ALVS_SERVICE_DATA_PATH_SUCCESS - a new connection entry was created.
  */
 static __always_inline
-enum alvs_service_output_result alvs_tcp_schedule_new_connection(uint8_t service_index,
-								 struct iphdr *ip_hdr,
-								 struct tcphdr *tcp_hdr)
+enum alvs_service_output_result alvs_schedule_new_connection(uint8_t service_index,
+							     struct iphdr *ip_hdr,
+							     struct tcphdr *tcp_hdr)
 {
-	uint32_t rc;
 	enum alvs_service_output_result result;
+	enum alvs_tcp_conn_state conn_state;
+#ifndef ALVS_CONN_LOCKLESS_CREATE
+	uint32_t rc;
 	uint32_t found_result_size;
 	ezdp_hashed_key_t hash_value;
 	struct  alvs_conn_classification_result *conn_class_res_ptr;
+#endif
 
 	/*check if there are active servers for service*/
 	if (unlikely(alvs_sched_check_active_servers() == false)) {
@@ -86,6 +241,34 @@ enum alvs_service_output_result alvs_tcp_schedule_new_connection(uint8_t service
 		goto out;
 	}
 
+	/*connection becomes ESTABLISHED only when a second frame is seen - single frame flows expire fast*/
+	if (tcp_hdr) {
+		if (tcp_hdr->syn) {
+			conn_state = IP_VS_TCP_S_SYN_RECV;
+		} else if (tcp_hdr->fin || tcp_hdr->rst) {
+			conn_state = IP_VS_TCP_S_CLOSE;
+		} else {
+			conn_state = IP_VS_TCP_S_NONE;
+		}
+	} else {
+		conn_state = (enum alvs_tcp_conn_state)IP_VS_UDP_S_NORMAL;
+	}
+
+	/*limit half-open connections per service - a SYN flood on a service does not
+	 *drop SYNs of other services. keep free indexes for other connections as well -
+	 *a flood on many services can not exhaust the pool
+	 */
+	if (conn_state == IP_VS_TCP_S_SYN_RECV &&
+	    unlikely(alvs_read_half_open_statistics(service_index) >= ALVS_CONN_HALF_OPEN_PER_SERVICE ||
+		     ezdp_read_free_indexes(ALVS_CONN_INDEX_POOL_ID) < ALVS_CONN_HALF_OPEN_RESERVED_INDEXES)) {
+		alvs_write_log(LOG_DEBUG, "half-open connections limit reached, service_index = %d, free indexes = %d",
+			       service_index, ezdp_read_free_indexes(ALVS_CONN_INDEX_POOL_ID));
+		alvs_discard_and_stats(ALVS_ERROR_HALF_OPEN_LIMIT);
+		result = ALVS_SERVICE_DATA_PATH_IGNORE;
+		goto out;
+	}
+
+#ifndef ALVS_CONN_LOCKLESS_CREATE
 	/*take connection lock*/
 	alvs_lock_connection(&hash_value);
 
@@ -98,7 +281,7 @@ enum alvs_service_output_result alvs_tcp_schedule_new_connection(uint8_t service
 				    cmem_wa.alvs_wa.conn_hash_wa,
 				    sizeof(cmem_wa.alvs_wa.conn_hash_wa));
 	if (rc == 0) {
-		cmem_alvs.conn_result.conn_index = conn_class_res_ptr->conn_index;
+		ezdp_mem_copy(&cmem_alvs.conn_result, conn_class_res_ptr, sizeof(struct alvs_conn_classification_result));
 		alvs_write_log(LOG_DEBUG, "new connection was already created!!!! conn_index = %d", cmem_alvs.conn_result.conn_index);
 		result = ALVS_SERVICE_DATA_PATH_RETRY;
 		goto unlock;
@@ -109,37 +292,21 @@ enum alvs_service_output_result alvs_tcp_schedule_new_connection(uint8_t service
 		result = ALVS_SERVICE_DATA_PATH_IGNORE;
 		goto unlock;
 	}
+#endif
 
 	/*schedule connection*/
-	if (likely(cmem_alvs.service_info_result.sched_alg == ALVS_SOURCE_HASH_SCHEDULER)) {
-		if (alvs_sched_sh_schedule_connection(service_index, ip_hdr->saddr, tcp_hdr->source) == false) {
-			result = ALVS_SERVICE_DATA_PATH_IGNORE;
-			goto unlock;
-		}
-	} else if (likely(cmem_alvs.service_info_result.sched_alg == ALVS_ROUND_ROBIN_SCHEDULER)) {
-		if (alvs_sched_rr_schedule_connection(service_index) == false) {
-			result = ALVS_SERVICE_DATA_PATH_IGNORE;
-			goto unlock;
-		}
-	} else if (likely(cmem_alvs.service_info_result.sched_alg == ALVS_WEIGHTED_ROUND_ROBIN_SCHEDULER)) {
-		if (alvs_sched_rr_schedule_connection(service_index) == false) {
-			result = ALVS_SERVICE_DATA_PATH_IGNORE;
-			goto unlock;
-		}
-	} else {
-		alvs_write_log(LOG_ERR, "unsupported scheduling algorithm");
-		/*drop frame*/
-		alvs_discard_and_stats(ALVS_ERROR_UNSUPPORTED_SCHED_ALGO);
+	if (alvs_service_schedule_server(service_index, ip_hdr) == false) {
 		result = ALVS_SERVICE_DATA_PATH_IGNORE;
 		goto unlock;
 	}
 
-	result = alvs_conn_create_new_entry(true,
+	result = alvs_conn_create_new_entry(service_index,
+					    true,
 					    cmem_alvs.sched_info_result.server_index,
 					    0,
-					    ((tcp_hdr->fin || tcp_hdr->rst) ? IP_VS_TCP_S_CLOSE_WAIT : IP_VS_TCP_S_ESTABLISHED),
+					    conn_state,
 					    cmem_alvs.server_info_result.conn_flags,
-					    tcp_hdr->rst ? 1 : 0);
+					    (tcp_hdr && tcp_hdr->rst) ? 1 : 0);
 
 	/*mark connection for state sync*/
 	if (likely(result == ALVS_SERVICE_DATA_PATH_SUCCESS)) {
@@ -148,42 +315,86 @@ enum alvs_service_output_result alvs_tcp_schedule_new_connection(uint8_t service
 	}
 
 unlock:
+#ifndef ALVS_CONN_LOCKLESS_CREATE
 	alvs_unlock_connection(hash_value);
 	alvs_write_log(LOG_DEBUG, "alvs_unlock_connection");
+#endif
 out:
 	return result;
 }
 
 
 /******************************************************************************
- * \brief       perform service info lookup and try to create new connection entry
+ * \brief       handle TCP frame without SYN which missed the connection table
+ *              according to the service policy:
+ *                      ALVS_SVC_F_NON_SYN_DROP - drop the frame
+ *                      ALVS_SVC_F_NON_SYN_PUNT - send the frame to host, rate limited
+ *              without a policy the frame creates a connection as before.
+ *
+ * \return      true - frame was dropped or sent to host
+ */
+static __always_inline
+bool alvs_service_non_syn_miss(void)
+{
+	if (cmem_alvs.service_info_result.service_flags & ALVS_SVC_F_NON_SYN_DROP) {
+		alvs_discard_and_stats(ALVS_ERROR_NON_SYN_MISS_DROP);
+		return true;
+	}
+
+	if (cmem_alvs.service_info_result.service_flags & ALVS_SVC_F_NON_SYN_PUNT) {
+		ezdp_read_tb_ctr(BUILD_SUM_ADDR(EZDP_EXTERNAL_MS, EMEM_SERVER_STATS_ON_DEMAND_MSID, EMEM_STATS_ON_DEMAND_NON_SYN_TB_OFFSET),
+				 ALVS_NON_SYN_PUNT_TB_SIZE, EZDP_GREEN_TRAFFIC, &cmem_wa.alvs_wa.tb_ctr_result);
+		if (cmem_wa.alvs_wa.tb_ctr_result.color == EZDP_GREEN_TRAFFIC) {
+			nw_host_do_route(&frame);
+		} else {
+			alvs_discard_and_stats(ALVS_ERROR_NON_SYN_MISS_PUNT_LIMIT);
+		}
+		return true;
+	}
+
+	return false;
+}
+
+/******************************************************************************
+ * \brief       get service info and try to create new connection entry
  *              according to service protocol and scheduling algo.
+ *              UDP datagrams of one-packet scheduling services are scheduled
+ *              without creating a connection entry.
+ *              TCP frames without SYN follow the non-SYN miss policy of the service.
  *
  * \return      return alvs_service_output_result:
  *                      ALVS_SERVICE_DATA_PATH_IGNORE - frame was dropped or send to host
  *                      ALVS_SERVICE_DATA_PATH_RETRY - retry to transmit frame via regular connection data path
- *                      ALVS_SERVICE_DATA_PATH_SUCCESS - a new connection entry was created.
+ *                      ALVS_SERVICE_DATA_PATH_SUCCESS - a new connection entry was created (or one packet was scheduled).
  */
 static __always_inline
-enum alvs_service_output_result alvs_service_data_path(uint8_t service_index,
+enum alvs_service_output_result alvs_service_data_path(struct alvs_service_classification_result *service_class_res,
 						       struct iphdr *ip_hdr,
 						       struct tcphdr *tcp_hdr)
 {
+	uint8_t service_index = service_class_res->service_index;
 	uint32_t rc;
 
-	/*perform lookup in service info DB*/
-	rc = alvs_service_info_lookup(service_index);
+	/*get service info of the classified service*/
+	rc = alvs_service_class_info_lookup(service_class_res);
 
-	 alvs_write_log(LOG_DEBUG, "(slow path) (ip->dest = 0x%x tcp->dest = %d proto=%d) service_idx = %d",
+	 alvs_write_log(LOG_DEBUG, "(slow path) (ip->dest = 0x%x dest port = %d proto=%d) service_idx = %d",
 			ip_hdr->daddr,
-			tcp_hdr->dest,
+			cmem_alvs.conn_class_key.virtual_port,
 			ip_hdr->protocol,
 			service_index);
 	if (likely(rc == 0)) {
-		if (ip_hdr->protocol == IPPROTO_TCP) {
-			return alvs_tcp_schedule_new_connection(service_index, ip_hdr, tcp_hdr);
+		if (ip_hdr->protocol == IPPROTO_UDP &&
+		    (cmem_alvs.service_info_result.service_flags & IP_VS_SVC_F_ONEPACKET)) {
+			return alvs_schedule_one_packet(service_index, ip_hdr);
+		}
+		if (ip_hdr->protocol == IPPROTO_TCP && !tcp_hdr->syn && alvs_service_non_syn_miss()) {
+			return ALVS_SERVICE_DATA_PATH_IGNORE;
 		}
-		/*drop frame - UDP is not supported*/
+		if (ip_hdr->protocol == IPPROTO_TCP || ip_hdr->protocol == IPPROTO_UDP) {
+			return alvs_schedule_new_connection(service_index, ip_hdr, tcp_hdr);
+		}
+		/*drop frame - protocol is not supported*/
 		alvs_discard_and_stats(ALVS_ERROR_UNSUPPORTED_PROTOCOL);
 	} else {
 		/*drop frame*/
@@ -192,4 +403,84 @@ enum alvs_service_output_result alvs_service_data_path(uint8_t service_index,
 	return ALVS_SERVICE_DATA_PATH_IGNORE;
 }
 
+/******************************************************************************
+ * \brief       get service info, schedule and transmit an IPv6 frame.
+ *              IPv6 services have no connection table - every frame is scheduled
+ *              by destination hash of virtual address for a destination hash
+ *              service, otherwise by source hash of client address (and port, per
+ *              service flags). CP accepts only SH and DH schedulers for IPv6
+ *              services. frames of a flow keep reaching the same server only as
+ *              long as the servers of the service do not change - any server or
+ *              weight change remaps live flows, so CP refuses such changes once
+ *              the service forwarded traffic (alvs_db_service_servers_changeable).
+ *              only direct routing is supported. tcp_hdr is NULL for UDP frames.
+ *
+ * \return      void
+ */
+static __always_inline
+void alvs_service6_data_path(struct alvs_service_classification_result *service_class_res,
+			     uint8_t *frame_base,
+			     struct ipv6hdr *ip6_hdr,
+			     uint16_t source_port,
+			     struct tcphdr *tcp_hdr)
+{
+	uint8_t service_index = service_class_res->service_index;
+	uint32_t *saddr = (uint32_t *)&ip6_hdr->saddr;
+	uint32_t *daddr = (uint32_t *)&ip6_hdr->daddr;
+
+	if (unlikely(alvs_service_class_info_lookup(service_class_res) != 0)) {
+		/*drop frame*/
+		alvs_discard_and_stats(ALVS_ERROR_SERVICE_INFO_LOOKUP);
+		return;
+	}
+
+	/*check if there are active servers for service*/
+	if (unlikely(alvs_sched_check_active_servers() == false)) {
+		return;
+	}
+
+	if (cmem_alvs.service_info_result.sched_alg == ALVS_DESTINATION_HASH_SCHEDULER) {
+		/*fold virtual address for destination hash*/
+		if (alvs_sched_dh_schedule_connection(service_index, daddr[0] ^ daddr[1] ^ daddr[2] ^ daddr[3]) == false) {
+			return;
+		}
+	} else {
+		/*fold client address for source hash*/
+		if (alvs_sched_sh_schedule_connection(service_index, saddr[0] ^ saddr[1] ^ saddr[2] ^ saddr[3], source_port) == false) {
+			return;
+		}
+	}
+
+	/*scheduling counted the frame as a server connection - release it*/
+	alvs_server_overload_on_delete_conn(cmem_alvs.sched_info_result.server_index);
+
+	if (unlikely((cmem_alvs.server_info_result.conn_flags & IP_VS_CONN_F_FWD_MASK) != IP_VS_CONN_F_DROUTE)) {
+		alvs_write_log(LOG_ERR, "got unsupported routing algo = %d alvs_service6_data_path", cmem_alvs.server_info_result.conn_flags & IP_VS_CONN_F_FWD_MASK);
+		/*drop frame*/
+		alvs_discard_and_stats(ALVS_ERROR_UNSUPPORTED_ROUTING_ALGO);
+		return;
+	}
+
+	if (unlikely(alvs_server6_info_lookup(cmem_alvs.sched_info_result.server_index) != 0)) {
+		alvs_write_log(LOG_ERR, "server_idx = %d server6_info_lookup FAILED", cmem_alvs.sched_info_result.server_index);
+		/*drop frame*/
+		alvs_discard_and_stats(ALVS_ERROR_SERVER_INFO_LKUP_FAIL);
+		return;
+	}
+
+	/*count connection on its first frame*/
+	if (tcp_hdr && tcp_hdr->syn && !tcp_hdr->ack) {
+		alvs_update_connection_statistics(1, 0, 0);
+	}
+
+	alvs_write_log(LOG_DEBUG, "IPv6 frame scheduled to server_index = %d", cmem_alvs.sched_info_result.server_index);
+	nw_do_route6(&frame,
+		     frame_base,
+		     &cmem_alvs.server6_info_result.server_ip,
+		     ezframe_get_buf_len(&frame));
+
+	/*update statistics*/
+	alvs_update_incoming_traffic_stats();
+}
+
 #endif /*ALVS_SERVICE_H_*/
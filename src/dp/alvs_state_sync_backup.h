@@ -60,7 +60,10 @@ int32_t alvs_state_sync_process_conn(struct alvs_state_sync_conn *conn)
 	uint32_t conn_index;
 	uint32_t lookup_res;
 	struct alvs_conn_classification_result *conn_class_res_ptr;
-	struct alvs_server_classification_result *server_class_res_ptr;
+#ifdef ALVS_CONN_COMPACT
+	struct alvs_service_classification_result *service_class_res_ptr;
+#endif
+	uint8_t service_index = 0;
 	enum alvs_service_output_result create_entry_res;
 	in_addr_t server_addr;
 	uint16_t server_port;
@@ -88,7 +91,16 @@ int32_t alvs_state_sync_process_conn(struct alvs_state_sync_conn *conn)
 	flags = conn->flags & IP_VS_CONN_F_BACKUP_MASK;
 	flags |= IP_VS_CONN_F_SYNC;
 
-	/* TODO - validate received state */
+	/* full NAT local port is owned by the master - connection can not be synced */
+	if ((flags & IP_VS_CONN_F_FWD_MASK) == ALVS_CONN_F_FULLNAT) {
+		alvs_write_log(LOG_DEBUG, "ERROR - Full NAT connection can not be synced");
+		return 1;
+	}
+
+	if (conn->protocol == IPPROTO_TCP && conn->state >= IP_VS_TCP_S_LAST) {
+		alvs_write_log(LOG_DEBUG, "ERROR - Invalid TCP state (%d)", conn->state);
+		return 1;
+	}
 
 	/* Lookup connection in hash */
 	cmem_alvs.conn_class_key.virtual_ip = conn->virtual_addr;
@@ -146,8 +158,8 @@ int32_t alvs_state_sync_process_conn(struct alvs_state_sync_conn *conn)
 		if (conn->server_port != server_port ||
 			conn->server_addr != server_addr) {
 			alvs_write_log(LOG_DEBUG, "Server changed");
-			if (!(conn->flags & IP_VS_CONN_F_INACTIVE)) {
-				/* If inactive flag is not set expire the current connection and treat the incoming message as a new connection */
+			if (!(conn->flags & IP_VS_CONN_F_INACTIVE) || (conn->flags & IP_VS_CONN_F_TEMPLATE)) {
+				/* If inactive flag is not set (or persistence template was rebound) expire the current connection and treat the incoming message as a new connection */
 				alvs_write_log(LOG_DEBUG, "INACTIVE flag not set, deleting connection = %d (0x%x:%d --> 0x%x:%d, protocol=%d)...",
 					       conn_index,
 					       cmem_alvs.conn_info_result.conn_class_key.client_ip,
@@ -184,6 +196,11 @@ int32_t alvs_state_sync_process_conn(struct alvs_state_sync_conn *conn)
 		if (cmem_alvs.conn_info_result.bound == false) {
 			alvs_write_log(LOG_DEBUG, "Try to bind server");
 			if (alvs_find_server_index(conn->server_addr, conn->virtual_addr, conn->server_port, conn->virtual_port, conn->protocol, &server_index) == true) {
+				/*keep the key NAT entry was added with - server address and port of the unbound connection*/
+				if (alvs_conn_is_nat()) {
+					cmem_alvs.conn_info_result.nat_server_ip = cmem_alvs.conn_info_result.server_addr;
+					cmem_alvs.conn_info_result.nat_server_port = cmem_alvs.conn_info_result.server_port;
+				}
 				cmem_alvs.conn_info_result.server_index = server_index;
 				cmem_alvs.conn_info_result.bound = true;
 			}
@@ -193,57 +210,56 @@ int32_t alvs_state_sync_process_conn(struct alvs_state_sync_conn *conn)
 		flags |= cmem_alvs.conn_info_result.conn_flags & ~IP_VS_CONN_F_BACKUP_UPD_MASK;
 		cmem_alvs.conn_info_result.conn_flags = flags;
 
+		alvs_update_half_open_statistics(cmem_alvs.conn_info_result.conn_state, (enum alvs_tcp_conn_state)conn->state);
 		cmem_alvs.conn_info_result.conn_state = (enum alvs_tcp_conn_state)conn->state;
 
 		/*mark connection as active, aging will handle it*/
 		cmem_alvs.conn_info_result.aging_bit = 1;
 		cmem_alvs.conn_info_result.age_iteration = 0;
 
-		ezdp_modify_table_entry(&shared_cmem_alvs.conn_info_struct_desc,
-					conn_index,
-					&cmem_alvs.conn_info_result,
-					sizeof(struct alvs_conn_info_result),
-					0,
-					cmem_wa.alvs_wa.conn_info_table_wa,
-					sizeof(cmem_wa.alvs_wa.conn_info_table_wa));
+		(void)alvs_conn_info_modify(conn_index);
 
 		final_res = 0;
 	} else {
-		cmem_alvs.server_class_key.virtual_ip = conn->virtual_addr;
-		cmem_alvs.server_class_key.virtual_port = conn->virtual_port;
-		cmem_alvs.server_class_key.server_ip = conn->server_addr;
-		cmem_alvs.server_class_key.server_port = conn->server_port;
-		cmem_alvs.server_class_key.protocol = conn->protocol;
-
-		alvs_write_log(LOG_DEBUG, "Server (0x%x:%d) in service (0x%x:%d, protocol=%d)...",
-			       cmem_alvs.server_class_key.server_ip,
-			       cmem_alvs.server_class_key.server_port,
-			       cmem_alvs.server_class_key.virtual_ip,
-			       cmem_alvs.server_class_key.virtual_port,
-			       cmem_alvs.server_class_key.protocol);
-
-		rc = ezdp_lookup_hash_entry(&shared_cmem_alvs.server_class_struct_desc,
-					    (void *)&cmem_alvs.server_class_key,
-					    sizeof(struct alvs_server_classification_key),
-					    (void **)&server_class_res_ptr,
-					    &found_result_size, 0,
-					    cmem_wa.alvs_wa.server_hash_wa,
-					    sizeof(cmem_wa.alvs_wa.server_hash_wa));
+#ifdef ALVS_CONN_COMPACT
+		/*compact connection entry keeps service index instead of virtual address*/
+		cmem_alvs.service_class_key.service_address = conn->virtual_addr;
+		cmem_alvs.service_class_key.service_port = conn->virtual_port;
+		cmem_alvs.service_class_key.service_protocol = conn->protocol;
+
+		if (ezdp_lookup_hash_entry(&shared_cmem_alvs.service_class_struct_desc,
+					   (void *)&cmem_alvs.service_class_key,
+					   sizeof(struct alvs_service_classification_key),
+					   (void **)&service_class_res_ptr,
+					   &found_result_size, 0,
+					   cmem_wa.alvs_wa.service_hash_wa,
+					   sizeof(cmem_wa.alvs_wa.service_hash_wa)) != 0) {
+			alvs_write_log(LOG_DEBUG, "Service not found, ignoring message");
+			alvs_unlock_connection(hash_value);
+			return 1;
+		}
+		service_index = service_class_res_ptr->service_index;
+#endif
 
 		/*create new connection*/
 		/* TODO - update timeout */
-		if (rc == 0) {
-			lookup_res = alvs_server_info_lookup(server_class_res_ptr->server_index);
+		if (alvs_find_server_index(conn->server_addr, conn->virtual_addr, conn->server_port, conn->virtual_port, conn->protocol, &server_index) == true) {
+			lookup_res = alvs_server_info_lookup(server_index);
 			if (lookup_res != 0) {
 				/*no server info - weird error scenario*/
-				alvs_write_log(LOG_DEBUG, "server_info_Result lookup for server_idx = %d FAILED ", server_class_res_ptr->server_index);
+				alvs_write_log(LOG_DEBUG, "server_info_Result lookup for server_idx = %d FAILED ", server_index);
 				alvs_unlock_connection(hash_value);
 				return lookup_res;
 			}
-			create_entry_res = alvs_conn_create_new_entry(true, server_class_res_ptr->server_index, 0, (enum alvs_tcp_conn_state)conn->state, flags, false);
+			create_entry_res = alvs_conn_create_new_entry(service_index, true, server_index, 0, (enum alvs_tcp_conn_state)conn->state, flags, false);
+		} else if (flags & IP_VS_CONN_F_TEMPLATE) {
+			/*persistence template is useful only when bound to a server*/
+			alvs_write_log(LOG_DEBUG, "Server not found, ignoring persistence template");
+			alvs_unlock_connection(hash_value);
+			return 1;
 		} else {
 			alvs_write_log(LOG_DEBUG, "Server not found, creating unbound connection");
-			create_entry_res = alvs_conn_create_new_entry(false, conn->server_addr, conn->server_port, (enum alvs_tcp_conn_state)conn->state, flags, false);
+			create_entry_res = alvs_conn_create_new_entry(service_index, false, conn->server_addr, conn->server_port, (enum alvs_tcp_conn_state)conn->state, flags, false);
 		}
 
 		if (create_entry_res == ALVS_SERVICE_DATA_PATH_IGNORE) {
@@ -178,7 +178,7 @@ void alvs_state_sync_set_sync_conn(struct alvs_state_sync_conn *sync_conn)
 	sync_conn->size = sizeof(struct alvs_state_sync_conn);
 	sync_conn->flags = cmem_alvs.conn_info_result.conn_flags;
 	sync_conn->state = cmem_alvs.conn_info_result.conn_state;
-	sync_conn->timeout = alvs_util_get_conn_iterations((enum alvs_tcp_conn_state)sync_conn->state)
+	sync_conn->timeout = alvs_util_get_conn_iterations(sync_conn->protocol, (enum alvs_tcp_conn_state)sync_conn->state)
 		* ALVS_TIMER_INTERVAL_SEC;
 	sync_conn->fwmark = 0;
 	sync_conn->client_port = cmem_alvs.conn_info_result.conn_class_key.client_port;
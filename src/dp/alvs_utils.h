@@ -36,6 +36,7 @@
 #ifndef ALVS_UTILS_H_
 #define ALVS_UTILS_H_
 
+#include <linux/tcp.h>
 #include "defs.h"
 #include "global_defs.h"
 #include "nw_utils.h"
@@ -47,19 +48,89 @@
  * \return        amount of aging iterations
  */
 static __always_inline
-int alvs_util_get_conn_iterations(enum alvs_tcp_conn_state alvs_state)
+int alvs_util_get_conn_iterations(uint16_t protocol, enum alvs_tcp_conn_state alvs_state)
 {
+	if (protocol == IPPROTO_UDP) {
+		return ALVS_UDP_CONN_ITER_NORMAL;
+	}
+
 	switch (alvs_state) {
+	case IP_VS_TCP_S_NONE:
+		return ALVS_TCP_CONN_ITER_NONE;
 	case IP_VS_TCP_S_ESTABLISHED:
 		return ALVS_TCP_CONN_ITER_ESTABLISHED;
+	case IP_VS_TCP_S_SYN_SENT:
+		return ALVS_TCP_CONN_ITER_SYN_SENT;
+	case IP_VS_TCP_S_SYN_RECV:
+		return ALVS_TCP_CONN_ITER_SYN_RECV;
+	case IP_VS_TCP_S_FIN_WAIT:
+		return ALVS_TCP_CONN_ITER_FIN_WAIT;
+	case IP_VS_TCP_S_TIME_WAIT:
+		return ALVS_TCP_CONN_ITER_TIME_WAIT;
+	case IP_VS_TCP_S_CLOSE:
+		return ALVS_TCP_CONN_ITER_CLOSE;
 	case IP_VS_TCP_S_CLOSE_WAIT:
 		return ALVS_TCP_CONN_ITER_CLOSE_WAIT;
+	case IP_VS_TCP_S_LAST_ACK:
+		return ALVS_TCP_CONN_ITER_LAST_ACK;
+	case IP_VS_TCP_S_LISTEN:
+		return ALVS_TCP_CONN_ITER_LISTEN;
+	case IP_VS_TCP_S_SYNACK:
+		return ALVS_TCP_CONN_ITER_SYNACK;
 	default:
 		/*should not happen*/
 		return 1;
 	}
 }
 
+/******************************************************************************
+ * \brief         get the next tcp connection state according to the flags of
+ *                incoming frame. follows IPVS input-only state table since
+ *                only client to server direction is seen by ALVS.
+ *                RST is not handled here - connection is closed by caller.
+ *
+ * \return        next tcp connection state
+ */
+static __always_inline
+enum alvs_tcp_conn_state alvs_util_get_tcp_next_state(enum alvs_tcp_conn_state alvs_state, struct tcphdr *tcp_hdr)
+{
+	if (tcp_hdr->syn) {
+		if (alvs_state == IP_VS_TCP_S_ESTABLISHED || alvs_state == IP_VS_TCP_S_SYN_SENT) {
+			return IP_VS_TCP_S_ESTABLISHED;
+		}
+		return IP_VS_TCP_S_SYN_RECV;
+	}
+
+	if (tcp_hdr->fin) {
+		switch (alvs_state) {
+		case IP_VS_TCP_S_NONE:
+			return IP_VS_TCP_S_CLOSE;
+		case IP_VS_TCP_S_ESTABLISHED:
+			return IP_VS_TCP_S_FIN_WAIT;
+		case IP_VS_TCP_S_SYN_RECV:
+		case IP_VS_TCP_S_SYNACK:
+			return IP_VS_TCP_S_TIME_WAIT;
+		default:
+			return alvs_state;
+		}
+	}
+
+	if (tcp_hdr->ack) {
+		switch (alvs_state) {
+		case IP_VS_TCP_S_NONE:
+		case IP_VS_TCP_S_SYN_RECV:
+		case IP_VS_TCP_S_SYNACK:
+			return IP_VS_TCP_S_ESTABLISHED;
+		case IP_VS_TCP_S_LAST_ACK:
+			return IP_VS_TCP_S_CLOSE;
+		default:
+			return alvs_state;
+		}
+	}
+
+	return alvs_state;
+}
+
 /******************************************************************************
  * \brief       perform alvs application info lookup.
  *
@@ -140,6 +211,68 @@ void alvs_update_connection_statistics(int32_t sched_conn, int32_t active_conn,
 
 	ezdp_add_posted_ctr(cmem_alvs.server_info_result.server_stats_base + ALVS_SERVER_STATS_CONN_SCHED_OFFSET,
 			    sched_conn);
+
+	/*handle server on demand stats:
+	 *                   inactive conn/active conn - read by least connection schedulers
+	 */
+	if (active_conn > 0) {
+		ezdp_inc_single_ctr(cmem_alvs.server_info_result.server_on_demand_stats_base + ALVS_SERVER_STATS_ACTIVE_CONN_ON_DEMAND_OFFSET,
+				    active_conn);
+	} else if (active_conn < 0) {
+		ezdp_dec_single_ctr(cmem_alvs.server_info_result.server_on_demand_stats_base + ALVS_SERVER_STATS_ACTIVE_CONN_ON_DEMAND_OFFSET,
+				    -active_conn);
+	}
+
+	if (inactive_conn > 0) {
+		ezdp_inc_single_ctr(cmem_alvs.server_info_result.server_on_demand_stats_base + ALVS_SERVER_STATS_INACTIVE_CONN_ON_DEMAND_OFFSET,
+				    inactive_conn);
+	} else if (inactive_conn < 0) {
+		ezdp_dec_single_ctr(cmem_alvs.server_info_result.server_on_demand_stats_base + ALVS_SERVER_STATS_INACTIVE_CONN_ON_DEMAND_OFFSET,
+				    -inactive_conn);
+	}
+}
+
+/******************************************************************************
+ * \brief         update half-open (SYN_RECV) connection count of a service
+ *                when a connection entry enters or leaves SYN_RECV state.
+ *                called under connection lock with the entry in
+ *                cmem_alvs.conn_info_result.
+ * \return        void
+ */
+static __always_inline
+void alvs_update_half_open_statistics(enum alvs_tcp_conn_state old_state, enum alvs_tcp_conn_state new_state)
+{
+	uint32_t addr;
+
+	if (old_state == new_state) {
+		return;
+	}
+
+	addr = BUILD_SUM_ADDR(EZDP_EXTERNAL_MS, EMEM_SERVER_STATS_ON_DEMAND_MSID,
+			      EMEM_STATS_ON_DEMAND_HALF_OPEN_OFFSET + cmem_alvs.conn_info_result.service_index);
+	if (new_state == IP_VS_TCP_S_SYN_RECV) {
+		ezdp_inc_single_ctr(addr, 1);
+	} else if (old_state == IP_VS_TCP_S_SYN_RECV) {
+		ezdp_dec_single_ctr(addr, 1);
+	}
+}
+
+/******************************************************************************
+ * \brief         read half-open (SYN_RECV) connection count of a service.
+ *                connections of a deleted service may release the counter
+ *                after the index was reused - a wrapped value is read as 0.
+ * \return        number of half-open connections
+ */
+static __always_inline
+uint64_t alvs_read_half_open_statistics(uint8_t service_index)
+{
+	ezdp_read_single_ctr(BUILD_SUM_ADDR(EZDP_EXTERNAL_MS, EMEM_SERVER_STATS_ON_DEMAND_MSID,
+					    EMEM_STATS_ON_DEMAND_HALF_OPEN_OFFSET + service_index),
+			     &cmem_wa.alvs_wa.counter_work_area);
+	if (unlikely(cmem_wa.alvs_wa.counter_work_area > ALVS_CONN_MAX_ENTRIES)) {
+		return 0;
+	}
+	return cmem_wa.alvs_wa.counter_work_area;
 }
 
 /******************************************************************************
@@ -219,4 +352,105 @@ uint32_t alvs_unlock_connection(ezdp_hashed_key_t hash_value)
 	return ezdp_unlock_spinlock(&cmem_alvs.conn_spinlock);
 }
 
+/******************************************************************************
+ * \brief      fold 32 bit one's complement sum to 16 bits
+ *
+ * \return     folded sum
+ */
+static __always_inline
+uint16_t alvs_util_csum_fold(uint32_t sum)
+{
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)sum;
+}
+
+/******************************************************************************
+ * \brief      incremental checksum update (RFC 1624) of a 32 bit field
+ *             changed from old_val to new_val.
+ *
+ * \return     void
+ */
+static __always_inline
+void alvs_util_csum_replace4(uint16_t *check, uint32_t old_val, uint32_t new_val)
+{
+	uint32_t sum = (uint16_t)~*check;
+
+	sum += (uint16_t)~(old_val >> 16) + (uint16_t)~(old_val & 0xffff);
+	sum += (new_val >> 16) + (new_val & 0xffff);
+	*check = ~alvs_util_csum_fold(sum);
+}
+
+/******************************************************************************
+ * \brief      incremental checksum update (RFC 1624) of a 16 bit field
+ *             changed from old_val to new_val.
+ *
+ * \return     void
+ */
+static __always_inline
+void alvs_util_csum_replace2(uint16_t *check, uint16_t old_val, uint16_t new_val)
+{
+	uint32_t sum = (uint16_t)~*check;
+
+	sum += (uint16_t)~old_val + new_val;
+	*check = ~alvs_util_csum_fold(sum);
+}
+
+/******************************************************************************
+ * \brief      compute internet checksum of a buffer of even length
+ *
+ * \return     checksum
+ */
+static __always_inline
+uint16_t alvs_util_csum(uint16_t *data, uint32_t len)
+{
+	uint32_t sum = 0;
+
+	for (; len > 1; len -= 2) {
+		sum += *data++;
+	}
+	return ~alvs_util_csum_fold(sum);
+}
+
+/******************************************************************************
+ * \brief      rewrite address and port of a TCP/UDP frame - destination
+ *             (to_server) or source (to client). IP and L4 checksums are
+ *             updated incrementally. zero UDP checksum is kept.
+ *             headers must reside in the first frame buffer.
+ *
+ * \return     void
+ */
+static __always_inline
+void alvs_util_nat_rewrite(struct iphdr *ip_hdr, bool to_server, in_addr_t addr, uint16_t port)
+{
+	uint8_t *l4_hdr = (uint8_t *)ip_hdr + (ip_hdr->ihl << 2);
+	in_addr_t *addr_field = to_server ? &ip_hdr->daddr : &ip_hdr->saddr;
+	uint16_t *port_field;
+	uint16_t *l4_check;
+
+	if (ip_hdr->protocol == IPPROTO_TCP) {
+		port_field = to_server ? &((struct tcphdr *)l4_hdr)->dest : &((struct tcphdr *)l4_hdr)->source;
+		l4_check = &((struct tcphdr *)l4_hdr)->check;
+	} else {
+		port_field = to_server ? &((struct udphdr *)l4_hdr)->dest : &((struct udphdr *)l4_hdr)->source;
+		l4_check = &((struct udphdr *)l4_hdr)->check;
+		if (*l4_check == 0) {
+			l4_check = NULL;
+		}
+	}
+
+	if (l4_check) {
+		/*L4 checksum covers pseudo header*/
+		alvs_util_csum_replace4(l4_check, *addr_field, addr);
+		alvs_util_csum_replace2(l4_check, *port_field, port);
+		if (ip_hdr->protocol == IPPROTO_UDP && *l4_check == 0) {
+			*l4_check = 0xffff;
+		}
+	}
+	alvs_util_csum_replace4(&ip_hdr->check, *addr_field, addr);
+
+	*addr_field = addr;
+	*port_field = port;
+}
+
 #endif  /*ALVS_UTILS_H_*/
@@ -61,17 +61,33 @@ struct cmem_nw_info {
 
 		struct nw_fib_key                    fib_key;
 		/**< FIB key */
+
+		struct nw_arp6_key                   arp6_key;
+		/**< IPv6 neighbor key */
+
+		struct nw_fib6_key                   fib6_key;
+		/**< FIB6 key */
 	};
 
 	struct  nw_if_result                 interface_result;
 	/**< interface result */
 
+	/* next hop entry is rebuilt only after FIB result is consumed - saving CMEM */
 	union{
 		struct nw_fib_result                 fib_result;
 		/**< FIB result */
 
 		struct ezdp_lookup_int_tcam_result   int_tcam_result;
 		/**< DP general result for iTCAM */
+
+		struct nw_next_hop_result            next_hop_result;
+		/**< next hop result */
+
+		struct nw_fib6_result                fib6_result;
+		/**< FIB6 result */
+
+		struct nw_fib6_gw_result             fib6_gw_result;
+		/**< FIB6 gateway result */
 	};
 };
 
@@ -79,6 +95,9 @@ union nw_workarea {
 	char                    arp_hash_wa[EZDP_HASH_WORK_AREA_SIZE(sizeof(struct nw_arp_result), sizeof(struct nw_arp_key))];
 	char                    table_work_area[EZDP_TABLE_WORK_AREA_SIZE(sizeof(struct nw_if_result))];
 	char			app_info_work_area[EZDP_TABLE_WORK_AREA_SIZE(sizeof(union application_info_result))];
+	char			next_hop_table_wa[EZDP_TABLE_WORK_AREA_SIZE(sizeof(struct nw_next_hop_result))];
+	char                    arp6_hash_wa[EZDP_HASH_WORK_AREA_SIZE(sizeof(struct nw_arp_result), sizeof(struct nw_arp6_key))];
+	char			fib6_gw_table_wa[EZDP_TABLE_WORK_AREA_SIZE(sizeof(struct nw_fib6_gw_result))];
 };
 
 /***********************************************************************//**
@@ -90,6 +109,9 @@ struct shared_cmem_network {
 	ezdp_table_struct_desc_t    interface_struct_desc;
 	ezdp_table_struct_desc_t    app_info_struct_desc;
 	ezdp_hash_struct_desc_t	    arp_struct_desc;
+	ezdp_table_struct_desc_t    next_hop_struct_desc;
+	ezdp_hash_struct_desc_t	    arp6_struct_desc;
+	ezdp_table_struct_desc_t    fib6_gw_struct_desc;
 } __packed;
 
 extern struct cmem_nw_info           cmem_nw;
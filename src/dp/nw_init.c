@@ -89,6 +89,65 @@ bool init_nw_shared_cmem(void)
 		return false;
 	}
 
+	/*Init next hop DB*/
+	result = ezdp_init_table_struct_desc(STRUCT_ID_NW_NEXT_HOP,
+					     &shared_cmem_nw.next_hop_struct_desc,
+					     cmem_wa.nw_wa.next_hop_table_wa,
+					     sizeof(cmem_wa.nw_wa.next_hop_table_wa));
+	if (result != 0) {
+		printf("ezdp_init_table_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+		       STRUCT_ID_NW_NEXT_HOP, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	result = ezdp_validate_table_struct_desc(&shared_cmem_nw.next_hop_struct_desc,
+						 sizeof(struct nw_next_hop_result));
+	if (result != 0) {
+		printf("ezdp_validate_table_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+		       STRUCT_ID_NW_NEXT_HOP, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	/*Init IPv6 neighbors DB*/
+	result = ezdp_init_hash_struct_desc(STRUCT_ID_NW_ARP6,
+					    &shared_cmem_nw.arp6_struct_desc,
+					    cmem_wa.nw_wa.arp6_hash_wa,
+					    sizeof(cmem_wa.nw_wa.arp6_hash_wa));
+	if (result != 0) {
+		printf("ezdp_init_hash_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+		       STRUCT_ID_NW_ARP6, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	result = ezdp_validate_hash_struct_desc(&shared_cmem_nw.arp6_struct_desc,
+						true,
+						sizeof(struct nw_arp6_key),
+						sizeof(struct nw_arp_result));
+	if (result != 0) {
+		printf("ezdp_validate_hash_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+		       STRUCT_ID_NW_ARP6, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	/*Init FIB6 gateway DB*/
+	result = ezdp_init_table_struct_desc(STRUCT_ID_NW_FIB6_GW,
+					     &shared_cmem_nw.fib6_gw_struct_desc,
+					     cmem_wa.nw_wa.fib6_gw_table_wa,
+					     sizeof(cmem_wa.nw_wa.fib6_gw_table_wa));
+	if (result != 0) {
+		printf("ezdp_init_table_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+		       STRUCT_ID_NW_FIB6_GW, result, ezdp_get_err_msg());
+		return false;
+	}
+
+	result = ezdp_validate_table_struct_desc(&shared_cmem_nw.fib6_gw_struct_desc,
+						 sizeof(struct nw_fib6_gw_result));
+	if (result != 0) {
+		printf("ezdp_validate_table_struct_desc of %d struct fail. Error Code %d. Error String %s\n",
+		       STRUCT_ID_NW_FIB6_GW, result, ezdp_get_err_msg());
+		return false;
+	}
+
 	/* Init application info DB */
 	result = ezdp_init_table_struct_desc(STRUCT_ID_APPLICATION_INFO,
 					     &shared_cmem_nw.app_info_struct_desc,
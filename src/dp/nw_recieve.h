@@ -50,6 +50,7 @@ void nw_recieve_and_parse_frame(ezframe_t __cmem * frame,
 {
 	uint8_t	*frame_base;
 	struct iphdr *ip_ptr;
+	struct ipv6hdr *ip6_ptr;
 	bool my_mac;
 	uint32_t buflen;
 
@@ -95,8 +96,26 @@ void nw_recieve_and_parse_frame(ezframe_t __cmem * frame,
 
 		my_mac = cmem_nw.mac_decode_result.control.my_mac;
 
+		if (cmem_nw.mac_decode_result.last_tag_protocol_type.ipv6) {
+			ip6_ptr = (struct ipv6hdr *)(frame_base + cmem_nw.mac_decode_result.layer2_size);
+
+			/*validate IPv6 header, in case of any error send frame to host*/
+			if (unlikely(buflen < cmem_nw.mac_decode_result.layer2_size + sizeof(struct ipv6hdr) ||
+				     ip6_ptr->version != 6 ||
+				     cmem_nw.mac_decode_result.layer2_size + sizeof(struct ipv6hdr) + ip6_ptr->payload_len >
+				     frame->job_desc.frame_desc.frame_length)) {
+				alvs_write_log(LOG_DEBUG, "IPv6 validation failed");
+				nw_interface_inc_counter(NW_IF_STATS_IPV6_ERROR);
+				nw_host_do_route(frame);
+				return;
+			}
+
+			alvs_packet6_processing(frame, frame_base, ip6_ptr, my_mac);
+			return;
+		}
+
 		if (!cmem_nw.mac_decode_result.last_tag_protocol_type.ipv4) {
-			alvs_write_log(LOG_DEBUG, "Not IPv4!");
+			alvs_write_log(LOG_DEBUG, "Not IPv4 or IPv6!");
 			nw_interface_inc_counter(NW_IF_STATS_NOT_IPV4);
 			nw_host_do_route(frame);
 			return;
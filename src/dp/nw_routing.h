@@ -68,49 +68,79 @@ void nw_send_frame_to_network(ezframe_t __cmem * frame,
 
 
 /******************************************************************************
- * \brief         perform arp lookup and modify l2 header before transmission
+ * \brief         modify l2 header and transmit frame to network
  * \return        void
  */
 static __always_inline
-void nw_arp_processing(ezframe_t __cmem * frame,
-		       uint8_t __cmem * buffer_base,
-		       in_addr_t dest_ip,
-		       uint32_t	frame_buff_size)
+void nw_send_with_dest_mac(ezframe_t __cmem * frame,
+			   uint8_t __cmem * buffer_base,
+			   struct ether_addr *dest_mac,
+			   uint8_t base_logical_id,
+			   uint32_t frame_buff_size)
 {
-	 uint32_t rc;
-	 uint32_t found_result_size;
-	 struct nw_arp_result *arp_res_ptr;
-
+	struct ether_addr *dmac = (struct ether_addr *)buffer_base;
 
-	 cmem_nw.arp_key.real_server_address = dest_ip;
+	/*copy dst mac*/
+	ezdp_mem_copy(dmac, dest_mac->ether_addr_octet, sizeof(struct ether_addr));
+	/*copy src mac*/
+	ezdp_mem_copy((uint8_t *)dmac+sizeof(struct ether_addr), cmem_nw.interface_result.mac_address.ether_addr_octet, sizeof(struct ether_addr));
 
-	 rc = ezdp_lookup_hash_entry(&shared_cmem_nw.arp_struct_desc,
-				     (void *)&cmem_nw.arp_key,
-				     sizeof(struct nw_arp_key),
-				     (void **)&arp_res_ptr, &found_result_size,
-				     0, cmem_wa.nw_wa.arp_hash_wa,
-				     sizeof(cmem_wa.nw_wa.arp_hash_wa));
+	/* Store modified segment data */
+	ezframe_store_buf(frame,
+			  buffer_base,
+			  frame_buff_size,
+			  0);
 
-	if (likely(rc == 0)) {
-		struct ether_addr *dmac = (struct ether_addr *)buffer_base;
+	nw_send_frame_to_network(frame,
+				 buffer_base,
+				 base_logical_id);
+}
 
-		/*copy dst mac*/
-		ezdp_mem_copy(dmac, arp_res_ptr->dest_mac_addr.ether_addr_octet, sizeof(struct ether_addr));
-		/*copy src mac*/
-		ezdp_mem_copy((uint8_t *)dmac+sizeof(struct ether_addr), cmem_nw.interface_result.mac_address.ether_addr_octet, sizeof(struct ether_addr));
+/******************************************************************************
+ * \brief         perform arp lookup
+ * \return        0 on success, otherwise lookup failed.
+ */
+static __always_inline
+uint32_t nw_arp_lookup(in_addr_t dest_ip, struct nw_arp_result **arp_res_ptr)
+{
+	uint32_t rc;
+	uint32_t found_result_size;
 
-		/* Store modified segment data */
-		ezframe_store_buf(frame,
-				  buffer_base,
-			   frame_buff_size,
-			   0);
+	cmem_nw.arp_key.real_server_address = dest_ip;
 
-		nw_send_frame_to_network(frame,
-					 buffer_base,
-					 arp_res_ptr->base_logical_id);
-	} else {
+	rc = ezdp_lookup_hash_entry(&shared_cmem_nw.arp_struct_desc,
+				    (void *)&cmem_nw.arp_key,
+				    sizeof(struct nw_arp_key),
+				    (void **)arp_res_ptr, &found_result_size,
+				    0, cmem_wa.nw_wa.arp_hash_wa,
+				    sizeof(cmem_wa.nw_wa.arp_hash_wa));
+	if (unlikely(rc != 0)) {
 		alvs_write_log(LOG_DEBUG, "dest_ip = 0x%x ARP lookup FAILED", dest_ip);
 		nw_interface_inc_counter(NW_IF_STATS_FAIL_ARP_LOOKUP);
+	}
+
+	return rc;
+}
+
+/******************************************************************************
+ * \brief         perform arp lookup and modify l2 header before transmission
+ * \return        void
+ */
+static __always_inline
+void nw_arp_processing(ezframe_t __cmem * frame,
+		       uint8_t __cmem * buffer_base,
+		       in_addr_t dest_ip,
+		       uint32_t	frame_buff_size)
+{
+	struct nw_arp_result *arp_res_ptr;
+
+	if (likely(nw_arp_lookup(dest_ip, &arp_res_ptr) == 0)) {
+		nw_send_with_dest_mac(frame,
+				      buffer_base,
+				      &arp_res_ptr->dest_mac_addr,
+				      arp_res_ptr->base_logical_id,
+				      frame_buff_size);
+	} else {
 		nw_discard_frame();
 		return;
 	}
@@ -191,4 +221,196 @@ void nw_do_route(ezframe_t __cmem * frame,
 	nw_arp_processing(frame, buffer_base, fib_dest_ip, frame_buff_size);
 }
 
+/******************************************************************************
+ * \brief         get current route generation. CP bumps it on every FIB or
+ *                ARP change.
+ * \return        route generation
+ */
+static __always_inline
+uint32_t nw_get_route_gen(void)
+{
+	return ezdp_atomic_read32_sum_addr(BUILD_SUM_ADDR(EZDP_EXTERNAL_MS, EMEM_NW_ROUTE_GEN_MSID, EMEM_NW_ROUTE_GEN_OFFSET));
+}
+
+/******************************************************************************
+ * \brief         perform nw route using next hop DB. a valid next hop entry
+ *                replaces FIB and ARP lookups. an entry is valid if it was
+ *                resolved for the same dest_ip in current route generation,
+ *                otherwise FIB and ARP are done and the entry is rewritten.
+ * \return        void
+ */
+static __always_inline
+void nw_do_route_cached(ezframe_t __cmem * frame,
+			uint8_t *buffer_base,
+			in_addr_t dest_ip,
+			uint32_t frame_buff_size,
+			uint32_t next_hop_index)
+{
+	uint32_t route_gen;
+	uint32_t fib_dest_ip;
+	struct nw_arp_result *arp_res_ptr;
+
+	/* read generation before resolving, a concurrent change invalidates the new entry */
+	route_gen = nw_get_route_gen();
+
+	if (likely(ezdp_lookup_table_entry(&shared_cmem_nw.next_hop_struct_desc,
+					   next_hop_index, &cmem_nw.next_hop_result,
+					   sizeof(struct nw_next_hop_result), 0) == 0 &&
+		   cmem_nw.next_hop_result.route_gen == route_gen &&
+		   cmem_nw.next_hop_result.dest_ip == dest_ip)) {
+		nw_send_with_dest_mac(frame,
+				      buffer_base,
+				      &cmem_nw.next_hop_result.dest_mac_addr,
+				      cmem_nw.next_hop_result.base_logical_id,
+				      frame_buff_size);
+		return;
+	}
+
+	fib_dest_ip = nw_fib_processing(dest_ip);
+	if (fib_dest_ip == 0) {
+		/* Drop frame */
+		nw_discard_frame();
+		return;
+	}
+
+	if (unlikely(nw_arp_lookup(fib_dest_ip, &arp_res_ptr) != 0)) {
+		nw_discard_frame();
+		return;
+	}
+
+	ezdp_mem_copy(&cmem_nw.next_hop_result.dest_mac_addr, &arp_res_ptr->dest_mac_addr, sizeof(struct ether_addr));
+	cmem_nw.next_hop_result.base_logical_id = arp_res_ptr->base_logical_id;
+	cmem_nw.next_hop_result.route_gen = route_gen;
+	cmem_nw.next_hop_result.dest_ip = dest_ip;
+
+	alvs_write_log(LOG_DEBUG, "next hop %d updated: dest_ip = 0x%08x route_gen = %d", next_hop_index, dest_ip, route_gen);
+	(void)ezdp_add_table_entry(&shared_cmem_nw.next_hop_struct_desc,
+				   next_hop_index,
+				   &cmem_nw.next_hop_result,
+				   sizeof(struct nw_next_hop_result),
+				   EZDP_UNCONDITIONAL,
+				   cmem_wa.nw_wa.next_hop_table_wa,
+				   sizeof(cmem_wa.nw_wa.next_hop_table_wa));
+
+	nw_send_with_dest_mac(frame,
+			      buffer_base,
+			      &cmem_nw.next_hop_result.dest_mac_addr,
+			      cmem_nw.next_hop_result.base_logical_id,
+			      frame_buff_size);
+}
+
+/******************************************************************************
+ * \brief         perform IPv6 neighbor lookup
+ * \return        0 on success, otherwise lookup failed.
+ */
+static __always_inline
+uint32_t nw_arp6_lookup(struct in6_addr *dest_ip, struct nw_arp_result **arp_res_ptr)
+{
+	uint32_t rc;
+	uint32_t found_result_size;
+
+	ezdp_mem_copy(&cmem_nw.arp6_key.real_server_address, dest_ip, sizeof(struct in6_addr));
+
+	rc = ezdp_lookup_hash_entry(&shared_cmem_nw.arp6_struct_desc,
+				    (void *)&cmem_nw.arp6_key,
+				    sizeof(struct nw_arp6_key),
+				    (void **)arp_res_ptr, &found_result_size,
+				    0, cmem_wa.nw_wa.arp6_hash_wa,
+				    sizeof(cmem_wa.nw_wa.arp6_hash_wa));
+	if (unlikely(rc != 0)) {
+		alvs_write_log(LOG_DEBUG, "IPv6 neighbor lookup FAILED");
+		nw_interface_inc_counter(NW_IF_STATS_FAIL_ARP_LOOKUP);
+	}
+
+	return rc;
+}
+
+/******************************************************************************
+ * \brief         perform FIB6 lookup and get dest_ip for transmission.
+ *                gateway of NW_FIB_GW entry is read from FIB6 GW DB.
+ * \return        dest IP or NULL for dropped frame
+ */
+static __always_inline
+struct in6_addr *nw_fib6_processing(struct in6_addr *dest_ip)
+{
+	enum nw_fib_type     result_type;
+	struct ezdp_lookup_int_tcam_retval tcam_retval;
+
+	/* read iTCAM */
+	cmem_nw.fib6_key.rsv0 = 0;
+	ezdp_mem_copy(&cmem_nw.fib6_key.dest_ip, dest_ip, sizeof(struct in6_addr));
+	tcam_retval.raw_data = ezdp_lookup_int_tcam(NW_FIB6_TCAM_SIDE,
+						   NW_FIB6_TCAM_PROFILE,
+						   &cmem_nw.fib6_key,
+						   sizeof(struct nw_fib6_key),
+						   &cmem_nw.int_tcam_result);
+
+	/* check matching */
+	if (unlikely(tcam_retval.assoc_data.match == 0)) {
+		alvs_write_log(LOG_ERR, "FIB6 lookup failed.");
+		nw_interface_inc_counter(NW_IF_STATS_FAIL_FIB_LOOKUP);
+		return NULL;
+	}
+	result_type = cmem_nw.fib6_result.result_type;
+
+	/* get dest_ip */
+	if (likely(result_type == NW_FIB_NEIGHBOR)) {
+		/* Destination IP is neighbor. use it for neighbor lookup */
+		alvs_write_log(LOG_DEBUG, "NW_FIB_NEIGHBOR: using origin dest IPv6");
+		return dest_ip;
+	} else if (result_type == NW_FIB_GW) {
+		/* Destination IP is GW. use GW entry IP */
+		if (unlikely(ezdp_lookup_table_entry(&shared_cmem_nw.fib6_gw_struct_desc,
+						     cmem_nw.fib6_result.gw_index,
+						     &cmem_nw.fib6_gw_result,
+						     sizeof(struct nw_fib6_gw_result), 0) != 0)) {
+			alvs_write_log(LOG_ERR, "FIB6 GW lookup failed. gw_index = %d", cmem_nw.fib6_result.gw_index);
+			nw_interface_inc_counter(NW_IF_STATS_FAIL_FIB_LOOKUP);
+			return NULL;
+		}
+		alvs_write_log(LOG_DEBUG, "NW_FIB_GW: using GW IPv6");
+		return &cmem_nw.fib6_gw_result.gw_ip;
+	} else if (result_type == NW_FIB_DROP) {
+		alvs_write_log(LOG_DEBUG, "NW_FIB_DROP: Drop frame.");
+		nw_interface_inc_counter(NW_IF_STATS_REJECT_BY_FIB);
+		return NULL;
+	}
+
+	/* Unknown result type.*/
+	alvs_write_log(LOG_ERR, "Unsupported FIB6 result type. dropping packet");
+	nw_interface_inc_counter(NW_IF_STATS_UNKNOWN_FIB_RESULT);
+	return NULL;
+}
+
+/******************************************************************************
+ * \brief         perform IPv6 nw route
+ * \return        void
+ */
+static __always_inline
+void nw_do_route6(ezframe_t __cmem * frame,
+		  uint8_t *buffer_base,
+		  struct in6_addr *dest_ip,
+		  uint32_t frame_buff_size)
+{
+	struct in6_addr *fib_dest_ip;
+	struct nw_arp_result *arp_res_ptr;
+
+	fib_dest_ip = nw_fib6_processing(dest_ip);
+	if (fib_dest_ip == NULL) {
+		/* Drop frame */
+		nw_discard_frame();
+		return;
+	}
+
+	if (likely(nw_arp6_lookup(fib_dest_ip, &arp_res_ptr) == 0)) {
+		nw_send_with_dest_mac(frame,
+				      buffer_base,
+				      &arp_res_ptr->dest_mac_addr,
+				      arp_res_ptr->base_logical_id,
+				      frame_buff_size);
+	} else {
+		nw_discard_frame();
+	}
+}
+
 #endif /* NW_ROUTING_H_ */
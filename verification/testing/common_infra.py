@@ -39,6 +39,14 @@ STRUCT_ID_NW_FIB					   = 8
 STRUCT_ID_NW_ARP					   = 9
 STRUCT_ID_ALVS_SERVER_CLASSIFICATION   = 10
 STRUCT_ID_APPLICATION_INFO			   = 11
+STRUCT_ID_NW_NEXT_HOP				   = 12
+STRUCT_ID_ALVS_SERVICE6_CLASSIFICATION = 13
+STRUCT_ID_ALVS_SERVER6_INFO			   = 14
+STRUCT_ID_NW_ARP6					   = 15
+STRUCT_ID_NW_FIB6_GW				   = 16
+STRUCT_ID_ALVS_NAT_CLASSIFICATION	   = 17
+STRUCT_ID_ALVS_VIP_FILTER			   = 18
+STRUCT_ID_ALVS_LBLC_INFO			   = 19
 
 #===============================================================================
 # STATS DEFINES
@@ -49,7 +57,7 @@ ALVS_NUM_OF_SERVICE_STATS	 = 6
 ALVS_NUM_OF_SERVER_STATS	 = 8
 NUM_OF_INTERFACES			 = 5
 
-ALVS_NUM_OF_SERVERS_ON_DEMAND_STATS = 1
+ALVS_NUM_OF_SERVERS_ON_DEMAND_STATS = 3
 NW_NUM_OF_IF_STATS			 = 20
 ALVS_NUM_OF_ALVS_ERROR_STATS = 40
 
@@ -708,6 +716,14 @@ class ezbox_host:
 		self.execute_command_on_host("ipvsadm -a -t %s:%s -r %s:%s -w %d %s"%(vip, service_port, server_ip, server_port, weight, routing_alg_opt))
 		time.sleep(2)
 
+	def add_fwmark_service(self, fwmark, sched_alg='sh', sched_alg_opt='-b sh-port'):
+		self.execute_command_on_host("ipvsadm -A -f %d -s %s %s"%(fwmark, sched_alg, sched_alg_opt))
+		time.sleep(2)
+
+	def add_fwmark_server(self, fwmark, server_ip, weight=1, routing_alg_opt=' '):
+		self.execute_command_on_host("ipvsadm -a -f %d -r %s -w %d %s"%(fwmark, server_ip, weight, routing_alg_opt))
+		time.sleep(2)
+
 	def modify_server(self, vip, service_port, server_ip, server_port, weight=1, routing_alg_opt=' ', u_thresh = 0, l_thresh = 0):
 		self.execute_command_on_host("ipvsadm -e -t %s:%s -r %s:%s -w %d %s -x %d -y %d"%(vip, service_port, server_ip, server_port, weight, routing_alg_opt, u_thresh, l_thresh))
 		time.sleep(2)
@@ -784,7 +800,16 @@ class ezbox_host:
 					  'ALVS_ERROR_UNSUPPORTED_PROTOCOL':error_stats[20]['byte_value'],
 #					  'ALVS_ERROR_NO_ACTIVE_SERVERS':error_stats[21]['byte_value'],
 					  'ALVS_ERROR_CREATE_CONN_MEM_ERROR':error_stats[22]['byte_value'],
-					  'ALVS_ERROR_STATE_SYNC':error_stats[23]['byte_value']}
+					  'ALVS_ERROR_STATE_SYNC':error_stats[23]['byte_value'],
+					  'ALVS_ERROR_NON_SYN_MISS_DROP':error_stats[31]['byte_value'],
+					  'ALVS_ERROR_NON_SYN_MISS_PUNT_LIMIT':error_stats[32]['byte_value'],
+					  'ALVS_ERROR_HALF_OPEN_LIMIT':error_stats[33]['byte_value'],
+					  'ALVS_ERROR_NAT_CLASS_ALLOC_FAIL':error_stats[34]['byte_value'],
+					  'ALVS_ERROR_TUNNEL_NO_HEADROOM':error_stats[35]['byte_value'],
+					  'ALVS_ERROR_TUNNEL_NO_SOURCE_IP':error_stats[36]['byte_value'],
+					  'ALVS_ERROR_TUNNEL_FRAG_NEEDED':error_stats[37]['byte_value'],
+					  'ALVS_ERROR_FULLNAT_PORT_ALLOC_FAIL':error_stats[38]['byte_value'],
+					  'ALVS_ERROR_TUNNEL_MTU_EXCEEDED':error_stats[39]['byte_value']}
 		
 		return stats_dict # return only the lsb (small amount of packets on tests)
 
@@ -522,6 +522,29 @@ def statistics_checker(ezbox, no_errors=True, no_connections=True):
 	
 	return (connection_rc and error_rc)
 
+'''
+	get_responding_servers: returns the set of servers that answered the clients in log_dir on step.
+'''
+def get_responding_servers(log_dir, step = 0):
+	servers = set()
+	file_list = [log_dir+'/'+f for f in listdir(log_dir) if isfile(join(log_dir, f))]
+	for filename in file_list:
+		file_step = 0
+		if filename[-1].isdigit():
+			file_step = int(filename[-1])
+			if filename[-2].isdigit():
+				file_step += int(filename[-2]) * 10
+		if file_step != step:
+			continue
+		logfile=open(filename, 'r')
+		for line in logfile:
+			if len(line) > 2 and line[0] != '#':
+				server = line.split(':')[1].strip()
+				if server not in ['Connection closed ERROR','404 ERROR']:
+					servers.add(server)
+		logfile.close()
+	return servers
+
 '''
 	client_checker: Supports up to 100 steps (0-99)
 	checkers:
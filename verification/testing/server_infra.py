@@ -147,6 +147,19 @@ class HttpServer(player):
 			return
 
 
+	def add_route(self, dest_ip, gateway_ip):
+		cmd = "ip route replace %s via %s dev %s" %(dest_ip, gateway_ip, self.eth)
+		rc, output = self.ssh.execute_command(cmd)
+		if rc != True:
+			print "ERROR: Adding route to " + dest_ip + " failed. rc=" + str(rc) + " " + output
+			return
+
+	def delete_route(self, dest_ip, verbose = True):
+		cmd = "ip route del %s" %dest_ip
+		rc, output = self.ssh.execute_command(cmd)
+		if rc != True and verbose:
+			print "ERROR: Deleting route to " + dest_ip + " failed. rc=" + str(rc) + " " + output
+
 	def set_index_html(self, str):
 		cmd = "echo " + str + " >/var/www/html/index.html"
 		rc, output = self.ssh.execute_command(cmd)
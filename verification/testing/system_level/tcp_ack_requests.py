@@ -0,0 +1,60 @@
+#!/usr/bin/env python
+
+
+#===============================================================================
+# imports
+#===============================================================================
+
+# system
+from optparse import OptionParser
+import random
+import socket
+import struct
+
+TCP_FLAG_ACK = 0x10
+
+def checksum(data):
+	if len(data) % 2:
+		data += '\0'
+	total = sum(struct.unpack('!%dH' %(len(data) / 2), data))
+	total = (total >> 16) + (total & 0xffff)
+	total += total >> 16
+	return ~total & 0xffff
+
+# TCP header with ACK and without SYN, from a port with no connection
+def build_ack(src_ip, dst_ip, dst_port):
+	src_port = random.randint(1024, 65535)
+	seq = random.randint(0, 0xffffffff)
+	ack_seq = random.randint(0, 0xffffffff)
+	header = struct.pack('!HHIIBBHHH', src_port, dst_port, seq, ack_seq, 5 << 4, TCP_FLAG_ACK, 8192, 0, 0)
+	pseudo_header = socket.inet_aton(src_ip) + socket.inet_aton(dst_ip) + struct.pack('!BBH', 0, socket.IPPROTO_TCP, len(header))
+	tcp_checksum = checksum(pseudo_header + header)
+	return header[:16] + struct.pack('!H', tcp_checksum) + header[18:]
+
+################################################################################
+# Function: Main
+################################################################################
+if __name__ == "__main__":
+	usage = "usage: %prog [-i, -p, -s, -r]"
+	parser = OptionParser(usage=usage, version="%prog 1.0")
+
+	parser.add_option("-i", "--dst_ip", dest="dst_ip",
+					  help="IP of the service")
+	parser.add_option("-p", "--port", dest="port",
+					  help="TCP port of the service", default=80, type="int")
+	parser.add_option("-s", "--src_ip", dest="src_ip",
+					  help="IP of the client")
+	parser.add_option("-r", "--requests", dest="num_of_requests",
+					  help="Number of ACK frames", default=1, type="int")
+
+	(options, args) = parser.parse_args()
+
+	if not options.dst_ip or not options.src_ip:
+		print 'ERROR: service IP and client IP must be given'
+		exit(1)
+
+	# IP header is built by the kernel
+	sock = socket.socket(socket.AF_INET, socket.SOCK_RAW, socket.IPPROTO_TCP)
+	for i in range(options.num_of_requests):
+		sock.sendto(build_ack(options.src_ip, options.dst_ip, options.port), (options.dst_ip, 0))
+	sock.close()
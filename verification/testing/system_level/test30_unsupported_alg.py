@@ -58,7 +58,7 @@ def run_user_test(server_list, ezbox, client_list, vip_list):
 	vip = vip_list[0]
 	port = '80'
 
-	ezbox.add_service(vip, port, sched_alg='lc' ,sched_alg_opt='')
+	ezbox.add_service(vip, port, sched_alg='fo' ,sched_alg_opt='')
 	for server in server_list:
 		ezbox.add_server(vip, port, server.ip, port)
 	
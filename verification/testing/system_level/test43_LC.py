@@ -0,0 +1,11 @@
+#!/usr/bin/env python
+
+#===============================================================================
+# imports
+#===============================================================================
+from test43_44_LC_WLC import *
+
+#===============================================================================
+# main function
+#===============================================================================
+test_43_44_main("lc")
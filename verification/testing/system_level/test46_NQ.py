@@ -0,0 +1,13 @@
+#!/usr/bin/env python
+
+#===============================================================================
+# imports
+#===============================================================================
+from test43_44_LC_WLC import *
+
+#===============================================================================
+# main function
+#===============================================================================
+# sed and nq count active connections only, servers are mostly idle between
+# the short client requests, so the distribution is not by weight
+test_43_44_main("nq", check_distribution=False)
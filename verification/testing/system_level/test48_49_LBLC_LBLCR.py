@@ -0,0 +1,150 @@
+#!/usr/bin/env python
+
+
+#===============================================================================
+# imports
+#===============================================================================
+
+# system
+import cmd
+from collections import namedtuple
+import logging
+import os
+import sys
+import inspect
+from multiprocessing import Process
+
+
+# pythons modules
+# local
+currentdir = os.path.dirname(os.path.abspath(inspect.getfile(inspect.currentframe())))
+parentdir = os.path.dirname(currentdir)
+sys.path.insert(0,parentdir)
+from e2e_infra import *
+
+
+#===============================================================================
+# Test Globals
+#===============================================================================
+request_count = 100
+server_count = 5
+client_count = 5
+service_count = 1
+
+
+#===============================================================================
+# User Area function needed by infrastructure
+#===============================================================================
+
+def user_init(setup_num):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	dict = generic_init(setup_num, service_count, server_count, client_count)
+
+	for s in dict['server_list']:
+		s.vip = dict['vip_list'][0]
+		s.weight = 1
+
+	return convert_generic_init_to_user_format(dict)
+
+def client_execution(client, vip):
+	client.exec_params += " -i %s -r %d" %(vip, request_count)
+	client.execute()
+
+def run_clients(client_list, vip):
+	process_list = []
+	for client in client_list:
+		process_list.append(Process(target=client_execution, args=(client,vip,)))
+	for p in process_list:
+		p.start()
+	for p in process_list:
+		p.join()
+
+def run_user_test(server_list, ezbox, client_list, vip_list, sched_algorithm):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	port = '80'
+	vip = vip_list[0]
+
+	print "service %s is set with %s scheduling algorithm" %(vip,sched_algorithm)
+	ezbox.add_service(vip, port, sched_alg=sched_algorithm, sched_alg_opt='')
+	for server in server_list:
+		ezbox.add_server(vip, port, server.ip, port, server.weight)
+
+	# step 0 - no server is overloaded, the destination keeps its server
+	run_clients(client_list, vip)
+
+	# step 1 - overload the server of the destination with upper threshold
+	# of one connection, the destination must move to another server
+	rc, output = client_list[0].ssh.execute_command("grep -v '^#' %s | head -1" %client_list[0].logfile_name)
+	if rc != True or ':' not in output:
+		print "ERROR: failed to read server of the destination from client log"
+		exit(1)
+	dest_server_ip = output.split(':')[1].strip()
+	print 'overload server %s of destination %s' %(dest_server_ip, vip)
+	ezbox.modify_server(vip, port, dest_server_ip, port, weight=1, u_thresh=1)
+
+	for client in client_list:
+		new_log_name = client.logfile_name+'_1'
+		client.add_log(new_log_name)
+	run_clients(client_list, vip)
+
+	print 'End user test'
+
+def run_user_checker(server_list, ezbox, client_list, log_dir):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	expected_dict = {}
+	expected_dict[0] = {'client_response_count':request_count,
+						'client_count': len(client_list),
+						'no_connection_closed': True,
+						'no_404': True,
+						'expected_servers':server_list,
+						'server_count_per_client':1}
+	expected_dict[1] = {'client_response_count':request_count,
+						'client_count': len(client_list),
+						'no_connection_closed': True,
+						'no_404': True,
+						'expected_servers':server_list}
+
+	rc = client_checker(log_dir, expected_dict, 2)
+
+	# locality - all clients of the virtual address get the same server
+	step_0_servers = get_responding_servers(log_dir, 0)
+	if len(step_0_servers) != 1:
+		print 'ERROR: clients received responses from %d servers, expected 1: %s' %(len(step_0_servers), ' '.join(step_0_servers))
+		rc = False
+
+	step_1_servers = get_responding_servers(log_dir, 1)
+	if len(step_1_servers - step_0_servers) == 0:
+		print 'ERROR: destination was not moved from overloaded server: %s' %(' '.join(step_0_servers))
+		rc = False
+
+	return rc
+
+#===============================================================================
+# main function
+#===============================================================================
+def test_48_49_main(sched_alg):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	config = generic_main()
+
+	server_list, ezbox, client_list, vip_list = user_init(config['setup_num'])
+
+	init_players(server_list, ezbox, client_list, vip_list, config)
+
+	run_user_test(server_list, ezbox, client_list, vip_list, sched_alg)
+
+	log_dir = collect_logs(server_list, ezbox, client_list)
+
+	gen_rc = general_checker(server_list, ezbox, client_list)
+
+	clean_players(server_list, ezbox, client_list, True, config['stop_ezbox'])
+
+	user_rc = run_user_checker(server_list, ezbox, client_list, log_dir)
+
+	if user_rc and gen_rc:
+		print 'Test passed !!!'
+		exit(0)
+	else:
+		print "Test failed !!!, user_rc %s gen_rc %s" %(str(user_rc), str(gen_rc))
+		exit(1)
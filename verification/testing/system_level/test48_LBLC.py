@@ -0,0 +1,11 @@
+#!/usr/bin/env python
+
+#===============================================================================
+# imports
+#===============================================================================
+from test48_49_LBLC_LBLCR import *
+
+#===============================================================================
+# main function
+#===============================================================================
+test_48_49_main("lblc")
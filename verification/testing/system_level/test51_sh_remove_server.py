@@ -0,0 +1,155 @@
+#!/usr/bin/env python
+
+
+#===============================================================================
+# imports
+#===============================================================================
+
+# system
+import cmd
+from collections import namedtuple
+import logging
+import os
+import sys
+import inspect
+from multiprocessing import Process
+
+
+# pythons modules
+# local
+currentdir = os.path.dirname(os.path.abspath(inspect.getfile(inspect.currentframe())))
+parentdir = os.path.dirname(currentdir)
+sys.path.insert(0,parentdir)
+from e2e_infra import *
+
+
+#===============================================================================
+# Test Globals
+#===============================================================================
+request_count = 100
+server_count = 5
+client_count = 5
+service_count = 1
+
+
+#===============================================================================
+# User Area function needed by infrastructure
+#===============================================================================
+
+def user_init(setup_num):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	dict = generic_init(setup_num, service_count, server_count, client_count)
+
+	for s in dict['server_list']:
+		s.vip = dict['vip_list'][0]
+
+	return convert_generic_init_to_user_format(dict)
+
+def client_execution(client, vip):
+	client.exec_params += " -i %s -r %d" %(vip, request_count)
+	client.execute()
+
+def run_clients(client_list, vip):
+	process_list = []
+	for client in client_list:
+		process_list.append(Process(target=client_execution, args=(client,vip,)))
+	for p in process_list:
+		p.start()
+	for p in process_list:
+		p.join()
+
+def get_client_server(client):
+	rc, output = client.ssh.execute_command("grep -v '^#' %s | head -1" %client.logfile_name)
+	if rc != True or ':' not in output:
+		print "ERROR: failed to read server of client %s from log" %client.ip
+		exit(1)
+	return output.split(':')[1].strip()
+
+def run_user_test(server_list, ezbox, client_list, vip_list):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	port = '80'
+	vip = vip_list[0]
+
+	ezbox.add_service(vip, port, sched_alg_opt='')
+	for server in server_list:
+		ezbox.add_server(vip, port, server.ip, port)
+
+	# step 0 - every client gets one server
+	run_clients(client_list, vip)
+
+	client_servers = dict((client.ip, get_client_server(client)) for client in client_list)
+
+	# step 1 - remove the server of the first client, only clients of this
+	# server are moved to other servers
+	removed_server = [s for s in server_list if s.ip == client_servers[client_list[0].ip]][0]
+	print 'remove server %s' %removed_server.ip
+	ezbox.delete_server(vip, port, removed_server.ip, port)
+
+	for client in client_list:
+		new_log_name = client.logfile_name+'_1'
+		client.add_log(new_log_name)
+	run_clients(client_list, vip)
+
+	print 'End user test'
+
+	return (client_servers, removed_server)
+
+def run_user_checker(server_list, ezbox, client_list, log_dir, client_servers, removed_server):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	remaining_servers = [s for s in server_list if s != removed_server]
+
+	expected_servers_per_client = {}
+	for client in client_list:
+		if client_servers[client.ip] == removed_server.ip:
+			expected_servers_per_client[client.ip] = [s.ip for s in remaining_servers]
+		else:
+			expected_servers_per_client[client.ip] = [client_servers[client.ip]]
+
+	expected_dict = {}
+	expected_dict[0] = {'client_response_count':request_count,
+						'client_count': len(client_list),
+						'no_connection_closed': True,
+						'no_404': True,
+						'expected_servers':server_list,
+						'server_count_per_client':1}
+	expected_dict[1] = {'client_response_count':request_count,
+						'client_count': len(client_list),
+						'no_connection_closed': True,
+						'no_404': True,
+						'expected_servers':remaining_servers,
+						'expected_servers_per_client':expected_servers_per_client,
+						'server_count_per_client':1}
+
+	return client_checker(log_dir, expected_dict, 2)
+
+#===============================================================================
+# main function
+#===============================================================================
+def main():
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	config = generic_main()
+
+	server_list, ezbox, client_list, vip_list = user_init(config['setup_num'])
+
+	init_players(server_list, ezbox, client_list, vip_list, config)
+
+	client_servers, removed_server = run_user_test(server_list, ezbox, client_list, vip_list)
+
+	log_dir = collect_logs(server_list, ezbox, client_list)
+
+	gen_rc = general_checker(server_list, ezbox, client_list)
+
+	clean_players(server_list, ezbox, client_list, True, config['stop_ezbox'])
+
+	client_rc = run_user_checker(server_list, ezbox, client_list, log_dir, client_servers, removed_server)
+
+	if client_rc and gen_rc:
+		print 'Test passed !!!'
+		exit(0)
+	else:
+		print 'Test failed !!!'
+		exit(1)
+
+main()
@@ -0,0 +1,140 @@
+#!/usr/bin/env python
+
+
+#===============================================================================
+# imports
+#===============================================================================
+
+# system
+import cmd
+from collections import namedtuple
+import logging
+import os
+import sys
+import inspect
+from multiprocessing import Process
+
+
+# pythons modules
+# local
+currentdir = os.path.dirname(os.path.abspath(inspect.getfile(inspect.currentframe())))
+parentdir = os.path.dirname(currentdir)
+sys.path.insert(0,parentdir)
+from e2e_infra import *
+
+
+#===============================================================================
+# Test Globals
+#===============================================================================
+request_count = 100
+server_count = 5
+client_count = 5
+service_count = 2
+
+
+#===============================================================================
+# User Area function needed by infrastructure
+#===============================================================================
+
+def user_init(setup_num):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	dict = generic_init(setup_num, service_count, server_count, client_count)
+
+	for s in dict['server_list']:
+		s.vip = dict['vip_list'][0]
+
+	return convert_generic_init_to_user_format(dict)
+
+def client_execution(client, vip):
+	client.exec_params += " -i %s -r %d" %(vip, request_count)
+	client.execute()
+
+def run_user_test(server_list, ezbox, client_list, vip_list):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	process_list = []
+	vip = vip_list[0]
+	port = '80'
+
+	# NAT servers reply to the clients through the NPS
+	nps_data_ip = '.'.join([str(int(byte, 16)) for byte in ezbox.setup['data_ip_hex_display'].split(' ')])
+	for server in server_list:
+		for client in client_list:
+			server.add_route(client.ip, nps_data_ip)
+
+	ezbox.add_service(vip, port, sched_alg='rr', sched_alg_opt='')
+	for server in server_list:
+		ezbox.add_server(vip, port, server.ip, port, routing_alg_opt='-m')
+
+	for client in client_list:
+		process_list.append(Process(target=client_execution, args=(client,vip,)))
+	for p in process_list:
+		p.start()
+	for p in process_list:
+		p.join()
+
+	for server in server_list:
+		for client in client_list:
+			server.delete_route(client.ip)
+
+	# NAT server is rejected on one-packet scheduling service
+	one_packet_vip = vip_list[1]
+	ezbox.execute_command_on_host("ipvsadm -A -u %s:%s -s rr -o" %(one_packet_vip, port))
+	time.sleep(2)
+	ezbox.execute_command_on_host("ipvsadm -a -u %s:%s -r %s:%s -m" %(one_packet_vip, port, server_list[0].ip, port))
+	time.sleep(2)
+	rc, output = ezbox.execute_command_on_host('grep alvs_daemon /var/log/syslog | grep "NAT and full NAT servers are not supported on one-packet scheduling service"')
+	one_packet_rc = rc
+	if one_packet_rc != True:
+		print "ERROR: NAT server was not rejected on one-packet scheduling service"
+	ezbox.execute_command_on_host("ipvsadm -D -u %s:%s" %(one_packet_vip, port))
+
+	print 'End user test'
+
+	return one_packet_rc
+
+def run_user_checker(server_list, ezbox, client_list, log_dir):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	# responses reach the clients only if the reply is translated back to
+	# the virtual address by the NPS
+	expected_dict= {'client_response_count':request_count,
+					'client_count': client_count,
+					'expected_servers': server_list,
+					'server_count_per_client':server_count,
+					'no_connection_closed':True,
+					'no_404': True}
+
+	rc = client_checker(log_dir, expected_dict)
+
+	return rc
+
+#===============================================================================
+# main function
+#===============================================================================
+def main():
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	config = generic_main()
+
+	server_list, ezbox, client_list, vip_list = user_init(config['setup_num'])
+
+	init_players(server_list, ezbox, client_list, vip_list, config)
+
+	one_packet_rc = run_user_test(server_list, ezbox, client_list, vip_list)
+
+	log_dir = collect_logs(server_list, ezbox, client_list)
+
+	gen_rc = general_checker(server_list, ezbox, client_list)
+
+	clean_players(server_list, ezbox, client_list, True, config['stop_ezbox'])
+
+	client_rc = run_user_checker(server_list, ezbox, client_list, log_dir)
+
+	if client_rc and gen_rc and one_packet_rc:
+		print 'Test passed !!!'
+		exit(0)
+	else:
+		print 'Test failed !!!'
+		exit(1)
+
+main()
@@ -0,0 +1,161 @@
+#!/usr/bin/env python
+
+
+#===============================================================================
+# imports
+#===============================================================================
+
+# system
+import cmd
+from collections import namedtuple
+import logging
+import os
+import sys
+import inspect
+from multiprocessing import Process
+
+
+# pythons modules
+# local
+currentdir = os.path.dirname(os.path.abspath(inspect.getfile(inspect.currentframe())))
+parentdir = os.path.dirname(currentdir)
+sys.path.insert(0,parentdir)
+from e2e_infra import *
+
+
+#===============================================================================
+# Test Globals
+#===============================================================================
+request_count = 100
+server_count = 5
+client_count = 5
+service_count = 3
+fwmark_file = '/tmp/alvs_fwmarks'
+
+
+#===============================================================================
+# User Area function needed by infrastructure
+#===============================================================================
+
+def user_init(setup_num):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	dict = generic_init(setup_num, service_count, server_count, client_count)
+
+	for s in dict['server_list']:
+		s.vip = dict['vip_list'][0]
+
+	return convert_generic_init_to_user_format(dict)
+
+def client_execution(client, vip):
+	client.exec_params += " -i %s -r %d" %(vip, request_count)
+	client.execute()
+
+def restart_ezbox(ezbox, cp_params):
+	ezbox.alvs_service_stop()
+	ezbox.update_cp_params(cp_params)
+	ezbox.alvs_service_start()
+	ezbox.wait_for_cp_app()
+	ezbox.wait_for_dp_app()
+	time.sleep(6)
+
+def write_fwmark_file(ezbox, lines):
+	ezbox.execute_command_on_host("printf '%%s\\n' %s > %s" %(' '.join(["'%s'" %line for line in lines]), fwmark_file))
+
+def run_user_test(server_list, ezbox, client_list, vip_list):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	process_list = []
+	vip = vip_list[0]
+	default_cp_params = "--agt_enabled --port_type=%s" %ezbox.setup['nps_port_type']
+	fwmark_cp_params = default_cp_params + " --fwmark_file=%s" %fwmark_file
+
+	# bad protocol in second entry - daemon must report the line
+	write_fwmark_file(ezbox, ['1 tcp %s 80' %vip,
+							  '2 icmp %s 80' %vip_list[2]])
+	ezbox.alvs_service_stop()
+	ezbox.update_cp_params(fwmark_cp_params)
+	ezbox.alvs_service_start()
+	time.sleep(10)
+	rc, output = ezbox.execute_command_on_host('grep alvs_daemon /var/log/syslog | grep "Bad firewall mark entry in %s line 2"' %fwmark_file)
+	parser_rc = rc
+	if parser_rc != True:
+		print "ERROR: bad firewall mark entry was not reported"
+
+	# comments, empty lines, address prefix and port range
+	write_fwmark_file(ezbox, ['# web service',
+							  '1 tcp %s 80 # single address' %vip,
+							  '',
+							  '2 tcp %s/31 80-81' %vip_list[2]])
+	restart_ezbox(ezbox, fwmark_cp_params)
+
+	ezbox.add_fwmark_service(1, sched_alg='rr', sched_alg_opt='')
+	for server in server_list:
+		ezbox.add_fwmark_server(1, server.ip)
+	ezbox.add_fwmark_service(2, sched_alg='rr', sched_alg_opt='')
+	ezbox.add_fwmark_server(2, server_list[0].ip)
+
+	# one entry of mark 1, two addresses and two ports of mark 2
+	service_entries = ezbox.get_num_of_services()
+	if service_entries != 5:
+		print "ERROR: wrong number of service classification entries. expected = 5, received = %d" %service_entries
+		parser_rc = False
+
+	for client in client_list:
+		process_list.append(Process(target=client_execution, args=(client,vip,)))
+	for p in process_list:
+		p.start()
+	for p in process_list:
+		p.join()
+
+	# keep the running daemon for the checkers, next start uses default arguments
+	ezbox.update_cp_params(default_cp_params)
+	ezbox.execute_command_on_host("rm -f %s" %fwmark_file)
+
+	print 'End user test'
+
+	return parser_rc
+
+def run_user_checker(server_list, ezbox, client_list, log_dir):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	# the virtual address and port are served by the fwmark 1 service
+	expected_dict= {'client_response_count':request_count,
+					'client_count': client_count,
+					'expected_servers': server_list,
+					'server_count_per_client':server_count,
+					'no_connection_closed':True,
+					'no_404': True}
+
+	rc = client_checker(log_dir, expected_dict)
+
+	return rc
+
+#===============================================================================
+# main function
+#===============================================================================
+def main():
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	config = generic_main()
+
+	server_list, ezbox, client_list, vip_list = user_init(config['setup_num'])
+
+	init_players(server_list, ezbox, client_list, vip_list, config)
+
+	parser_rc = run_user_test(server_list, ezbox, client_list, vip_list)
+
+	log_dir = collect_logs(server_list, ezbox, client_list)
+
+	gen_rc = general_checker(server_list, ezbox, client_list)
+
+	clean_players(server_list, ezbox, client_list, True, config['stop_ezbox'])
+
+	client_rc = run_user_checker(server_list, ezbox, client_list, log_dir)
+
+	if client_rc and gen_rc and parser_rc:
+		print 'Test passed !!!'
+		exit(0)
+	else:
+		print 'Test failed !!!'
+		exit(1)
+
+main()
@@ -0,0 +1,134 @@
+#!/usr/bin/env python
+
+
+#===============================================================================
+# imports
+#===============================================================================
+
+# system
+import cmd
+from collections import namedtuple
+import logging
+import os
+import sys
+import inspect
+from multiprocessing import Process
+
+
+# pythons modules
+# local
+currentdir = os.path.dirname(os.path.abspath(inspect.getfile(inspect.currentframe())))
+parentdir = os.path.dirname(currentdir)
+sys.path.insert(0,parentdir)
+from e2e_infra import *
+
+
+#===============================================================================
+# Test Globals
+#===============================================================================
+request_count = 100
+server_count = 5
+client_count = 5
+service_count = 1
+
+
+#===============================================================================
+# User Area function needed by infrastructure
+#===============================================================================
+
+def user_init(setup_num):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	dict = generic_init(setup_num, service_count, server_count, client_count)
+
+	for s in dict['server_list']:
+		s.vip = dict['vip_list'][0]
+
+	return convert_generic_init_to_user_format(dict)
+
+def client_execution(client, vip):
+	client.exec_params += " -i %s -r %d" %(vip, request_count)
+	client.execute()
+
+def run_clients(client_list, vip):
+	process_list = []
+	for client in client_list:
+		process_list.append(Process(target=client_execution, args=(client,vip,)))
+	for p in process_list:
+		p.start()
+	for p in process_list:
+		p.join()
+
+def run_user_test(server_list, ezbox, client_list, vip_list):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	port = '80'
+	vip = vip_list[0]
+
+	# step 0 - wildcard port service catches port 80 of the virtual address.
+	# ipvsadm accepts port zero only on persistent service
+	ezbox.add_service(vip, '0', sched_alg='rr', sched_alg_opt='-p 300')
+	for server in server_list:
+		ezbox.add_server(vip, '0', server.ip, '0')
+
+	run_clients(client_list, vip)
+
+	# step 1 - exact port service of the virtual address wins over the
+	# wildcard port service
+	ezbox.add_service(vip, port, sched_alg='rr', sched_alg_opt='')
+	ezbox.add_server(vip, port, server_list[0].ip, port)
+
+	for client in client_list:
+		new_log_name = client.logfile_name+'_1'
+		client.add_log(new_log_name)
+	run_clients(client_list, vip)
+
+	print 'End user test'
+
+def run_user_checker(server_list, ezbox, client_list, log_dir):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	expected_dict = {}
+	expected_dict[0] = {'client_response_count':request_count,
+						'client_count': len(client_list),
+						'no_connection_closed': True,
+						'no_404': True,
+						'expected_servers':server_list,
+						'server_count_per_client':1}
+	expected_dict[1] = {'client_response_count':request_count,
+						'client_count': len(client_list),
+						'no_connection_closed': True,
+						'no_404': True,
+						'expected_servers':[server_list[0]],
+						'server_count_per_client':1}
+
+	return client_checker(log_dir, expected_dict, 2)
+
+#===============================================================================
+# main function
+#===============================================================================
+def main():
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	config = generic_main()
+
+	server_list, ezbox, client_list, vip_list = user_init(config['setup_num'])
+
+	init_players(server_list, ezbox, client_list, vip_list, config)
+
+	run_user_test(server_list, ezbox, client_list, vip_list)
+
+	log_dir = collect_logs(server_list, ezbox, client_list)
+
+	gen_rc = general_checker(server_list, ezbox, client_list)
+
+	clean_players(server_list, ezbox, client_list, True, config['stop_ezbox'])
+
+	client_rc = run_user_checker(server_list, ezbox, client_list, log_dir)
+
+	if client_rc and gen_rc:
+		print 'Test passed !!!'
+		exit(0)
+	else:
+		print 'Test failed !!!'
+		exit(1)
+
+main()
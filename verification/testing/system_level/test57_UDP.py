@@ -0,0 +1,139 @@
+#!/usr/bin/env python
+
+
+#===============================================================================
+# imports
+#===============================================================================
+
+# system
+import cmd
+from collections import namedtuple
+import logging
+import os
+import sys
+import inspect
+from multiprocessing import Process
+
+
+# pythons modules
+# local
+currentdir = os.path.dirname(os.path.abspath(inspect.getfile(inspect.currentframe())))
+parentdir = os.path.dirname(currentdir)
+sys.path.insert(0,parentdir)
+from e2e_infra import *
+
+
+#===============================================================================
+# Test Globals
+#===============================================================================
+request_count = 100
+server_count = 5
+client_count = 5
+service_count = 1
+udp_script = 'udp_client_requests.py'
+udp_script_path = '/root/tmp'
+
+
+#===============================================================================
+# User Area function needed by infrastructure
+#===============================================================================
+
+def user_init(setup_num):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	dict = generic_init(setup_num, service_count, server_count, client_count)
+
+	for s in dict['server_list']:
+		s.vip = dict['vip_list'][0]
+
+	# clients send UDP requests instead of HTTP requests
+	for c in dict['client_list']:
+		c.exe_script = udp_script
+
+	return convert_generic_init_to_user_format(dict)
+
+def client_execution(client, vip):
+	client.exec_params += " -i %s -r %d" %(vip, request_count)
+	client.execute()
+
+def start_udp_servers(server_list):
+	for server in server_list:
+		server.execute_command("mkdir -p %s" %udp_script_path)
+		server.copy_file_to_player(currentdir + '/' + udp_script, udp_script_path)
+		# server answers with its index.html (its IP) from the virtual address
+		server.execute_command("nohup python %s/%s -s -i %s > /dev/null 2>&1 &" %(udp_script_path, udp_script, server.vip))
+
+def stop_udp_servers(server_list):
+	for server in server_list:
+		server.execute_command("pkill -f %s" %udp_script)
+		server.execute_command("rm -f %s/%s" %(udp_script_path, udp_script))
+
+def run_user_test(server_list, ezbox, client_list, vip_list):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	process_list = []
+	vip = vip_list[0]
+	port = '80'
+
+	start_udp_servers(server_list)
+
+	ezbox.execute_command_on_host("ipvsadm -A -u %s:%s -s rr" %(vip, port))
+	time.sleep(2)
+	for server in server_list:
+		ezbox.execute_command_on_host("ipvsadm -a -u %s:%s -r %s:%s -w 1 -g" %(vip, port, server.ip, port))
+		time.sleep(2)
+
+	for client in client_list:
+		process_list.append(Process(target=client_execution, args=(client,vip,)))
+	for p in process_list:
+		p.start()
+	for p in process_list:
+		p.join()
+
+	stop_udp_servers(server_list)
+
+	print 'End user test'
+
+def run_user_checker(server_list, ezbox, client_list, log_dir):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	# each request is sent from a new client port, so it is a new UDP
+	# connection scheduled by the NPS
+	expected_dict= {'client_response_count':request_count,
+					'client_count': client_count,
+					'expected_servers': server_list,
+					'server_count_per_client':server_count,
+					'no_404': True}
+
+	rc = client_checker(log_dir, expected_dict)
+
+	return rc
+
+#===============================================================================
+# main function
+#===============================================================================
+def main():
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	config = generic_main()
+
+	server_list, ezbox, client_list, vip_list = user_init(config['setup_num'])
+
+	init_players(server_list, ezbox, client_list, vip_list, config)
+
+	run_user_test(server_list, ezbox, client_list, vip_list)
+
+	log_dir = collect_logs(server_list, ezbox, client_list)
+
+	gen_rc = general_checker(server_list, ezbox, client_list)
+
+	clean_players(server_list, ezbox, client_list, True, config['stop_ezbox'])
+
+	client_rc = run_user_checker(server_list, ezbox, client_list, log_dir)
+
+	if client_rc and gen_rc:
+		print 'Test passed !!!'
+		exit(0)
+	else:
+		print 'Test failed !!!'
+		exit(1)
+
+main()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python
+
+
+#===============================================================================
+# imports
+#===============================================================================
+
+# system
+import cmd
+from collections import namedtuple
+import logging
+import os
+import sys
+import inspect
+from multiprocessing import Process
+
+
+# pythons modules
+# local
+currentdir = os.path.dirname(os.path.abspath(inspect.getfile(inspect.currentframe())))
+parentdir = os.path.dirname(currentdir)
+sys.path.insert(0,parentdir)
+from e2e_infra import *
+
+
+#===============================================================================
+# Test Globals
+#===============================================================================
+request_count = 100
+ack_count = 50
+server_count = 5
+client_count = 5
+service_count = 1
+ack_script = 'tcp_ack_requests.py'
+
+
+#===============================================================================
+# User Area function needed by infrastructure
+#===============================================================================
+
+def user_init(setup_num):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	dict = generic_init(setup_num, service_count, server_count, client_count)
+
+	for s in dict['server_list']:
+		s.vip = dict['vip_list'][0]
+
+	return convert_generic_init_to_user_format(dict)
+
+def client_execution(client, vip):
+	client.exec_params += " -i %s -r %d" %(vip, request_count)
+	client.execute()
+
+def restart_ezbox(ezbox, cp_params):
+	ezbox.alvs_service_stop()
+	ezbox.update_cp_params(cp_params)
+	ezbox.alvs_service_start()
+	ezbox.wait_for_cp_app()
+	ezbox.wait_for_dp_app()
+	time.sleep(6)
+
+def run_user_test(server_list, ezbox, client_list, vip_list):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	process_list = []
+	vip = vip_list[0]
+	port = '80'
+
+	print 'restart ALVS with non-SYN miss drop policy'
+	restart_ezbox(ezbox, "--agt_enabled --port_type=%s --non_syn_miss=drop" %ezbox.setup['nps_port_type'])
+
+	ezbox.add_service(vip, port, sched_alg='rr', sched_alg_opt='')
+	for server in server_list:
+		ezbox.add_server(vip, port, server.ip, port)
+
+	# connections opened by SYN are created as usual
+	for client in client_list:
+		process_list.append(Process(target=client_execution, args=(client,vip,)))
+	for p in process_list:
+		p.start()
+	for p in process_list:
+		p.join()
+
+	# ACK frames which miss the connection table are dropped by the NPS
+	ezbox.clear_stats()
+	client = client_list[0]
+	client.copy_file_to_player(currentdir + '/' + ack_script, client.exe_path)
+	client.execute_command("python %s/%s -i %s -p %s -s %s -r %d" %(client.exe_path, ack_script, vip, port, client.ip, ack_count))
+	client.execute_command("rm -f %s/%s" %(client.exe_path, ack_script))
+	time.sleep(2)
+
+	error_stats = ezbox.get_error_stats()
+	drop_rc = True
+	if error_stats['ALVS_ERROR_NON_SYN_MISS_DROP'] != ack_count:
+		print "ERROR: non-SYN frames were not dropped. expected = %d , dropped = %d" %(ack_count, error_stats['ALVS_ERROR_NON_SYN_MISS_DROP'])
+		drop_rc = False
+
+	# keep the running daemon for the checkers, next start uses default arguments
+	ezbox.update_cp_params("--agt_enabled --port_type=%s" %ezbox.setup['nps_port_type'])
+
+	print 'End user test'
+
+	return drop_rc
+
+def run_user_checker(server_list, ezbox, client_list, log_dir):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	expected_dict= {'client_response_count':request_count,
+					'client_count': client_count,
+					'expected_servers': server_list,
+					'server_count_per_client':server_count,
+					'no_connection_closed':True,
+					'no_404': True}
+
+	rc = client_checker(log_dir, expected_dict)
+
+	return rc
+
+#===============================================================================
+# main function
+#===============================================================================
+def main():
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	config = generic_main()
+
+	server_list, ezbox, client_list, vip_list = user_init(config['setup_num'])
+
+	init_players(server_list, ezbox, client_list, vip_list, config)
+
+	drop_rc = run_user_test(server_list, ezbox, client_list, vip_list)
+
+	log_dir = collect_logs(server_list, ezbox, client_list)
+
+	# dropped non-SYN frames are counted as errors, checked by the test
+	gen_rc = general_checker(server_list, ezbox, client_list, expected={'no_error_stats':False})
+
+	clean_players(server_list, ezbox, client_list, True, config['stop_ezbox'])
+
+	client_rc = run_user_checker(server_list, ezbox, client_list, log_dir)
+
+	if client_rc and gen_rc and drop_rc:
+		print 'Test passed !!!'
+		exit(0)
+	else:
+		print 'Test failed !!!'
+		exit(1)
+
+main()
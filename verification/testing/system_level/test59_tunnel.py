@@ -0,0 +1,146 @@
+#!/usr/bin/env python
+
+
+#===============================================================================
+# imports
+#===============================================================================
+
+# system
+import cmd
+from collections import namedtuple
+import logging
+import os
+import sys
+import inspect
+from multiprocessing import Process
+
+
+# pythons modules
+# local
+currentdir = os.path.dirname(os.path.abspath(inspect.getfile(inspect.currentframe())))
+parentdir = os.path.dirname(currentdir)
+sys.path.insert(0,parentdir)
+from e2e_infra import *
+
+
+#===============================================================================
+# Test Globals
+#===============================================================================
+request_count = 100
+server_count = 5
+client_count = 5
+service_count = 1
+
+
+#===============================================================================
+# User Area function needed by infrastructure
+#===============================================================================
+
+def user_init(setup_num):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	dict = generic_init(setup_num, service_count, server_count, client_count)
+
+	for s in dict['server_list']:
+		s.vip = dict['vip_list'][0]
+
+	return convert_generic_init_to_user_format(dict)
+
+def client_execution(client, vip):
+	client.exec_params += " -i %s -r %d" %(vip, request_count)
+	client.execute()
+
+def restart_ezbox(ezbox, cp_params):
+	ezbox.alvs_service_stop()
+	ezbox.update_cp_params(cp_params)
+	ezbox.alvs_service_start()
+	ezbox.wait_for_cp_app()
+	ezbox.wait_for_dp_app()
+	time.sleep(6)
+
+# servers decapsulate IP-in-IP frames, virtual address is already on loopback
+def init_tunnel_servers(server_list):
+	for server in server_list:
+		server.execute_command("modprobe ipip")
+		server.execute_command("ip link set tunl0 up")
+		server.execute_command("echo \"0\" > /proc/sys/net/ipv4/conf/tunl0/rp_filter")
+
+def clean_tunnel_servers(server_list):
+	for server in server_list:
+		server.execute_command("ip link set tunl0 down")
+
+def run_user_test(server_list, ezbox, client_list, vip_list):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	process_list = []
+	vip = vip_list[0]
+	port = '80'
+
+	nps_data_ip = '.'.join([str(int(byte, 16)) for byte in ezbox.setup['data_ip_hex_display'].split(' ')])
+	print 'restart ALVS with tunnel source address %s' %nps_data_ip
+	restart_ezbox(ezbox, "--agt_enabled --port_type=%s --tunnel_source_ip=%s" %(ezbox.setup['nps_port_type'], nps_data_ip))
+
+	init_tunnel_servers(server_list)
+
+	ezbox.add_service(vip, port, sched_alg='rr', sched_alg_opt='')
+	for server in server_list:
+		ezbox.add_server(vip, port, server.ip, port, routing_alg_opt='-i')
+
+	for client in client_list:
+		process_list.append(Process(target=client_execution, args=(client,vip,)))
+	for p in process_list:
+		p.start()
+	for p in process_list:
+		p.join()
+
+	clean_tunnel_servers(server_list)
+
+	# keep the running daemon for the checkers, next start uses default arguments
+	ezbox.update_cp_params("--agt_enabled --port_type=%s" %ezbox.setup['nps_port_type'])
+
+	print 'End user test'
+
+def run_user_checker(server_list, ezbox, client_list, log_dir):
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+	# requests reach the servers only if they are encapsulated by the NPS,
+	# servers reply directly to the clients
+	expected_dict= {'client_response_count':request_count,
+					'client_count': client_count,
+					'expected_servers': server_list,
+					'server_count_per_client':server_count,
+					'no_connection_closed':True,
+					'no_404': True}
+
+	rc = client_checker(log_dir, expected_dict)
+
+	return rc
+
+#===============================================================================
+# main function
+#===============================================================================
+def main():
+	print "FUNCTION " + sys._getframe().f_code.co_name + " called"
+
+	config = generic_main()
+
+	server_list, ezbox, client_list, vip_list = user_init(config['setup_num'])
+
+	init_players(server_list, ezbox, client_list, vip_list, config)
+
+	run_user_test(server_list, ezbox, client_list, vip_list)
+
+	log_dir = collect_logs(server_list, ezbox, client_list)
+
+	gen_rc = general_checker(server_list, ezbox, client_list)
+
+	clean_players(server_list, ezbox, client_list, True, config['stop_ezbox'])
+
+	client_rc = run_user_checker(server_list, ezbox, client_list, log_dir)
+
+	if client_rc and gen_rc:
+		print 'Test passed !!!'
+		exit(0)
+	else:
+		print 'Test failed !!!'
+		exit(1)
+
+main()
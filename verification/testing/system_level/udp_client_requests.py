@@ -0,0 +1,100 @@
+#!/usr/bin/env python
+
+
+#===============================================================================
+# imports
+#===============================================================================
+
+# system
+from optparse import OptionParser
+import sys
+import socket
+
+log_file = None
+
+def init_log(log_file_name):
+	global log_file
+	log_file = open(log_file_name, 'w')
+	log_file.write("#start UDP client \n")
+
+def log(str):
+	log_file.write("%s\n" % str)
+
+def end_log():
+	log_file.write("#end UDP client\n")
+	log_file.close()
+
+def readUdp(ip, port, connTimeout):
+	# new socket per request, so each request is a new connection (client port)
+	sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+	sock.settimeout(connTimeout)
+	try:
+		sock.connect((ip, port))
+		sock.send('GET')
+		response = sock.recv(1024)
+	except socket.timeout:
+		log('%s : %s' %(ip, '404 ERROR'))
+		log('# No response from server')
+		return -1
+	except:
+		log('%s : %s' %(ip, '404 ERROR'))
+		log("# Unexpected error: %s" %sys.exc_info()[0])
+		return -1
+	finally:
+		sock.close()
+
+	log('%s : %s' %(ip, response.strip()))
+
+	# end sucessfuly without errors
+	return 0
+
+# server mode - answer each request with first line of the index file
+def serveUdp(ip, port, index_file):
+	response = open(index_file, 'r').readline()
+	sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+	sock.bind((ip, port))
+	while True:
+		data, addr = sock.recvfrom(1024)
+		sock.sendto(response, addr)
+
+################################################################################
+# Function: Main
+################################################################################
+if __name__ == "__main__":
+	usage = "usage: %prog [-i, -p, -l, -r -t -s -f]"
+	parser = OptionParser(usage=usage, version="%prog 1.0")
+
+	parser.add_option("-i", "--udp_ip", dest="udp_ip",
+					  help="IP of the UDP server")
+	parser.add_option("-p", "--port", dest="port",
+					  help="UDP port", default=80, type="int")
+	parser.add_option("-l", "--log_file", dest="log_file_name",
+					  help="Log file name", default="log")
+	parser.add_option("-r", "--requests", dest="num_of_requests",
+					  help="Number of UDP requests", default=1, type="int")
+	parser.add_option("-t", "--timeout", dest="timeout",
+					  help="UDP response timeout", default=8, type="int")
+	parser.add_option("-s", "--server", dest="server", action="store_true",
+					  help="Run as UDP server on the given IP", default=False)
+	parser.add_option("-f", "--index_file", dest="index_file",
+					  help="File of the server response", default="/var/www/html/index.html")
+
+	(options, args) = parser.parse_args()
+
+	if options.server:
+		serveUdp(options.udp_ip, options.port, options.index_file)
+		exit(0)
+
+	init_log(options.log_file_name)
+
+	if not options.udp_ip:
+		log('#UDP IP is not given')
+		exit(1)
+
+	# read from UDP server x times (x = options.num_of_requests)
+	for i in range(options.num_of_requests):
+		rc = readUdp(options.udp_ip, options.port, options.timeout)
+		if rc == -1:
+			break
+
+	end_log()